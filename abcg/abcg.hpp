@@ -16,8 +16,15 @@
 #include "abcgApplication.hpp"
 #include "abcgException.hpp"
 #include "abcgExternal.hpp"
+#include "abcgMappedFile.hpp"
+#include "abcgMeshAttributes.hpp"
+#include "abcgMeshOptimizer.hpp"
+#include "abcgObjReader.hpp"
+#include "abcgSoAPool.hpp"
+#include "abcgThreadPool.hpp"
 #include "abcgTrackball.hpp"
 #include "abcgUtil.hpp"
+#include "abcgVertexWelder.hpp"
 #include "abcgWindow.hpp"
 
 #endif
\ No newline at end of file
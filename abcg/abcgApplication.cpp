@@ -12,6 +12,8 @@
 
 #include <SDL_image.h>
 
+#include <charconv>
+#include <cstdlib>
 #include <span>
 
 #include "abcgException.hpp"
@@ -44,6 +46,14 @@ void abcg::mainLoopCallback(void *userData) {
  * of which the last one is nullptr and the previous ones, if any, point to
  * null-terminated multibyte strings that represent the arguments passed to the
  * program from the execution environment.
+ *
+ * Offscreen rendering (see abcg::OpenGLSettings::offscreen) is enabled if the
+ * `ABCG_OFFSCREEN` environment variable is set or if `--offscreen` is passed
+ * as an argument. The number of frames to render can be given as
+ * `ABCG_OFFSCREEN=N` or `--offscreen=N`, so that any application can be
+ * benchmarked headless without changing its code.
+ *
+ * @throw abcg::RuntimeError if `N` is not a positive integer.
  */
 abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
   // Get executable relative path
@@ -61,6 +71,22 @@ abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
 #endif
 
   abcg::Application::m_assetsPath = abcg::Application::m_basePath + "/assets/";
+
+#if !defined(__EMSCRIPTEN__)
+  // Offscreen rendering requested from the environment or the command line
+  if (auto const *value{std::getenv("ABCG_OFFSCREEN")}; value != nullptr) {
+    parseOffscreenOption(value);
+  }
+  using namespace std::string_view_literals;
+  for (std::string_view const arg :
+       std::span{argv, gsl::narrow<std::size_t>(argc)}) {
+    if (arg == "--offscreen"sv) {
+      parseOffscreenOption({});
+    } else if (arg.starts_with("--offscreen="sv)) {
+      parseOffscreenOption(arg.substr(arg.find('=') + 1));
+    }
+  }
+#endif
 }
 
 /**
@@ -69,15 +95,31 @@ abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
  * Initializes the SDL library and its subsystems, initializes the window and
  * runs the event loop.
  *
+ * If the window is rendered offscreen (see abcg::OpenGLSettings::offscreen),
+ * only the SDL video subsystem is initialized, using the offscreen video
+ * driver. Offscreen rendering requested from the command line or the
+ * environment overrides the settings of the window.
+ *
  * @param window L-value reference to the window object.
  *
  * @throw abcg::SDLError if `SDL_Init` failed.
  * @throw abcg::SDLImageError if `IMG_Init` failed.
  */
 void abcg::Application::run(Window &window) {
-  if (Uint32 const subsystemMask{SDL_INIT_VIDEO | SDL_INIT_AUDIO |
-                                 SDL_INIT_GAMECONTROLLER};
-      SDL_Init(subsystemMask) != 0) {
+  Uint32 subsystemMask{SDL_INIT_VIDEO | SDL_INIT_AUDIO |
+                       SDL_INIT_GAMECONTROLLER};
+#if !defined(__EMSCRIPTEN__)
+  if (m_offscreen) {
+    window.setOffscreen(m_offscreenFrames);
+  }
+  if (window.isOffscreen()) {
+    // Headless rendering: use the SDL offscreen video driver (EGL surfaceless
+    // context) and skip the subsystems that require physical devices
+    SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+    subsystemMask = SDL_INIT_VIDEO;
+  }
+#endif
+  if (SDL_Init(subsystemMask) != 0) {
     throw abcg::SDLError("SDL_Init failed");
   }
 
@@ -145,6 +187,24 @@ std::string const &abcg::Application::getBasePath() noexcept {
   return m_basePath;
 }
 
+// Enables offscreen rendering. A non-empty value must be a positive number of
+// frames, which overrides the number of frames set by the application
+void abcg::Application::parseOffscreenOption(std::string_view value) {
+  m_offscreen = true;
+  if (value.empty())
+    return;
+
+  int frames{};
+  if (auto const [ptr, ec]{std::from_chars(value.data(),
+                                           value.data() + value.size(),
+                                           frames)};
+      ec != std::errc{} || ptr != value.data() + value.size() || frames <= 0) {
+    throw abcg::RuntimeError(
+        fmt::format("Invalid number of offscreen frames: {}", value));
+  }
+  m_offscreenFrames = frames;
+}
+
 void abcg::Application::mainLoopIterator([[maybe_unused]] bool &done) const {
   SDL_Event event{};
   while (SDL_PollEvent(&event) != 0) {
@@ -12,6 +12,7 @@
 #define ABCG_APPLICATION_HPP_
 
 #include <string>
+#include <string_view>
 
 #define ABCG_VERSION_MAJOR 3
 #define ABCG_VERSION_MINOR 1
@@ -45,9 +46,14 @@ public:
 
 private:
   void mainLoopIterator(bool &done) const;
+  void parseOffscreenOption(std::string_view value);
 
   Window *m_window{};
 
+  // Offscreen rendering requested from the command line or the environment
+  bool m_offscreen{};
+  int m_offscreenFrames{};
+
 #if defined(__EMSCRIPTEN__)
   friend void mainLoopCallback(void *userData);
 #endif
@@ -11,11 +11,289 @@
 #include "abcgImage.hpp"
 
 #include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
 #include <gsl/gsl>
 
+#include <array>
+#include <cstring>
+#include <optional>
 #include <span>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ABCG_IMAGE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define ABCG_IMAGE_NEON
+#include <arm_neon.h>
+#endif
+
+#include "abcgException.hpp"
+
+namespace {
+
+// Byte offsets of the red, green, blue and alpha channels in a pixel. The
+// alpha offset is -1 if the pixel has no alpha channel.
+using ChannelOffsets = std::array<int, 4>;
+
+// Returns the channel offsets of a format with 8-bit channels and 3 or 4 bytes
+// per pixel, or std::nullopt for any other format (e.g., palettized)
+std::optional<ChannelOffsets> getChannelOffsets(SDL_PixelFormat const &format) {
+  auto const bytesPerPixel{int{format.BytesPerPixel}};
+  if (bytesPerPixel != 3 && bytesPerPixel != 4)
+    return std::nullopt;
+
+  auto const toOffset{[bytesPerPixel](Uint8 shift) {
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    return bytesPerPixel - 1 - shift / 8;
+#else
+    return shift / 8;
+#endif
+  }};
+
+  std::array const masks{format.Rmask, format.Gmask, format.Bmask,
+                         format.Amask};
+  std::array const losses{format.Rloss, format.Gloss, format.Bloss,
+                          format.Aloss};
+  std::array const shifts{format.Rshift, format.Gshift, format.Bshift,
+                          format.Ashift};
+  ChannelOffsets offsets{};
+  for (auto const index : iter::range(std::size_t{4})) {
+    if (masks.at(index) == 0 && index == 3) {
+      offsets.at(index) = -1;
+      continue;
+    }
+    if (masks.at(index) == 0 || losses.at(index) != 0 ||
+        shifts.at(index) % 8 != 0)
+      return std::nullopt;
+    offsets.at(index) = toOffset(shifts.at(index));
+  }
+  return offsets;
+}
+
+// Converts the pixels of a row starting at column x, one pixel at a time
+void convertRowScalar(std::byte const *source, std::byte *destination,
+                      int width, int x, int sourceBytesPerPixel,
+                      int destinationBytesPerPixel,
+                      ChannelOffsets const &offsets, bool reverse) {
+  for (; x < width; ++x) {
+    auto const sourceIndex{reverse ? width - 1 - x : x};
+    auto const *sourcePixel{source + sourceIndex * sourceBytesPerPixel};
+    auto *destinationPixel{destination + x * destinationBytesPerPixel};
+    for (auto const channel : iter::range(destinationBytesPerPixel)) {
+      auto const offset{offsets.at(gsl::narrow<std::size_t>(channel))};
+      destinationPixel[channel] =
+          offset < 0 ? std::byte{0xFF} : sourcePixel[offset];
+    }
+  }
+}
+
+#if defined(ABCG_IMAGE_SSE2)
+// Converts groups of four 32-bit pixels whose red and blue channels are at
+// offsets 0 and 2 (in any order), green at 1, and alpha (if any) at 3. Returns
+// the number of pixels converted.
+int convertRowSSE2(std::byte const *source, std::byte *destination, int width,
+                   bool swapRedBlue, bool opaque, bool reverse) {
+  auto const alphaMask{_mm_set1_epi32(static_cast<int>(0xFF000000U))};
+  auto const greenAlphaMask{_mm_set1_epi32(static_cast<int>(0xFF00FF00U))};
+  auto const lowByteMask{_mm_set1_epi32(0xFF)};
+
+  int x{};
+  for (; x + 4 <= width; x += 4) {
+    auto const sourceIndex{reverse ? width - x - 4 : x};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto pixels{_mm_loadu_si128(reinterpret_cast<__m128i const *>(
+        source + sourceIndex * 4))};
+    if (reverse) {
+      pixels = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+    if (swapRedBlue) {
+      auto const red{_mm_and_si128(_mm_srli_epi32(pixels, 16), lowByteMask)};
+      auto const blue{_mm_slli_epi32(_mm_and_si128(pixels, lowByteMask), 16)};
+      pixels = _mm_or_si128(_mm_and_si128(pixels, greenAlphaMask),
+                            _mm_or_si128(red, blue));
+    }
+    if (opaque) {
+      pixels = _mm_or_si128(pixels, alphaMask);
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x * 4), pixels);
+  }
+  return x;
+}
+#elif defined(ABCG_IMAGE_NEON)
+uint8x16_t reverseBytes(uint8x16_t bytes) {
+  auto const reversedHalves{vrev64q_u8(bytes)};
+  return vextq_u8(reversedHalves, reversedHalves, 8);
+}
+
+// Converts groups of 16 pixels by deinterleaving the channels. Returns the
+// number of pixels converted.
+template <int SourceBytesPerPixel, int DestinationBytesPerPixel>
+int convertRowNEON(std::byte const *source, std::byte *destination, int width,
+                   ChannelOffsets const &offsets, bool reverse) {
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto const *sourceBytes{reinterpret_cast<uint8_t const *>(source)};
+  auto *destinationBytes{reinterpret_cast<uint8_t *>(destination)};
+  // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+  int x{};
+  for (; x + 16 <= width; x += 16) {
+    auto const sourceIndex{reverse ? width - x - 16 : x};
+    std::array<uint8x16_t, 4> sourceChannels{};
+    if constexpr (SourceBytesPerPixel == 3) {
+      auto const channels{vld3q_u8(sourceBytes + sourceIndex * 3)};
+      sourceChannels = {channels.val[0], channels.val[1], channels.val[2],
+                        vdupq_n_u8(0xFF)};
+    } else {
+      auto const channels{vld4q_u8(sourceBytes + sourceIndex * 4)};
+      sourceChannels = {channels.val[0], channels.val[1], channels.val[2],
+                        channels.val[3]};
+    }
+
+    std::array<uint8x16_t, 4> channels{};
+    for (auto const index : iter::range(std::size_t{4})) {
+      auto const offset{offsets.at(index)};
+      channels.at(index) =
+          offset < 0 ? vdupq_n_u8(0xFF)
+                     : sourceChannels.at(gsl::narrow<std::size_t>(offset));
+      if (reverse) {
+        channels.at(index) = reverseBytes(channels.at(index));
+      }
+    }
+
+    if constexpr (DestinationBytesPerPixel == 3) {
+      vst3q_u8(destinationBytes + x * 3,
+               uint8x16x3_t{{channels[0], channels[1], channels[2]}});
+    } else {
+      vst4q_u8(destinationBytes + x * 4,
+               uint8x16x4_t{
+                   {channels[0], channels[1], channels[2], channels[3]}});
+    }
+  }
+  return x;
+}
+#endif
+
+void convertRow(std::byte const *source, std::byte *destination, int width,
+                int sourceBytesPerPixel, int destinationBytesPerPixel,
+                ChannelOffsets const &offsets, bool reverse) {
+  // Same layout: plain copy
+  auto const isSameLayout{sourceBytesPerPixel == destinationBytesPerPixel &&
+                          offsets[0] == 0 && offsets[1] == 1 &&
+                          offsets[2] == 2 &&
+                          (destinationBytesPerPixel == 3 || offsets[3] == 3)};
+  if (isSameLayout && !reverse) {
+    std::memcpy(destination, source,
+                gsl::narrow<std::size_t>(width * destinationBytesPerPixel));
+    return;
+  }
+
+  int x{};
+#if defined(ABCG_IMAGE_SSE2)
+  auto const isRGBAOrBGRA{
+      offsets[1] == 1 && (offsets[3] == 3 || offsets[3] < 0) &&
+      ((offsets[0] == 0 && offsets[2] == 2) ||
+       (offsets[0] == 2 && offsets[2] == 0))};
+  if (sourceBytesPerPixel == 4 && destinationBytesPerPixel == 4 &&
+      isRGBAOrBGRA) {
+    x = convertRowSSE2(source, destination, width, offsets[0] == 2,
+                       offsets[3] < 0, reverse);
+  }
+#elif defined(ABCG_IMAGE_NEON)
+  if (sourceBytesPerPixel == 3) {
+    x = destinationBytesPerPixel == 3
+            ? convertRowNEON<3, 3>(source, destination, width, offsets, reverse)
+            : convertRowNEON<3, 4>(source, destination, width, offsets,
+                                   reverse);
+  } else {
+    x = destinationBytesPerPixel == 3
+            ? convertRowNEON<4, 3>(source, destination, width, offsets, reverse)
+            : convertRowNEON<4, 4>(source, destination, width, offsets,
+                                   reverse);
+  }
+#endif
+
+  // Remaining pixels, or all of them if no SIMD path applies
+  convertRowScalar(source, destination, width, x, sourceBytesPerPixel,
+                   destinationBytesPerPixel, offsets, reverse);
+}
+
+} // namespace
+
+/**
+ * @brief Converts an image to RGB or RGBA, optionally flipping it.
+ *
+ * The conversion and the flips are done in a single pass over the pixels,
+ * using SSE2 or NEON when available. Formats without 8-bit channels (e.g.,
+ * palettized images) are first converted with `SDL_ConvertSurfaceFormat`.
+ *
+ * The output rows are tightly packed, except for padding at the end of each
+ * row to make the row size a multiple of 4 bytes. This matches the default
+ * `GL_UNPACK_ALIGNMENT` of OpenGL.
+ *
+ * @param surface SDL surface of the source image.
+ * @param convertInfo Conversion settings.
+ * @param pixels Buffer that receives the converted pixels. It is resized as
+ * needed, so the same buffer can be reused by subsequent calls to avoid
+ * reallocations.
+ *
+ * @throw abcg::RuntimeError if the surface could not be converted.
+ *
+ * @return Size of each row of the output, in bytes.
+ */
+std::size_t abcg::convertSurface(SDL_Surface &surface,
+                                 ConvertSurfaceInfo const &convertInfo,
+                                 std::vector<std::byte> &pixels) {
+  auto const bytesPerPixel{convertInfo.bytesPerPixel};
+  Expects(bytesPerPixel == 3 || bytesPerPixel == 4);
+
+  SDL_Surface *source{&surface};
+  SDL_Surface *formattedSurface{};
+  auto const freeFormattedSurface{gsl::finally([&formattedSurface] {
+    if (formattedSurface != nullptr) {
+      SDL_FreeSurface(formattedSurface);
+    }
+  })};
+
+  auto offsets{getChannelOffsets(*surface.format)};
+  if (!offsets) {
+    formattedSurface = SDL_ConvertSurfaceFormat(
+        &surface,
+        bytesPerPixel == 3 ? SDL_PIXELFORMAT_RGB24 : SDL_PIXELFORMAT_RGBA32, 0);
+    if (formattedSurface == nullptr) {
+      throw abcg::RuntimeError(
+          fmt::format("Failed to convert surface: {}", SDL_GetError()));
+    }
+    source = formattedSurface;
+    offsets = getChannelOffsets(*source->format);
+  }
+
+  auto const width{source->w};
+  auto const height{source->h};
+  auto const rowSize{
+      (gsl::narrow<std::size_t>(width * bytesPerPixel) + 3) / 4 * 4};
+  pixels.resize(rowSize * gsl::narrow<std::size_t>(height));
+
+  SDL_LockSurface(source);
+
+  auto const *sourcePixels{static_cast<std::byte const *>(source->pixels)};
+  auto const sourcePitch{gsl::narrow<std::size_t>(source->pitch)};
+  for (auto const rowIndex : iter::range(height)) {
+    auto const sourceRow{gsl::narrow<std::size_t>(
+        convertInfo.flipVertically ? height - 1 - rowIndex : rowIndex)};
+    convertRow(sourcePixels + sourceRow * sourcePitch,
+               pixels.data() + gsl::narrow<std::size_t>(rowIndex) * rowSize,
+               width, source->format->BytesPerPixel, bytesPerPixel, *offsets,
+               convertInfo.flipHorizontally);
+  }
+
+  SDL_UnlockSurface(source);
+
+  return rowSize;
+}
+
 /**
  * @brief Flips an image horizontally.
  *
@@ -13,9 +13,30 @@
 
 #include <SDL_image.h>
 
+#include <cstddef>
+#include <vector>
+
 namespace abcg {
+struct ConvertSurfaceInfo;
+
+std::size_t convertSurface(SDL_Surface &surface,
+                           ConvertSurfaceInfo const &convertInfo,
+                           std::vector<std::byte> &pixels);
 void flipHorizontally(SDL_Surface &surface);
 void flipVertically(SDL_Surface &surface);
 } // namespace abcg
 
+/**
+ * @brief Configuration settings for converting a SDL surface with
+ * abcg::convertSurface.
+ */
+struct abcg::ConvertSurfaceInfo {
+  /** @brief Number of bytes per pixel of the output: 3 for RGB, 4 for RGBA. */
+  int bytesPerPixel{4};
+  /** @brief Whether to reverse each row of the image. */
+  bool flipHorizontally{false};
+  /** @brief Whether to reverse the order of the rows of the image. */
+  bool flipVertically{false};
+};
+
 #endif
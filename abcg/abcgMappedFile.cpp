@@ -0,0 +1,175 @@
+/**
+ * @file abcgMappedFile.cpp
+ * @brief Definition of abcg::MappedFile members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgMappedFile.hpp"
+
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Releases the mapping.
+ */
+abcg::MappedFile::~MappedFile() { close(); }
+
+/**
+ * @brief Move constructor.
+ *
+ * @param other Mapped file to be moved. It is left closed.
+ */
+abcg::MappedFile::MappedFile(MappedFile &&other) noexcept
+    : m_data{std::exchange(other.m_data, nullptr)},
+      m_size{std::exchange(other.m_size, 0)}
+#if defined(_WIN32)
+      ,
+      m_file{std::exchange(other.m_file, nullptr)},
+      m_mapping{std::exchange(other.m_mapping, nullptr)}
+#endif
+{
+}
+
+/**
+ * @brief Move assignment operator.
+ *
+ * @param other Mapped file to be moved. It is left closed.
+ *
+ * @return Reference to this object.
+ */
+abcg::MappedFile &abcg::MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+#if defined(_WIN32)
+    m_file = std::exchange(other.m_file, nullptr);
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+  }
+  return *this;
+}
+
+/**
+ * @brief Maps a file into memory for reading.
+ *
+ * Any file previously opened by this object is closed first.
+ *
+ * @param path Path to the file.
+ *
+ * @return `true` if the file was mapped; `false` if it does not exist, is
+ * empty, or could not be mapped.
+ */
+bool abcg::MappedFile::open(std::filesystem::path const &path) {
+  close();
+
+#if defined(_WIN32)
+  m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE) {
+    m_file = nullptr;
+    return false;
+  }
+
+  LARGE_INTEGER fileSize{};
+  if (GetFileSizeEx(m_file, &fileSize) == 0 || fileSize.QuadPart == 0) {
+    close();
+    return false;
+  }
+
+  m_mapping =
+      CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (m_mapping == nullptr) {
+    close();
+    return false;
+  }
+
+  auto *const view{MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)};
+  if (view == nullptr) {
+    close();
+    return false;
+  }
+
+  m_data = static_cast<std::byte const *>(view);
+  m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+  auto const file{::open(path.c_str(), O_RDONLY)};
+  if (file < 0)
+    return false;
+
+  struct stat status {};
+  if (fstat(file, &status) != 0 || status.st_size <= 0) {
+    ::close(file);
+    return false;
+  }
+
+  auto const size{static_cast<std::size_t>(status.st_size)};
+  auto *const view{mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0)};
+  // The mapping remains valid after the file descriptor is closed
+  ::close(file);
+  if (view == MAP_FAILED)
+    return false;
+
+  m_data = static_cast<std::byte const *>(view);
+  m_size = size;
+#endif
+
+  return true;
+}
+
+/**
+ * @brief Releases the mapping.
+ */
+void abcg::MappedFile::close() noexcept {
+#if defined(_WIN32)
+  if (m_data != nullptr) {
+    UnmapViewOfFile(m_data);
+  }
+  if (m_mapping != nullptr) {
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+  }
+  if (m_file != nullptr) {
+    CloseHandle(m_file);
+    m_file = nullptr;
+  }
+#else
+  if (m_data != nullptr) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    munmap(const_cast<std::byte *>(m_data), m_size);
+  }
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
+
+/**
+ * @brief Returns whether a file is mapped.
+ *
+ * @return `true` if a file is mapped; `false` otherwise.
+ */
+bool abcg::MappedFile::isOpen() const noexcept { return m_data != nullptr; }
+
+/**
+ * @brief Returns the contents of the file.
+ *
+ * @return Read-only view of the mapped bytes, or an empty span if no file is
+ * mapped.
+ */
+std::span<std::byte const> abcg::MappedFile::getData() const noexcept {
+  return {m_data, m_size};
+}
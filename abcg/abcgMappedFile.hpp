@@ -0,0 +1,59 @@
+/**
+ * @file abcgMappedFile.hpp
+ * @brief Header file of abcg::MappedFile.
+ *
+ * Declaration of abcg::MappedFile.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MAPPED_FILE_HPP_
+#define ABCG_MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace abcg {
+class MappedFile;
+} // namespace abcg
+
+/**
+ * @brief A read-only view of a file mapped into memory.
+ *
+ * The contents of the file are paged in by the operating system on demand, so
+ * opening a large file is cheap and its data can be passed directly to
+ * functions such as `glBufferData` without an intermediate copy.
+ *
+ * @remark Objects of this type can be moved but not copied. The mapping is
+ * released when the object is destroyed.
+ */
+class abcg::MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  bool open(std::filesystem::path const &path);
+  void close() noexcept;
+
+  [[nodiscard]] bool isOpen() const noexcept;
+  [[nodiscard]] std::span<std::byte const> getData() const noexcept;
+
+private:
+  std::byte const *m_data{};
+  std::size_t m_size{};
+#if defined(_WIN32)
+  void *m_file{};
+  void *m_mapping{};
+#endif
+};
+
+#endif
@@ -0,0 +1,299 @@
+/**
+ * @file abcgMeshAttributes.cpp
+ * @brief Definition of functions for computing vertex normals and tangents of
+ * indexed triangle meshes.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgMeshAttributes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <future>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ABCG_MESH_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define ABCG_MESH_NEON
+#include <arm_neon.h>
+#endif
+
+#include "abcgThreadPool.hpp"
+
+namespace {
+// Number of vertices gathered and then normalized together
+constexpr std::size_t batchSize{256};
+
+// Minimum number of elements processed by each task
+constexpr std::size_t minRangeSize{std::size_t{1} << 14};
+
+// Components of a batch of vectors, stored as separate arrays
+struct Batch {
+  std::array<float, batchSize> x;
+  std::array<float, batchSize> y;
+  std::array<float, batchSize> z;
+};
+
+// Calls fun(first, last) for consecutive ranges of [0, count) in the worker
+// threads of the pool, and waits for all of them to finish
+template <typename TFun>
+void parallelFor(abcg::ThreadPool &pool, std::size_t count, TFun const &fun) {
+  auto const numRanges{std::clamp(count / minRangeSize, std::size_t{1},
+                                  pool.getThreadCount() + 1)};
+  auto const rangeSize{(count + numRanges - 1) / numRanges};
+
+  std::vector<std::future<void>> ranges;
+  for (std::size_t first{}; first < count; first += rangeSize) {
+    auto const last{std::min(first + rangeSize, count)};
+    ranges.push_back(pool.submit([&fun, first, last] { fun(first, last); }));
+  }
+
+  // The tasks reference the arguments, so wait for all of them
+  for (auto const &range : ranges) {
+    range.wait();
+  }
+  for (auto &range : ranges) {
+    range.get();
+  }
+}
+
+// Normalizes the first count vectors of a batch. Vectors of zero length are
+// left unchanged.
+void normalizeBatch(Batch &batch, std::size_t count) {
+  std::size_t i{};
+#if defined(ABCG_MESH_SSE2)
+  auto const zero{_mm_setzero_ps()};
+  auto const one{_mm_set1_ps(1.0f)};
+  for (; i + 4 <= count; i += 4) {
+    auto const x{_mm_loadu_ps(&batch.x[i])};
+    auto const y{_mm_loadu_ps(&batch.y[i])};
+    auto const z{_mm_loadu_ps(&batch.z[i])};
+    auto const length{_mm_sqrt_ps(_mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)))};
+    // Divide by one where the length is zero
+    auto const isZero{_mm_cmpeq_ps(length, zero)};
+    auto const divisor{
+        _mm_or_ps(_mm_andnot_ps(isZero, length), _mm_and_ps(isZero, one))};
+    _mm_storeu_ps(&batch.x[i], _mm_div_ps(x, divisor));
+    _mm_storeu_ps(&batch.y[i], _mm_div_ps(y, divisor));
+    _mm_storeu_ps(&batch.z[i], _mm_div_ps(z, divisor));
+  }
+#elif defined(ABCG_MESH_NEON)
+  auto const zero{vdupq_n_f32(0.0f)};
+  auto const one{vdupq_n_f32(1.0f)};
+  for (; i + 4 <= count; i += 4) {
+    auto const x{vld1q_f32(&batch.x[i])};
+    auto const y{vld1q_f32(&batch.y[i])};
+    auto const z{vld1q_f32(&batch.z[i])};
+    auto const length{
+        vsqrtq_f32(vmlaq_f32(vmlaq_f32(vmulq_f32(x, x), y, y), z, z))};
+    // Divide by one where the length is zero
+    auto const divisor{vbslq_f32(vceqq_f32(length, zero), one, length)};
+    vst1q_f32(&batch.x[i], vdivq_f32(x, divisor));
+    vst1q_f32(&batch.y[i], vdivq_f32(y, divisor));
+    vst1q_f32(&batch.z[i], vdivq_f32(z, divisor));
+  }
+#endif
+  for (; i < count; ++i) {
+    auto const length{std::sqrt(batch.x[i] * batch.x[i] +
+                                batch.y[i] * batch.y[i] +
+                                batch.z[i] * batch.z[i])};
+    if (length > 0.0f) {
+      batch.x[i] /= length;
+      batch.y[i] /= length;
+      batch.z[i] /= length;
+    }
+  }
+}
+} // namespace
+
+/**
+ * @brief Builds the vertex-to-triangle adjacency of a mesh.
+ *
+ * The adjacency lets per-vertex attributes be computed by gathering values of
+ * the adjacent triangles, which can be done concurrently for different
+ * vertices, instead of scattering values of each triangle to its vertices.
+ *
+ * @param indices Index array of the mesh, with three indices per triangle.
+ * @param numVertices Number of vertices of the mesh.
+ *
+ * @return Triangles adjacent to each vertex. A triangle that references a
+ * vertex more than once is listed once for each reference.
+ */
+abcg::VertexAdjacency
+abcg::buildVertexAdjacency(std::span<std::uint32_t const> indices,
+                           std::size_t numVertices) {
+  auto const numIndices{indices.size() - indices.size() % 3};
+
+  VertexAdjacency adjacency;
+  adjacency.offsets.assign(numVertices + 1, 0);
+  for (auto const index : indices.first(numIndices)) {
+    ++adjacency.offsets[index + 1];
+  }
+  std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(),
+                   adjacency.offsets.begin());
+
+  adjacency.triangles.resize(numIndices);
+  std::vector nextEntries(adjacency.offsets.begin(),
+                          adjacency.offsets.end() - 1);
+  for (std::size_t offset{}; offset < numIndices; ++offset) {
+    adjacency.triangles[nextEntries[indices[offset]]++] =
+        static_cast<std::uint32_t>(offset / 3);
+  }
+
+  return adjacency;
+}
+
+/**
+ * @brief Computes vertex normals as the normalized sum of the normals of the
+ * adjacent triangles, weighted by their areas.
+ *
+ * Each task gathers the normals of the triangles adjacent to a range of
+ * vertices and normalizes the sums in batches using SIMD instructions, if
+ * available. Triangle normals are recomputed for each of their vertices, as a
+ * cross product is cheaper than storing and reloading them.
+ *
+ * @param adjacency Vertex-to-triangle adjacency built with
+ * abcg::buildVertexAdjacency.
+ * @param indices Index array of the mesh, with three indices per triangle.
+ * @param positions Vertex positions of the mesh.
+ * @param normals Vertex normals to compute. The size must be the number of
+ * vertices of the adjacency. Vertices without non-degenerate adjacent
+ * triangles get a zero normal.
+ * @param threadPool Pool of worker threads. If null,
+ * abcg::ThreadPool::getDefault is used.
+ */
+void abcg::computeVertexNormals(VertexAdjacency const &adjacency,
+                                std::span<std::uint32_t const> indices,
+                                std::span<glm::vec3 const> positions,
+                                std::span<glm::vec3> normals,
+                                ThreadPool *threadPool) {
+  auto &pool{threadPool == nullptr ? ThreadPool::getDefault() : *threadPool};
+
+  parallelFor(pool, normals.size(), [&](auto first, auto last) {
+    Batch batch{};
+    for (auto batchFirst{first}; batchFirst < last; batchFirst += batchSize) {
+      auto const count{std::min(batchSize, last - batchFirst)};
+      for (std::size_t i{}; i < count; ++i) {
+        auto const vertex{batchFirst + i};
+        glm::vec3 sum{};
+        for (auto entry{adjacency.offsets[vertex]};
+             entry < adjacency.offsets[vertex + 1]; ++entry) {
+          auto const offset{std::size_t{adjacency.triangles[entry]} * 3};
+          auto const &a{positions[indices[offset + 0]]};
+          auto const &b{positions[indices[offset + 1]]};
+          auto const &c{positions[indices[offset + 2]]};
+          sum += glm::cross(b - a, c - b);
+        }
+        batch.x[i] = sum.x;
+        batch.y[i] = sum.y;
+        batch.z[i] = sum.z;
+      }
+
+      normalizeBatch(batch, count);
+
+      for (std::size_t i{}; i < count; ++i) {
+        normals[batchFirst + i] = {batch.x[i], batch.y[i], batch.z[i]};
+      }
+    }
+  });
+}
+
+/**
+ * @brief Computes vertex tangents from the texture coordinates of the
+ * adjacent triangles.
+ *
+ * The tangent of each vertex is orthogonalized with respect to its normal.
+ * The `w` component is the handedness of the tangent space (1 or -1), so that
+ * the bitangent is `cross(normal, tangent.xyz) * tangent.w`.
+ *
+ * The computation is parallelized and vectorized as in
+ * abcg::computeVertexNormals.
+ *
+ * @param adjacency Vertex-to-triangle adjacency built with
+ * abcg::buildVertexAdjacency.
+ * @param indices Index array of the mesh, with three indices per triangle.
+ * @param positions Vertex positions of the mesh.
+ * @param normals Vertex normals of the mesh.
+ * @param texCoords Vertex texture coordinates of the mesh.
+ * @param tangents Vertex tangents to compute. The size must be the number of
+ * vertices of the adjacency.
+ * @param threadPool Pool of worker threads. If null,
+ * abcg::ThreadPool::getDefault is used.
+ */
+void abcg::computeVertexTangents(VertexAdjacency const &adjacency,
+                                 std::span<std::uint32_t const> indices,
+                                 std::span<glm::vec3 const> positions,
+                                 std::span<glm::vec3 const> normals,
+                                 std::span<glm::vec2 const> texCoords,
+                                 std::span<glm::vec4> tangents,
+                                 ThreadPool *threadPool) {
+  auto &pool{threadPool == nullptr ? ThreadPool::getDefault() : *threadPool};
+
+  auto const numTriangles{indices.size() / 3};
+  std::vector<glm::vec3> triangleTangents(numTriangles);
+  std::vector<glm::vec3> triangleBitangents(numTriangles);
+  // Unlike normals, tangents are costly enough to be computed once per
+  // triangle
+  parallelFor(pool, numTriangles, [&](auto first, auto last) {
+    for (auto triangle{first}; triangle < last; ++triangle) {
+      auto const i1{indices[triangle * 3 + 0]};
+      auto const i2{indices[triangle * 3 + 1]};
+      auto const i3{indices[triangle * 3 + 2]};
+
+      auto const e1{positions[i2] - positions[i1]};
+      auto const e2{positions[i3] - positions[i1]};
+      auto const delta1{texCoords[i2] - texCoords[i1]};
+      auto const delta2{texCoords[i3] - texCoords[i1]};
+
+      auto const scale{1.0f / (delta1.s * delta2.t - delta2.s * delta1.t)};
+      triangleTangents[triangle] = (e1 * delta2.t - e2 * delta1.t) * scale;
+      triangleBitangents[triangle] = (e2 * delta1.s - e1 * delta2.s) * scale;
+    }
+  });
+
+  parallelFor(pool, tangents.size(), [&](auto first, auto last) {
+    Batch batch{};
+    std::array<float, batchSize> handedness{};
+    for (auto batchFirst{first}; batchFirst < last; batchFirst += batchSize) {
+      auto const count{std::min(batchSize, last - batchFirst)};
+      for (std::size_t i{}; i < count; ++i) {
+        auto const vertex{batchFirst + i};
+        glm::vec3 tangent{};
+        glm::vec3 bitangent{};
+        for (auto entry{adjacency.offsets[vertex]};
+             entry < adjacency.offsets[vertex + 1]; ++entry) {
+          tangent += triangleTangents[adjacency.triangles[entry]];
+          bitangent += triangleBitangents[adjacency.triangles[entry]];
+        }
+
+        // Orthogonalize with respect to the normal
+        auto const &normal{normals[vertex]};
+        auto const orthogonal{tangent -
+                              normal * glm::dot(normal, tangent)};
+        batch.x[i] = orthogonal.x;
+        batch.y[i] = orthogonal.y;
+        batch.z[i] = orthogonal.z;
+
+        auto const isLeftHanded{
+            glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f};
+        handedness[i] = isLeftHanded ? -1.0f : 1.0f;
+      }
+
+      normalizeBatch(batch, count);
+
+      for (std::size_t i{}; i < count; ++i) {
+        tangents[batchFirst + i] = {batch.x[i], batch.y[i], batch.z[i],
+                                    handedness[i]};
+      }
+    }
+  });
+}
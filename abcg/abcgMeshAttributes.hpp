@@ -0,0 +1,57 @@
+/**
+ * @file abcgMeshAttributes.hpp
+ * @brief Declaration of functions for computing vertex normals and tangents of
+ * indexed triangle meshes.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESH_ATTRIBUTES_HPP_
+#define ABCG_MESH_ATTRIBUTES_HPP_
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "abcgExternal.hpp"
+
+namespace abcg {
+class ThreadPool;
+struct VertexAdjacency;
+
+[[nodiscard]] VertexAdjacency
+buildVertexAdjacency(std::span<std::uint32_t const> indices,
+                     std::size_t numVertices);
+void computeVertexNormals(VertexAdjacency const &adjacency,
+                          std::span<std::uint32_t const> indices,
+                          std::span<glm::vec3 const> positions,
+                          std::span<glm::vec3> normals,
+                          ThreadPool *threadPool = nullptr);
+void computeVertexTangents(VertexAdjacency const &adjacency,
+                           std::span<std::uint32_t const> indices,
+                           std::span<glm::vec3 const> positions,
+                           std::span<glm::vec3 const> normals,
+                           std::span<glm::vec2 const> texCoords,
+                           std::span<glm::vec4> tangents,
+                           ThreadPool *threadPool = nullptr);
+} // namespace abcg
+
+/**
+ * @brief Triangles adjacent to each vertex of a mesh, in compressed sparse row
+ * format.
+ *
+ * The triangles adjacent to vertex `i` are
+ * `triangles[offsets[i]]`, ..., `triangles[offsets[i + 1] - 1]`.
+ */
+struct abcg::VertexAdjacency {
+  /** @brief Position in `triangles` of the first triangle of each vertex,
+   * followed by the total number of entries. */
+  std::vector<std::uint32_t> offsets;
+  /** @brief Triangles adjacent to each vertex, grouped by vertex. */
+  std::vector<std::uint32_t> triangles;
+};
+
+#endif
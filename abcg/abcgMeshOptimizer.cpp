@@ -0,0 +1,904 @@
+/**
+ * @file abcgMeshOptimizer.cpp
+ * @brief Definition of functions for optimizing indexed triangle meshes.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgMeshOptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <optional>
+
+#include "abcgVertexWelder.hpp"
+
+namespace {
+
+// Size of the LRU cache modeled by the vertex cache optimization
+constexpr std::size_t maxCacheSize{32};
+
+// Score of a vertex as proposed by Tom Forsyth in "Linear-Speed Vertex Cache
+// Optimisation". Vertices in the cache score higher, except those of the last
+// triangle, and vertices with few remaining triangles get a boost so that
+// isolated triangles are not left behind.
+float vertexScore(int cachePosition, std::uint32_t numLiveTriangles) {
+  constexpr auto lastTriangleScore{0.75f};
+  constexpr auto cacheDecayPower{1.5f};
+  constexpr auto valenceBoostScale{2.0f};
+  constexpr auto valenceBoostPower{0.5f};
+
+  if (numLiveTriangles == 0)
+    return -1.0f;
+
+  auto score{0.0f};
+  if (cachePosition >= 0 && cachePosition < 3) {
+    score = lastTriangleScore;
+  } else if (cachePosition >= 3) {
+    auto const scale{1.0f / static_cast<float>(maxCacheSize - 3)};
+    score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale,
+                     cacheDecayPower);
+  }
+  return score + valenceBoostScale *
+                     std::pow(static_cast<float>(numLiveTriangles),
+                              -valenceBoostPower);
+}
+
+// Simulation of a FIFO vertex cache
+class FIFOCache {
+public:
+  FIFOCache(std::size_t numVertices, std::size_t cacheSize)
+      : m_timestamps(numVertices), m_cacheSize{cacheSize},
+        m_time{cacheSize + 1} {}
+
+  // Returns the number of cache misses of a triangle
+  std::size_t process(std::uint32_t const *triangle) {
+    std::size_t misses{};
+    for (auto const vertex : std::span{triangle, 3}) {
+      if (m_time - m_timestamps[vertex] > m_cacheSize) {
+        m_timestamps[vertex] = m_time++;
+        ++misses;
+      }
+    }
+    return misses;
+  }
+
+  void flush() { m_time += m_cacheSize + 1; }
+
+private:
+  std::vector<std::size_t> m_timestamps;
+  std::size_t m_cacheSize{};
+  std::size_t m_time{};
+};
+
+// Quadric error metric of Garland and Heckbert. Evaluates to the weighted sum
+// of squared distances of a point to a set of planes.
+struct Quadric {
+  double a2{}, ab{}, ac{}, ad{};
+  double b2{}, bc{}, bd{};
+  double c2{}, cd{};
+  double d2{};
+  double weight{};
+
+  static Quadric fromPlane(glm::dvec3 const &normal, double distance,
+                           double weight) {
+    auto const &n{normal};
+    return {.a2 = weight * n.x * n.x,
+            .ab = weight * n.x * n.y,
+            .ac = weight * n.x * n.z,
+            .ad = weight * n.x * distance,
+            .b2 = weight * n.y * n.y,
+            .bc = weight * n.y * n.z,
+            .bd = weight * n.y * distance,
+            .c2 = weight * n.z * n.z,
+            .cd = weight * n.z * distance,
+            .d2 = weight * distance * distance,
+            .weight = weight};
+  }
+
+  Quadric &operator+=(Quadric const &other) {
+    a2 += other.a2;
+    ab += other.ab;
+    ac += other.ac;
+    ad += other.ad;
+    b2 += other.b2;
+    bc += other.bc;
+    bd += other.bd;
+    c2 += other.c2;
+    cd += other.cd;
+    d2 += other.d2;
+    weight += other.weight;
+    return *this;
+  }
+
+  [[nodiscard]] double evaluate(glm::vec3 const &point) const {
+    glm::dvec3 const p{point};
+    auto const error{p.x * (a2 * p.x + 2.0 * (ab * p.y + ac * p.z + ad)) +
+                     p.y * (b2 * p.y + 2.0 * (bc * p.z + bd)) +
+                     p.z * (c2 * p.z + 2.0 * cd) + d2};
+    return std::max(error, 0.0);
+  }
+};
+
+// Kind of a vertex for the purpose of simplification
+enum class VertexKind : std::uint8_t {
+  Interior, // Can collapse along any edge
+  Border,   // Can collapse only along border edges
+  Locked    // Shares its position with other vertices (e.g., at UV seams)
+};
+
+std::uint64_t edgeKey(std::uint32_t first, std::uint32_t second) {
+  return (std::uint64_t{std::min(first, second)} << 32) |
+         std::max(first, second);
+}
+
+// Returns the sorted keys of the edges used by a single triangle
+std::vector<std::uint64_t>
+findBorderEdges(std::span<std::uint32_t const> indices,
+                std::span<std::uint32_t const> positionIDs) {
+  std::vector<std::uint64_t> edges;
+  edges.reserve(indices.size());
+  for (std::size_t first{}; first + 2 < indices.size(); first += 3) {
+    for (std::size_t corner{}; corner < 3; ++corner) {
+      edges.push_back(
+          edgeKey(positionIDs[indices[first + corner]],
+                  positionIDs[indices[first + (corner + 1) % 3]]));
+    }
+  }
+  std::ranges::sort(edges);
+
+  std::vector<std::uint64_t> borderEdges;
+  for (std::size_t index{}; index < edges.size();) {
+    auto next{index + 1};
+    while (next < edges.size() && edges[next] == edges[index]) {
+      ++next;
+    }
+    if (next - index == 1) {
+      borderEdges.push_back(edges[index]);
+    }
+    index = next;
+  }
+  return borderEdges;
+}
+
+// Returns the distance from a point to a line segment
+double segmentDistance(glm::dvec3 const &point, glm::dvec3 const &start,
+                       glm::dvec3 const &end) {
+  auto const edge{end - start};
+  auto const lengthSquared{glm::dot(edge, edge)};
+  auto const t{lengthSquared > 0.0
+                   ? std::clamp(glm::dot(point - start, edge) / lengthSquared,
+                                0.0, 1.0)
+                   : 0.0};
+  return glm::distance(point, start + t * edge);
+}
+
+// Returns the distance from a point to a triangle
+double triangleDistance(glm::dvec3 const &point,
+                        std::array<glm::dvec3, 3> const &corners) {
+  auto const normal{
+      glm::cross(corners[1] - corners[0], corners[2] - corners[0])};
+  auto const area{glm::length(normal)};
+
+  // Use the distance to the plane if the point projects inside the triangle
+  auto inside{area > 0.0};
+  for (std::size_t corner{}; corner < 3; ++corner) {
+    auto const &start{corners.at(corner)};
+    auto const &end{corners.at((corner + 1) % 3)};
+    if (glm::dot(glm::cross(end - start, point - start), normal) < 0.0) {
+      inside = false;
+    }
+  }
+  if (inside)
+    return std::abs(glm::dot(point - corners[0], normal)) / area;
+
+  auto distance{segmentDistance(point, corners[0], corners[1])};
+  distance = std::min(distance, segmentDistance(point, corners[1], corners[2]));
+  return std::min(distance, segmentDistance(point, corners[2], corners[0]));
+}
+
+} // namespace
+
+/**
+ * @brief Computes the average cache miss ratio (ACMR) of a triangle list.
+ *
+ * The ACMR is the average number of vertex shader invocations per triangle,
+ * assuming a post-transform vertex cache with FIFO replacement. It ranges from
+ * 3 (no reuse) down to about 0.5 for large regular meshes.
+ *
+ * @param indices Index array of the mesh, with three indices per triangle.
+ * @param numVertices Number of vertices of the mesh.
+ * @param cacheSize Number of entries of the simulated cache.
+ *
+ * @return ACMR of the triangle list, or 0 if there are no triangles.
+ */
+float abcg::computeACMR(std::span<std::uint32_t const> indices,
+                        std::size_t numVertices, std::size_t cacheSize) {
+  auto const numTriangles{indices.size() / 3};
+  if (numTriangles == 0)
+    return 0.0f;
+
+  FIFOCache cache{numVertices, cacheSize};
+  std::size_t misses{};
+  for (std::size_t triangle{}; triangle < numTriangles; ++triangle) {
+    misses += cache.process(&indices[triangle * 3]);
+  }
+  return static_cast<float>(misses) / static_cast<float>(numTriangles);
+}
+
+/**
+ * @brief Reorders the triangles of a mesh for post-transform vertex cache
+ * locality.
+ *
+ * This implements Tom Forsyth's linear-speed vertex cache optimization. The
+ * result is independent of the exact cache size and replacement policy of the
+ * GPU.
+ *
+ * @param indices Index array of the mesh, with three indices per triangle.
+ * @param numVertices Number of vertices of the mesh.
+ */
+void abcg::optimizeVertexCache(std::span<std::uint32_t> indices,
+                               std::size_t numVertices) {
+  auto const numTriangles{indices.size() / 3};
+  if (numTriangles == 0)
+    return;
+
+  // Triangles adjacent to each vertex, in compressed sparse row format. The
+  // first numLiveTriangles[vertex] entries are those not yet emitted.
+  std::vector<std::uint32_t> numLiveTriangles(numVertices);
+  for (auto const index : indices) {
+    ++numLiveTriangles[index];
+  }
+  std::vector<std::size_t> offsets(numVertices + 1);
+  for (std::size_t vertex{}; vertex < numVertices; ++vertex) {
+    offsets[vertex + 1] = offsets[vertex] + numLiveTriangles[vertex];
+  }
+  std::vector<std::uint32_t> adjacency(indices.size());
+  {
+    auto next{offsets};
+    for (std::size_t corner{}; corner < indices.size(); ++corner) {
+      adjacency[next[indices[corner]]++] =
+          static_cast<std::uint32_t>(corner / 3);
+    }
+  }
+
+  std::vector<int> cachePositions(numVertices, -1);
+  std::vector<float> vertexScores(numVertices);
+  for (std::size_t vertex{}; vertex < numVertices; ++vertex) {
+    vertexScores[vertex] = vertexScore(-1, numLiveTriangles[vertex]);
+  }
+  std::vector<float> triangleScores(numTriangles);
+  for (std::size_t triangle{}; triangle < numTriangles; ++triangle) {
+    triangleScores[triangle] = vertexScores[indices[triangle * 3 + 0]] +
+                               vertexScores[indices[triangle * 3 + 1]] +
+                               vertexScores[indices[triangle * 3 + 2]];
+  }
+
+  std::vector<bool> isEmitted(numTriangles);
+  std::vector<std::uint32_t> output;
+  output.reserve(indices.size());
+
+  std::array<std::uint32_t, maxCacheSize + 3> cache{};
+  std::array<std::uint32_t, maxCacheSize + 3> newCache{};
+  std::size_t cacheCount{};
+  std::size_t nextInputTriangle{};
+
+  auto bestTriangle{static_cast<std::size_t>(std::distance(
+      triangleScores.begin(), std::ranges::max_element(triangleScores)))};
+
+  while (output.size() < indices.size()) {
+    // If no cached vertex has live triangles, continue in input order
+    if (bestTriangle == numTriangles) {
+      while (isEmitted[nextInputTriangle]) {
+        ++nextInputTriangle;
+      }
+      bestTriangle = nextInputTriangle;
+    }
+
+    isEmitted[bestTriangle] = true;
+    auto const triangle{indices.subspan(bestTriangle * 3, 3)};
+    output.insert(output.end(), triangle.begin(), triangle.end());
+
+    // Remove the triangle from the live triangles of its vertices
+    for (auto const vertex : triangle) {
+      auto const first{adjacency.begin() +
+                       static_cast<std::ptrdiff_t>(offsets[vertex])};
+      auto const last{first + numLiveTriangles[vertex]};
+      std::iter_swap(std::find(first, last, bestTriangle), last - 1);
+      --numLiveTriangles[vertex];
+    }
+
+    // Move the vertices of the triangle to the front of the cache
+    std::size_t newCacheCount{};
+    for (auto const vertex : triangle) {
+      if (std::find(newCache.begin(), newCache.begin() + newCacheCount,
+                    vertex) == newCache.begin() + newCacheCount) {
+        newCache[newCacheCount++] = vertex;
+      }
+    }
+    for (auto const vertex : std::span{cache.data(), cacheCount}) {
+      if (std::ranges::find(triangle, vertex) == triangle.end()) {
+        newCache[newCacheCount++] = vertex;
+      }
+    }
+
+    // Update the scores of the vertices in the cache, including those that
+    // were pushed out, and of their live triangles
+    for (std::size_t position{}; position < newCacheCount; ++position) {
+      auto const vertex{newCache[position]};
+      cachePositions[vertex] =
+          position < maxCacheSize ? static_cast<int>(position) : -1;
+      auto const score{
+          vertexScore(cachePositions[vertex], numLiveTriangles[vertex])};
+      auto const delta{score - vertexScores[vertex]};
+      vertexScores[vertex] = score;
+      for (auto const liveTriangle :
+           std::span{&adjacency[offsets[vertex]], numLiveTriangles[vertex]}) {
+        triangleScores[liveTriangle] += delta;
+      }
+    }
+    cacheCount = std::min(newCacheCount, maxCacheSize);
+    std::copy_n(newCache.begin(), cacheCount, cache.begin());
+
+    // The next triangle is the best one among those that use cached vertices
+    bestTriangle = numTriangles;
+    auto bestScore{-1.0f};
+    for (auto const vertex : std::span{cache.data(), cacheCount}) {
+      for (auto const liveTriangle :
+           std::span{&adjacency[offsets[vertex]], numLiveTriangles[vertex]}) {
+        if (triangleScores[liveTriangle] > bestScore) {
+          bestScore = triangleScores[liveTriangle];
+          bestTriangle = liveTriangle;
+        }
+      }
+    }
+  }
+
+  std::ranges::copy(output, indices.begin());
+}
+
+/**
+ * @brief Reorders clusters of triangles of a mesh to reduce overdraw.
+ *
+ * This implements the method of Sander et al. in "Fast Triangle Reordering for
+ * Vertex Locality and Reduced Overdraw". The triangle list is split into
+ * clusters that start with a cold vertex cache, and the clusters are sorted so
+ * that those facing outwards from the center of the mesh are drawn first.
+ *
+ * The mesh should have been processed by abcg::optimizeVertexCache.
+ *
+ * @param indices Index array of the mesh, with three indices per triangle.
+ * @param positions Vertex positions of the mesh.
+ * @param threshold Maximum allowed increase of the ACMR. Larger values create
+ * more clusters, which reduces overdraw at the cost of vertex cache locality.
+ */
+void abcg::optimizeOverdraw(std::span<std::uint32_t> indices,
+                            std::span<glm::vec3 const> positions,
+                            float threshold) {
+  auto const numTriangles{indices.size() / 3};
+  if (numTriangles == 0)
+    return;
+
+  constexpr std::size_t cacheSize{16};
+
+  // Hard boundaries are triangles with three cache misses
+  std::vector<std::size_t> misses(numTriangles);
+  std::vector<std::size_t> hardBoundaries;
+  {
+    FIFOCache cache{positions.size(), cacheSize};
+    for (std::size_t triangle{}; triangle < numTriangles; ++triangle) {
+      misses[triangle] = cache.process(&indices[triangle * 3]);
+      if (triangle == 0 || misses[triangle] == 3) {
+        hardBoundaries.push_back(triangle);
+      }
+    }
+    hardBoundaries.push_back(numTriangles);
+  }
+
+  // Split each cluster further where a cluster starting with a cold cache
+  // already has an ACMR close to that of the whole cluster
+  struct Cluster {
+    std::size_t first{};
+    std::size_t last{};
+    float sortKey{};
+  };
+  std::vector<Cluster> clusters;
+  FIFOCache cache{positions.size(), cacheSize};
+  for (std::size_t index{}; index + 1 < hardBoundaries.size(); ++index) {
+    auto const first{hardBoundaries[index]};
+    auto const last{hardBoundaries[index + 1]};
+    std::size_t clusterMisses{};
+    for (auto triangle{first}; triangle < last; ++triangle) {
+      clusterMisses += misses[triangle];
+    }
+    auto const maxACMR{threshold * static_cast<float>(clusterMisses) /
+                       static_cast<float>(last - first)};
+
+    cache.flush();
+    auto clusterFirst{first};
+    std::size_t runningMisses{};
+    for (auto triangle{first}; triangle < last; ++triangle) {
+      runningMisses += cache.process(&indices[triangle * 3]);
+      auto const count{triangle + 1 - clusterFirst};
+      if (triangle + 1 < last && static_cast<float>(runningMisses) <=
+                                     maxACMR * static_cast<float>(count)) {
+        clusters.push_back({.first = clusterFirst, .last = triangle + 1});
+        clusterFirst = triangle + 1;
+        runningMisses = 0;
+        cache.flush();
+      }
+    }
+    clusters.push_back({.first = clusterFirst, .last = last});
+  }
+
+  // Area-weighted centroids and normals of the clusters and of the mesh
+  std::vector<glm::vec3> centroids(clusters.size());
+  std::vector<glm::vec3> normals(clusters.size());
+  glm::vec3 meshCentroid{};
+  auto meshArea{0.0f};
+  for (auto &&[index, cluster] : iter::enumerate(clusters)) {
+    auto clusterArea{0.0f};
+    for (auto triangle{cluster.first}; triangle < cluster.last; ++triangle) {
+      auto const &a{positions[indices[triangle * 3 + 0]]};
+      auto const &b{positions[indices[triangle * 3 + 1]]};
+      auto const &c{positions[indices[triangle * 3 + 2]]};
+      auto const normal{glm::cross(b - a, c - a)};
+      auto const area{glm::length(normal)};
+      centroids[index] += (a + b + c) * (area / 3.0f);
+      normals[index] += normal;
+      clusterArea += area;
+    }
+    meshCentroid += centroids[index];
+    meshArea += clusterArea;
+    if (clusterArea > 0.0f) {
+      centroids[index] /= clusterArea;
+    }
+  }
+  if (meshArea > 0.0f) {
+    meshCentroid /= meshArea;
+  }
+
+  for (auto &&[index, cluster] : iter::enumerate(clusters)) {
+    auto const normalLength{glm::length(normals[index])};
+    cluster.sortKey =
+        normalLength > 0.0f
+            ? glm::dot(centroids[index] - meshCentroid, normals[index]) /
+                  normalLength
+            : 0.0f;
+  }
+
+  // Draw the clusters that face outwards first
+  std::ranges::stable_sort(clusters, std::ranges::greater{},
+                           &Cluster::sortKey);
+
+  std::vector<std::uint32_t> output;
+  output.reserve(indices.size());
+  for (auto const &cluster : clusters) {
+    output.insert(output.end(),
+                  indices.begin() +
+                      static_cast<std::ptrdiff_t>(cluster.first * 3),
+                  indices.begin() +
+                      static_cast<std::ptrdiff_t>(cluster.last * 3));
+  }
+  std::ranges::copy(output, indices.begin());
+}
+
+/**
+ * @brief Computes a vertex remap table that sorts vertices in the order they
+ * are first referenced by an index array.
+ *
+ * @param indices Index array of the mesh.
+ * @param numVertices Number of vertices of the mesh.
+ *
+ * @return New index of each vertex. Vertices not referenced by the index
+ * array are mapped to `std::numeric_limits<std::uint32_t>::max()`.
+ */
+std::vector<std::uint32_t>
+abcg::computeVertexFetchRemap(std::span<std::uint32_t const> indices,
+                              std::size_t numVertices) {
+  std::vector remap(numVertices, std::numeric_limits<std::uint32_t>::max());
+  std::uint32_t nextVertex{};
+  for (auto const index : indices) {
+    if (remap[index] == std::numeric_limits<std::uint32_t>::max()) {
+      remap[index] = nextVertex++;
+    }
+  }
+  return remap;
+}
+
+/**
+ * @brief Simplifies a mesh by collapsing edges with the smallest quadric error.
+ *
+ * This implements the method of Garland and Heckbert in "Surface
+ * Simplification Using Quadric Error Metrics", with half-edge collapses so that
+ * the vertex array is not modified. The result references a subset of the
+ * vertices of the input mesh.
+ *
+ * Vertices that share their position with other vertices, such as those at UV
+ * seams or normal discontinuities, are never collapsed. Vertices on open
+ * borders collapse only along the border. Collapses that would flip the normal
+ * of a triangle are rejected.
+ *
+ * @param indices Index array of the mesh, with three indices per triangle.
+ * @param positions Vertex positions of the mesh.
+ * @param targetIndexCount Number of indices to achieve. The result may have
+ * more indices if no more edges can be collapsed.
+ * @param error If not null, receives an estimate of the largest distance, in
+ * the units of the positions, between the simplified mesh and the input mesh.
+ * Each collapse measures the distance from the removed vertex, and from the
+ * vertices previously collapsed into it, to the triangles and border edges
+ * that replace its neighborhood.
+ * @param lockedVertices If not empty, a nonzero value for each vertex that must
+ * not be collapsed, such as vertices shared with other parts of the mesh that
+ * are simplified separately.
+ *
+ * @return Index array of the simplified mesh.
+ */
+std::vector<std::uint32_t>
+abcg::simplifyMesh(std::span<std::uint32_t const> indices,
+                   std::span<glm::vec3 const> positions,
+                   std::size_t targetIndexCount, float *error,
+                   std::span<std::uint8_t const> lockedVertices) {
+  std::vector result(indices.begin(), indices.end());
+  auto const numVertices{positions.size()};
+  auto maxError{0.0};
+
+  // Identify vertices with the same position
+  std::vector<std::uint32_t> positionIDs(numVertices);
+  std::vector<std::uint32_t> positionCounts;
+  {
+    std::vector<glm::vec3> uniquePositions;
+    VertexWelder welder{uniquePositions, numVertices};
+    for (std::size_t vertex{}; vertex < numVertices; ++vertex) {
+      positionIDs[vertex] = welder.weld(positions[vertex]);
+    }
+    positionCounts.resize(uniquePositions.size());
+    for (auto const positionID : positionIDs) {
+      ++positionCounts[positionID];
+    }
+  }
+
+  // Classify the vertices and compute their quadrics. Border edges add a plane
+  // perpendicular to the triangle so that borders keep their shape
+  auto const borderEdges{findBorderEdges(result, positionIDs)};
+  auto const isBorderEdge{[&](std::uint32_t first, std::uint32_t second) {
+    return std::ranges::binary_search(
+        borderEdges, edgeKey(positionIDs[first], positionIDs[second]));
+  }};
+
+  std::vector kinds(numVertices, VertexKind::Interior);
+  std::vector<Quadric> quadrics(numVertices);
+  for (std::size_t first{}; first + 2 < result.size(); first += 3) {
+    std::array const triangle{result[first], result[first + 1],
+                              result[first + 2]};
+    glm::dvec3 const a{positions[triangle[0]]};
+    glm::dvec3 const b{positions[triangle[1]]};
+    glm::dvec3 const c{positions[triangle[2]]};
+    auto normal{glm::cross(b - a, c - a)};
+    auto const area{glm::length(normal)};
+    if (area > 0.0) {
+      normal /= area;
+    }
+    auto const quadric{
+        Quadric::fromPlane(normal, -glm::dot(normal, a), area * 0.5)};
+
+    for (std::size_t corner{}; corner < 3; ++corner) {
+      auto const vertex{triangle[corner]};
+      quadrics[vertex] += quadric;
+
+      auto const next{triangle[(corner + 1) % 3]};
+      if (!isBorderEdge(vertex, next))
+        continue;
+      kinds[vertex] = std::max(kinds[vertex], VertexKind::Border);
+      kinds[next] = std::max(kinds[next], VertexKind::Border);
+
+      constexpr auto borderWeight{10.0};
+      glm::dvec3 const start{positions[vertex]};
+      auto const edge{glm::dvec3{positions[next]} - start};
+      auto const edgeLength{glm::length(edge)};
+      auto borderNormal{glm::cross(edge, normal)};
+      if (auto const length{glm::length(borderNormal)}; length > 0.0) {
+        borderNormal /= length;
+        auto const borderQuadric{Quadric::fromPlane(
+            borderNormal, -glm::dot(borderNormal, start),
+            edgeLength * edgeLength * borderWeight)};
+        quadrics[vertex] += borderQuadric;
+        quadrics[next] += borderQuadric;
+      }
+    }
+  }
+  for (std::size_t vertex{}; vertex < numVertices; ++vertex) {
+    if (positionCounts[positionIDs[vertex]] > 1 ||
+        (vertex < lockedVertices.size() && lockedVertices[vertex] != 0)) {
+      kinds[vertex] = VertexKind::Locked;
+    }
+  }
+
+  // Returns the error of moving a vertex to the position of another vertex:
+  // the largest distance from the vertex, and from the vertices previously
+  // collapsed into it, to the triangles that replace its triangles, or the
+  // distance from the vertex to the border edge that replaces it if farther.
+  // Returns std::nullopt if the move flips the normal of one of the triangles
+  std::vector<std::size_t> adjacencyOffsets(numVertices + 1);
+  std::vector<std::uint32_t> adjacency;
+  std::vector<std::vector<std::uint32_t>> collapsedVertices(numVertices);
+  std::vector<std::array<glm::dvec3, 3>> newTriangles;
+  auto const collapseError{[&](std::uint32_t from,
+                               std::uint32_t to) -> std::optional<double> {
+    glm::dvec3 const oldPosition{positions[from]};
+    glm::dvec3 const newPosition{positions[to]};
+    auto borderDistance{0.0};
+    newTriangles.clear();
+    for (auto index{adjacencyOffsets[from]}; index < adjacencyOffsets[from + 1];
+         ++index) {
+      auto const triangle{std::span{result}.subspan(adjacency[index] * 3, 3)};
+      if (std::ranges::find(triangle, to) != triangle.end())
+        continue;
+      std::array<glm::dvec3, 3> corners{};
+      std::ranges::transform(triangle, corners.begin(), [&](auto vertex) {
+        return glm::dvec3{positions[vertex]};
+      });
+      auto const oldNormal{glm::cross(corners[1] - corners[0],
+                                      corners[2] - corners[0])};
+      for (std::size_t corner{}; corner < 3; ++corner) {
+        if (triangle[corner] == from) {
+          corners.at(corner) = newPosition;
+        } else if (isBorderEdge(from, triangle[corner])) {
+          // The border edge will connect this corner to the new position
+          borderDistance =
+              std::max(borderDistance, segmentDistance(oldPosition,
+                                                       corners.at(corner),
+                                                       newPosition));
+        }
+      }
+      auto const newNormal{glm::cross(corners[1] - corners[0],
+                                      corners[2] - corners[0])};
+      if (glm::dot(oldNormal, newNormal) <= 0.0)
+        return std::nullopt;
+      newTriangles.push_back(corners);
+    }
+
+    auto const distanceToNewTriangles{[&](glm::dvec3 const &point) {
+      // The new position is on the new surface, so this is an upper bound
+      auto distance{glm::distance(point, newPosition)};
+      for (auto const &corners : newTriangles) {
+        distance = std::min(distance, triangleDistance(point, corners));
+      }
+      return distance;
+    }};
+    auto distance{
+        std::max(distanceToNewTriangles(oldPosition), borderDistance)};
+    for (auto const vertex : collapsedVertices[from]) {
+      glm::dvec3 const position{positions[vertex]};
+      distance = std::max(distance, distanceToNewTriangles(position));
+    }
+    return distance;
+  }};
+
+  struct Collapse {
+    std::uint32_t from{};
+    std::uint32_t to{};
+    double cost{};
+  };
+  std::vector<Collapse> collapses;
+  std::vector<bool> isTouched(numVertices);
+  std::vector<std::uint32_t> remap(numVertices);
+
+  // Each pass performs the cheapest collapses that do not share vertices
+  while (result.size() > targetIndexCount) {
+    auto const numTriangles{result.size() / 3};
+
+    // Triangles adjacent to each vertex
+    std::ranges::fill(adjacencyOffsets, 0);
+    for (auto const vertex : result) {
+      ++adjacencyOffsets[vertex + 1];
+    }
+    for (std::size_t vertex{}; vertex < numVertices; ++vertex) {
+      adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+    }
+    adjacency.resize(result.size());
+    {
+      auto next{adjacencyOffsets};
+      for (std::size_t corner{}; corner < result.size(); ++corner) {
+        adjacency[next[result[corner]]++] =
+            static_cast<std::uint32_t>(corner / 3);
+      }
+    }
+
+    // Candidate collapses sorted by cost
+    collapses.clear();
+    for (std::size_t triangle{}; triangle < numTriangles; ++triangle) {
+      for (std::size_t corner{}; corner < 3; ++corner) {
+        auto const from{result[triangle * 3 + corner]};
+        auto const to{result[triangle * 3 + (corner + 1) % 3]};
+        for (auto const &[source, target] : {std::pair{from, to},
+                                              std::pair{to, from}}) {
+          auto const kind{kinds[source]};
+          if (kind == VertexKind::Locked ||
+              (kind == VertexKind::Border && !isBorderEdge(source, target)))
+            continue;
+          auto quadric{quadrics[source]};
+          quadric += quadrics[target];
+          collapses.push_back({.from = source,
+                               .to = target,
+                               .cost = quadric.evaluate(positions[target]) /
+                                       std::max(quadric.weight, 1e-30)});
+        }
+      }
+    }
+    std::ranges::sort(collapses, {}, &Collapse::cost);
+
+    // Perform the collapses until the target is reached
+    std::fill(isTouched.begin(), isTouched.end(), false);
+    std::iota(remap.begin(), remap.end(), std::uint32_t{});
+    auto const trianglesToRemove{(result.size() - targetIndexCount + 2) / 3};
+    std::size_t removedTriangles{};
+    std::size_t performedCollapses{};
+    for (auto const &collapse : collapses) {
+      if (removedTriangles >= trianglesToRemove)
+        break;
+      if (isTouched[collapse.from] || isTouched[collapse.to])
+        continue;
+      auto const distance{collapseError(collapse.from, collapse.to)};
+      if (!distance)
+        continue;
+
+      remap[collapse.from] = collapse.to;
+      quadrics[collapse.to] += quadrics[collapse.from];
+      auto &collapsed{collapsedVertices[collapse.to]};
+      collapsed.push_back(collapse.from);
+      collapsed.insert(collapsed.end(),
+                       collapsedVertices[collapse.from].begin(),
+                       collapsedVertices[collapse.from].end());
+      maxError = std::max(maxError, *distance);
+      ++performedCollapses;
+
+      // Lock the neighborhood so that the adjacency stays valid in this pass
+      for (auto index{adjacencyOffsets[collapse.from]};
+           index < adjacencyOffsets[collapse.from + 1]; ++index) {
+        auto const triangle{
+            std::span{result}.subspan(adjacency[index] * 3, 3)};
+        for (auto const vertex : triangle) {
+          isTouched[vertex] = true;
+        }
+        if (std::ranges::find(triangle, collapse.to) != triangle.end()) {
+          ++removedTriangles;
+        }
+      }
+    }
+    if (performedCollapses == 0)
+      break;
+
+    // Remove the triangles that became degenerate
+    std::size_t size{};
+    for (std::size_t first{}; first < result.size(); first += 3) {
+      auto const a{remap[result[first]]};
+      auto const b{remap[result[first + 1]]};
+      auto const c{remap[result[first + 2]]};
+      if (a != b && b != c && c != a) {
+        result[size++] = a;
+        result[size++] = b;
+        result[size++] = c;
+      }
+    }
+    result.resize(size);
+  }
+
+  if (error != nullptr) {
+    *error = static_cast<float>(maxError);
+  }
+  return result;
+}
+
+/**
+ * @brief Splits a mesh into clusters of consecutive triangles.
+ *
+ * Triangles are scanned in order, and a new cluster is started whenever the
+ * current one would exceed the maximum number of vertices or triangles. The
+ * index array is not modified, so each cluster is a range of it that can be
+ * drawn directly. Clusters are spatially coherent if the triangles were
+ * previously reordered with abcg::optimizeVertexCache.
+ *
+ * @param indices Index array of the mesh, with three indices per triangle.
+ * @param positions Vertex positions of the mesh.
+ * @param maxVertices Maximum number of unique vertices of each cluster.
+ * @param maxTriangles Maximum number of triangles of each cluster.
+ *
+ * @return Clusters of the mesh, in the order of the index array.
+ */
+std::vector<abcg::Meshlet>
+abcg::buildMeshlets(std::span<std::uint32_t const> indices,
+                    std::span<glm::vec3 const> positions,
+                    std::size_t maxVertices, std::size_t maxTriangles) {
+  maxVertices = std::max(maxVertices, std::size_t{3});
+  maxTriangles = std::max(maxTriangles, std::size_t{1});
+
+  std::vector<Meshlet> meshlets;
+
+  // Cluster that last referenced each vertex, for counting unique vertices
+  std::vector lastMeshlet(positions.size(),
+                          std::numeric_limits<std::size_t>::max());
+  std::vector<std::uint32_t> meshletVertices;
+  meshletVertices.reserve(maxVertices);
+  std::vector<glm::vec3> normals;
+  normals.reserve(maxTriangles);
+
+  auto const finishMeshlet{[&](std::size_t lastIndex) {
+    auto &meshlet{meshlets.back()};
+    meshlet.numIndices = lastIndex - meshlet.firstIndex;
+
+    // Bounding sphere centered at the center of the bounding box
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+    glm::vec3 min(std::numeric_limits<float>::max());
+    for (auto const vertex : meshletVertices) {
+      max = glm::max(max, positions[vertex]);
+      min = glm::min(min, positions[vertex]);
+    }
+    meshlet.center = (min + max) / 2.0f;
+    for (auto const vertex : meshletVertices) {
+      meshlet.radius = std::max(
+          meshlet.radius, glm::distance(meshlet.center, positions[vertex]));
+    }
+
+    // Normal cone of the non-degenerate triangles
+    auto const triangles{
+        indices.subspan(meshlet.firstIndex, meshlet.numIndices)};
+    glm::vec3 axis{};
+    for (std::size_t offset{}; offset < triangles.size(); offset += 3) {
+      auto const &a{positions[triangles[offset + 0]]};
+      auto const &b{positions[triangles[offset + 1]]};
+      auto const &c{positions[triangles[offset + 2]]};
+      auto const normal{glm::cross(b - a, c - a)};
+      if (auto const length{glm::length(normal)}; length > 0.0f) {
+        normals.push_back(normal / length);
+        axis += normals.back();
+      }
+    }
+    if (auto const length{glm::length(axis)}; length > 0.0f) {
+      axis /= length;
+      auto minDot{1.0f};
+      for (auto const &normal : normals) {
+        minDot = std::min(minDot, glm::dot(normal, axis));
+      }
+      if (minDot > 0.0f) {
+        meshlet.coneAxis = axis;
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+      }
+    }
+
+    meshletVertices.clear();
+    normals.clear();
+  }};
+
+  for (std::size_t offset{}; offset + 2 < indices.size(); offset += 3) {
+    auto const triangle{indices.subspan(offset, 3)};
+    auto newVertices{std::ranges::count_if(triangle, [&](auto index) {
+      return lastMeshlet[index] != meshlets.size() - 1;
+    })};
+    if (meshlets.empty() ||
+        meshletVertices.size() + gsl::narrow<std::size_t>(newVertices) >
+            maxVertices ||
+        offset - meshlets.back().firstIndex >= maxTriangles * 3) {
+      if (!meshlets.empty()) {
+        finishMeshlet(offset);
+      }
+      meshlets.push_back({.firstIndex = offset});
+    }
+    for (auto const index : triangle) {
+      if (lastMeshlet[index] != meshlets.size() - 1) {
+        lastMeshlet[index] = meshlets.size() - 1;
+        meshletVertices.push_back(index);
+      }
+    }
+  }
+  if (!meshlets.empty()) {
+    finishMeshlet(indices.size() - indices.size() % 3);
+  }
+
+  return meshlets;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file abcgMeshOptimizer.hpp
+ * @brief Declaration of functions for optimizing indexed triangle meshes.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESH_OPTIMIZER_HPP_
+#define ABCG_MESH_OPTIMIZER_HPP_
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "abcgExternal.hpp"
+
+namespace abcg {
+struct Meshlet;
+
+[[nodiscard]] float computeACMR(std::span<std::uint32_t const> indices,
+                                std::size_t numVertices,
+                                std::size_t cacheSize = 16);
+void optimizeVertexCache(std::span<std::uint32_t> indices,
+                         std::size_t numVertices);
+void optimizeOverdraw(std::span<std::uint32_t> indices,
+                      std::span<glm::vec3 const> positions,
+                      float threshold = 1.05f);
+[[nodiscard]] std::vector<std::uint32_t>
+computeVertexFetchRemap(std::span<std::uint32_t const> indices,
+                        std::size_t numVertices);
+[[nodiscard]] std::vector<std::uint32_t>
+simplifyMesh(std::span<std::uint32_t const> indices,
+             std::span<glm::vec3 const> positions,
+             std::size_t targetIndexCount, float *error = nullptr,
+             std::span<std::uint8_t const> lockedVertices = {});
+[[nodiscard]] std::vector<Meshlet>
+buildMeshlets(std::span<std::uint32_t const> indices,
+              std::span<glm::vec3 const> positions,
+              std::size_t maxVertices = 64, std::size_t maxTriangles = 124);
+
+template <typename TVertex>
+void optimizeVertexFetch(std::span<std::uint32_t> indices,
+                         std::vector<TVertex> &vertices);
+} // namespace abcg
+
+/**
+ * @brief Cluster of consecutive triangles of an index array, with bounds for
+ * culling.
+ *
+ * The cluster can be culled against the view frustum with its bounding sphere.
+ * It can be culled as back-facing from a camera at position `p` if
+ * `dot(center - p, coneAxis) >= coneCutoff * length(center - p) + radius`.
+ */
+struct abcg::Meshlet {
+  /** @brief Index of the first index of the cluster. */
+  std::size_t firstIndex{};
+  /** @brief Number of indices of the cluster. */
+  std::size_t numIndices{};
+  /** @brief Center of the bounding sphere. */
+  glm::vec3 center{};
+  /** @brief Radius of the bounding sphere. */
+  float radius{};
+  /** @brief Average direction of the triangle normals. */
+  glm::vec3 coneAxis{};
+  /**
+   * @brief Sine of the largest angle between a triangle normal and the axis.
+   * Larger than 1 if the triangles face more than a hemisphere of directions.
+   */
+  float coneCutoff{2.0f};
+};
+
+/**
+ * @brief Reorders the vertices of a mesh in the order they are first
+ * referenced by the index array.
+ *
+ * The index array is updated accordingly. Vertices not referenced by any index
+ * are removed.
+ *
+ * This is usually the last step of the optimization of a mesh, after
+ * abcg::optimizeVertexCache and abcg::optimizeOverdraw.
+ *
+ * @tparam TVertex Typename of the vertex.
+ *
+ * @param indices Index array of the mesh.
+ * @param vertices Vertex array of the mesh.
+ */
+template <typename TVertex>
+void abcg::optimizeVertexFetch(std::span<std::uint32_t> indices,
+                               std::vector<TVertex> &vertices) {
+  auto const remap{computeVertexFetchRemap(indices, vertices.size())};
+
+  std::vector<TVertex> reorderedVertices(vertices.size());
+  std::size_t numVertices{};
+  for (std::size_t index{}; index < vertices.size(); ++index) {
+    if (remap[index] != std::numeric_limits<std::uint32_t>::max()) {
+      reorderedVertices[remap[index]] = vertices[index];
+      ++numVertices;
+    }
+  }
+  reorderedVertices.resize(numVertices);
+  vertices = std::move(reorderedVertices);
+
+  for (auto &index : indices) {
+    index = remap[index];
+  }
+}
+
+#endif
@@ -0,0 +1,542 @@
+/**
+ * @file abcgObjReader.cpp
+ * @brief Definition of a parallel Wavefront OBJ reader.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgObjReader.hpp"
+
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <map>
+
+#include "abcgException.hpp"
+#include "abcgMappedFile.hpp"
+#include "abcgThreadPool.hpp"
+
+namespace {
+
+constexpr std::int32_t absentIndex{std::numeric_limits<std::int32_t>::min()};
+
+// Index of a vertex attribute as written in the file. Negative indices are
+// relative to the attributes defined so far, so they are stored relative to
+// the start of the chunk and resolved when the chunks are merged.
+struct IndexRef {
+  std::int32_t index{absentIndex};
+  bool isRelative{};
+};
+
+struct FaceVertex {
+  IndexRef position;
+  IndexRef texCoord;
+  IndexRef normal;
+};
+
+// Group, object or material that starts at a given triangle
+struct Event {
+  bool isMaterial{};
+  std::size_t firstTriangle{};
+  std::string name;
+};
+
+// Data of a range of lines of the file
+struct Chunk {
+  std::vector<tinyobj::real_t> positions;
+  std::vector<tinyobj::real_t> normals;
+  std::vector<tinyobj::real_t> texCoords;
+  std::vector<FaceVertex> triangleVertices;
+  std::vector<Event> events;
+  std::vector<std::string> materialLibraries;
+  std::string error;
+};
+
+void skipSpaces(std::string_view &text) {
+  auto const start{text.find_first_not_of(" \t")};
+  text.remove_prefix(start == std::string_view::npos ? text.size() : start);
+}
+
+std::string_view nextToken(std::string_view &text) {
+  skipSpaces(text);
+  auto const end{std::min(text.find_first_of(" \t"), text.size())};
+  auto const token{text.substr(0, end)};
+  text.remove_prefix(end);
+  return token;
+}
+
+std::string_view trim(std::string_view text) {
+  skipSpaces(text);
+  auto const end{text.find_last_not_of(" \t")};
+  return text.substr(0, end == std::string_view::npos ? 0 : end + 1);
+}
+
+bool isDigit(char character) { return character >= '0' && character <= '9'; }
+
+// Parses a decimal floating-point number that spans the whole token
+bool parseReal(std::string_view token, tinyobj::real_t &value) {
+  static constexpr std::array<double, 23> powersOf10{
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  auto iter{token.begin()};
+  auto const end{token.end()};
+  auto const isNegative{iter != end && *iter == '-'};
+  if (iter != end && (*iter == '-' || *iter == '+'))
+    ++iter;
+
+  // Keep up to 19 significant digits in a 64-bit mantissa
+  std::uint64_t mantissa{};
+  int significantDigits{};
+  int exponent{};
+  auto hasDigits{false};
+  for (; iter != end && isDigit(*iter); ++iter) {
+    hasDigits = true;
+    if (significantDigits < 19) {
+      mantissa = mantissa * 10 + static_cast<std::uint64_t>(*iter - '0');
+      significantDigits += mantissa != 0 ? 1 : 0;
+    } else {
+      ++exponent;
+    }
+  }
+  if (iter != end && *iter == '.') {
+    for (++iter; iter != end && isDigit(*iter); ++iter) {
+      hasDigits = true;
+      if (significantDigits < 19) {
+        mantissa = mantissa * 10 + static_cast<std::uint64_t>(*iter - '0');
+        significantDigits += mantissa != 0 ? 1 : 0;
+        --exponent;
+      }
+    }
+  }
+  if (!hasDigits)
+    return false;
+
+  if (iter != end && (*iter == 'e' || *iter == 'E')) {
+    ++iter;
+    auto const isExponentNegative{iter != end && *iter == '-'};
+    if (iter != end && (*iter == '-' || *iter == '+'))
+      ++iter;
+    if (iter == end || !isDigit(*iter))
+      return false;
+    int explicitExponent{};
+    for (; iter != end && isDigit(*iter); ++iter) {
+      explicitExponent = std::min(explicitExponent * 10 + (*iter - '0'), 9999);
+    }
+    exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+  }
+  if (iter != end)
+    return false;
+
+  auto result{static_cast<double>(mantissa)};
+  auto const scale{std::abs(exponent) < 23
+                       ? powersOf10.at(gsl::narrow<std::size_t>(
+                             std::abs(exponent)))
+                       : std::pow(10.0, std::abs(exponent))};
+  result = exponent < 0 ? result / scale : result * scale;
+  value = static_cast<tinyobj::real_t>(isNegative ? -result : result);
+  return true;
+}
+
+bool parseInt(std::string_view token, std::int32_t &value) {
+  auto iter{token.begin()};
+  auto const end{token.end()};
+  auto const isNegative{iter != end && *iter == '-'};
+  if (iter != end && (*iter == '-' || *iter == '+'))
+    ++iter;
+  if (iter == end)
+    return false;
+
+  std::int64_t result{};
+  for (; iter != end; ++iter) {
+    if (!isDigit(*iter))
+      return false;
+    result = std::min<std::int64_t>(result * 10 + (*iter - '0'),
+                                    std::numeric_limits<std::int32_t>::max());
+  }
+  value = gsl::narrow_cast<std::int32_t>(isNegative ? -result : result);
+  return true;
+}
+
+// Parses a 1-based or negative index. count is the number of attributes
+// defined so far in the chunk.
+bool parseIndex(std::string_view token, std::size_t count, IndexRef &ref) {
+  std::int32_t index{};
+  if (!parseInt(token, index) || index == 0)
+    return false;
+  if (index > 0) {
+    ref = {.index = index - 1, .isRelative = false};
+  } else {
+    ref = {.index = gsl::narrow<std::int32_t>(count) + index,
+           .isRelative = true};
+  }
+  return true;
+}
+
+// Parses a face vertex in the format v, v/vt, v//vn or v/vt/vn
+bool parseFaceVertex(std::string_view token, Chunk const &chunk,
+                     FaceVertex &vertex) {
+  std::array<std::string_view, 3> parts{};
+  for (auto &part : parts) {
+    auto const slash{std::min(token.find('/'), token.size())};
+    part = token.substr(0, slash);
+    token.remove_prefix(std::min(slash + 1, token.size()));
+  }
+
+  vertex = {};
+  return parseIndex(parts[0], chunk.positions.size() / 3, vertex.position) &&
+         (parts[1].empty() ||
+          parseIndex(parts[1], chunk.texCoords.size() / 2, vertex.texCoord)) &&
+         (parts[2].empty() ||
+          parseIndex(parts[2], chunk.normals.size() / 3, vertex.normal));
+}
+
+bool parseReals(std::string_view &text, std::size_t count,
+                std::size_t required, std::vector<tinyobj::real_t> &values) {
+  for (std::size_t index{}; index < count; ++index) {
+    auto const token{nextToken(text)};
+    if (token.empty() && index >= required) {
+      values.push_back(0);
+      continue;
+    }
+    tinyobj::real_t value{};
+    if (!parseReal(token, value))
+      return false;
+    values.push_back(value);
+  }
+  return true;
+}
+
+// Parses a range of complete lines. Faces are triangulated as fans.
+Chunk parseChunk(std::string_view text) {
+  Chunk chunk;
+  std::vector<FaceVertex> polygon;
+
+  while (!text.empty()) {
+    auto const newline{std::min(text.find('\n'), text.size())};
+    auto line{text.substr(0, newline)};
+    text.remove_prefix(std::min(newline + 1, text.size()));
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+
+    auto rest{line};
+    auto const keyword{nextToken(rest)};
+    auto isValid{true};
+    if (keyword == "v") {
+      isValid = parseReals(rest, 3, 3, chunk.positions);
+    } else if (keyword == "vn") {
+      isValid = parseReals(rest, 3, 3, chunk.normals);
+    } else if (keyword == "vt") {
+      isValid = parseReals(rest, 2, 1, chunk.texCoords);
+    } else if (keyword == "f") {
+      polygon.clear();
+      for (auto token{nextToken(rest)}; isValid && !token.empty();
+           token = nextToken(rest)) {
+        isValid = parseFaceVertex(token, chunk, polygon.emplace_back());
+      }
+      isValid = isValid && polygon.size() >= 3;
+      for (std::size_t index{1}; isValid && index + 1 < polygon.size();
+           ++index) {
+        chunk.triangleVertices.push_back(polygon.front());
+        chunk.triangleVertices.push_back(polygon.at(index));
+        chunk.triangleVertices.push_back(polygon.at(index + 1));
+      }
+    } else if (keyword == "o" || keyword == "g") {
+      chunk.events.push_back({.isMaterial = false,
+                              .firstTriangle =
+                                  chunk.triangleVertices.size() / 3,
+                              .name = std::string{trim(rest)}});
+    } else if (keyword == "usemtl") {
+      chunk.events.push_back({.isMaterial = true,
+                              .firstTriangle =
+                                  chunk.triangleVertices.size() / 3,
+                              .name = std::string{trim(rest)}});
+    } else if (keyword == "mtllib") {
+      for (auto token{nextToken(rest)}; !token.empty();
+           token = nextToken(rest)) {
+        chunk.materialLibraries.emplace_back(token);
+      }
+    }
+
+    if (!isValid) {
+      chunk.error = fmt::format("invalid line '{}'", line);
+      break;
+    }
+  }
+
+  return chunk;
+}
+
+// Splits the text into about numChunks ranges of complete lines
+std::vector<std::string_view> splitLines(std::string_view text,
+                                         std::size_t numChunks) {
+  std::vector<std::string_view> chunks;
+  auto const chunkSize{text.size() / numChunks + 1};
+  while (!text.empty()) {
+    auto end{std::min(chunkSize, text.size())};
+    end = std::min(text.find('\n', end - 1), text.size() - 1) + 1;
+    chunks.push_back(text.substr(0, end));
+    text.remove_prefix(end);
+  }
+  return chunks;
+}
+
+// Contiguous range of triangles with the same group or material
+struct TriangleRange {
+  std::size_t first{};
+  std::size_t shapeOrMaterial{};
+};
+
+// Returns the range that contains a triangle
+std::size_t findRange(std::vector<TriangleRange> const &ranges,
+                      std::size_t triangle) {
+  auto const iter{std::ranges::upper_bound(ranges, triangle, {},
+                                           &TriangleRange::first)};
+  return gsl::narrow<std::size_t>(std::distance(ranges.begin(), iter)) - 1;
+}
+
+bool resolveIndex(IndexRef ref, std::size_t chunkOffset, std::size_t count,
+                  int &index) {
+  if (ref.index == absentIndex) {
+    index = -1;
+    return true;
+  }
+  auto const global{ref.isRelative
+                        ? static_cast<std::int64_t>(chunkOffset) + ref.index
+                        : std::int64_t{ref.index}};
+  if (global < 0 || global >= static_cast<std::int64_t>(count))
+    return false;
+  index = gsl::narrow<int>(global);
+  return true;
+}
+
+} // namespace
+
+/**
+ * @brief Reads a Wavefront OBJ file using multiple threads.
+ *
+ * This is a faster alternative to `tinyobj::ObjReader::ParseFromFile` for
+ * large files. The file is memory-mapped and split into ranges of lines that
+ * are parsed concurrently. The attribute arrays of the ranges are then merged,
+ * and the indices are resolved in parallel.
+ *
+ * Only the statements that describe polygonal geometry are read (`v`, `vn`,
+ * `vt`, `f`, `o`, `g`, `usemtl` and `mtllib`). Material libraries are read
+ * with `tinyobj::LoadMtl` from the directory of the OBJ file.
+ *
+ * @param path Path to the OBJ file.
+ * @param threadPool Pool of worker threads. If null,
+ * abcg::ThreadPool::getDefault is used.
+ *
+ * @throw abcg::RuntimeError if the file could not be read or contains invalid
+ * statements or indices.
+ *
+ * @return Contents of the file.
+ */
+abcg::ObjContents abcg::readObj(std::string_view path,
+                                ThreadPool *threadPool) {
+  MappedFile file;
+  if (!file.open(std::filesystem::path{path})) {
+    throw abcg::RuntimeError(fmt::format("Failed to load model {}", path));
+  }
+  auto const data{file.getData()};
+  std::string_view const text{reinterpret_cast<char const *>(data.data()),
+                              data.size()};
+
+  auto &pool{threadPool == nullptr ? ThreadPool::getDefault() : *threadPool};
+
+  // Parse ranges of at least 1 MiB, with a few ranges per thread for balance
+  constexpr std::size_t minChunkSize{std::size_t{1} << 20};
+  auto const numChunks{std::clamp(text.size() / minChunkSize, std::size_t{1},
+                                  (pool.getThreadCount() + 1) * 4)};
+  std::vector<std::future<Chunk>> parsedChunks;
+  for (auto const lines : splitLines(text, numChunks)) {
+    parsedChunks.push_back(pool.submit([lines] { return parseChunk(lines); }));
+  }
+
+  // The tasks read the mapped file, so wait for all of them before throwing
+  for (auto const &parsedChunk : parsedChunks) {
+    parsedChunk.wait();
+  }
+  std::vector<Chunk> chunks;
+  chunks.reserve(parsedChunks.size());
+  for (auto &parsedChunk : parsedChunks) {
+    chunks.push_back(parsedChunk.get());
+    if (!chunks.back().error.empty()) {
+      throw abcg::RuntimeError(fmt::format("Failed to load model {} ({})",
+                                           path, chunks.back().error));
+    }
+  }
+
+  // Offsets of the attributes and triangles of each chunk
+  struct Offsets {
+    std::size_t position{};
+    std::size_t normal{};
+    std::size_t texCoord{};
+    std::size_t triangle{};
+  };
+  std::vector<Offsets> offsets(chunks.size() + 1);
+  for (auto const index : iter::range(chunks.size())) {
+    auto const &chunk{chunks.at(index)};
+    auto const &offset{offsets.at(index)};
+    offsets.at(index + 1) = {
+        .position = offset.position + chunk.positions.size() / 3,
+        .normal = offset.normal + chunk.normals.size() / 3,
+        .texCoord = offset.texCoord + chunk.texCoords.size() / 2,
+        .triangle = offset.triangle + chunk.triangleVertices.size() / 3};
+  }
+  auto const &totals{offsets.back()};
+
+  ObjContents contents;
+
+  // Read the material libraries
+  auto const basePath{std::filesystem::path{path}.parent_path()};
+  std::map<std::string, int> materialMap;
+  std::vector<std::string> materialLibraries;
+  for (auto const &chunk : chunks) {
+    for (auto const &library : chunk.materialLibraries) {
+      if (std::ranges::find(materialLibraries, library) !=
+          materialLibraries.end())
+        continue;
+      materialLibraries.push_back(library);
+      if (std::ifstream stream(basePath / library); stream) {
+        std::string error;
+        tinyobj::LoadMtl(&materialMap, &contents.materials, &stream,
+                         &contents.warning, &error);
+      } else {
+        contents.warning +=
+            fmt::format("Material file {} not found\n", library);
+      }
+    }
+  }
+
+  // Ranges of triangles of each shape and material
+  std::vector<TriangleRange> shapeRanges{{.first = 0, .shapeOrMaterial = 0}};
+  std::vector<TriangleRange> materialRanges{
+      {.first = 0, .shapeOrMaterial = std::numeric_limits<std::size_t>::max()}};
+  contents.shapes.emplace_back();
+  for (auto const index : iter::range(chunks.size())) {
+    for (auto const &event : chunks.at(index).events) {
+      auto const first{offsets.at(index).triangle + event.firstTriangle};
+      if (event.isMaterial) {
+        auto materialID{std::numeric_limits<std::size_t>::max()};
+        if (auto const iter{materialMap.find(event.name)};
+            iter != materialMap.end()) {
+          materialID = gsl::narrow<std::size_t>(iter->second);
+        } else {
+          contents.warning +=
+              fmt::format("Material {} not found\n", event.name);
+        }
+        materialRanges.push_back(
+            {.first = first, .shapeOrMaterial = materialID});
+        continue;
+      }
+      // Start a new shape, unless the current one is still empty
+      if (shapeRanges.back().first != first) {
+        shapeRanges.push_back(
+            {.first = first, .shapeOrMaterial = contents.shapes.size()});
+        contents.shapes.emplace_back();
+      }
+      contents.shapes.back().name = event.name;
+    }
+  }
+  shapeRanges.push_back({.first = totals.triangle, .shapeOrMaterial = 0});
+
+  // Allocate the merged arrays
+  auto &attrib{contents.attrib};
+  attrib.vertices.resize(totals.position * 3);
+  attrib.normals.resize(totals.normal * 3);
+  attrib.texcoords.resize(totals.texCoord * 2);
+  for (auto const index : iter::range(contents.shapes.size())) {
+    auto const numTriangles{shapeRanges.at(index + 1).first -
+                            shapeRanges.at(index).first};
+    auto &mesh{contents.shapes.at(index).mesh};
+    mesh.indices.resize(numTriangles * 3);
+    mesh.num_face_vertices.assign(numTriangles, 3);
+    mesh.material_ids.resize(numTriangles);
+    mesh.smoothing_group_ids.assign(numTriangles, 0);
+  }
+  shapeRanges.pop_back();
+
+  // Copy the attributes and resolve the indices of each chunk concurrently
+  std::vector<std::future<bool>> mergedChunks;
+  for (auto const index : iter::range(chunks.size())) {
+    mergedChunks.push_back(pool.submit([&, index] {
+      auto const &chunk{chunks.at(index)};
+      auto const &offset{offsets.at(index)};
+      std::ranges::copy(chunk.positions,
+                        attrib.vertices.begin() +
+                            gsl::narrow<std::ptrdiff_t>(offset.position * 3));
+      std::ranges::copy(chunk.normals,
+                        attrib.normals.begin() +
+                            gsl::narrow<std::ptrdiff_t>(offset.normal * 3));
+      std::ranges::copy(chunk.texCoords,
+                        attrib.texcoords.begin() +
+                            gsl::narrow<std::ptrdiff_t>(offset.texCoord * 2));
+
+      auto const numTriangles{chunk.triangleVertices.size() / 3};
+      if (numTriangles == 0)
+        return true;
+      auto shapeIndex{findRange(shapeRanges, offset.triangle)};
+      auto materialIndex{findRange(materialRanges, offset.triangle)};
+      for (std::size_t triangle{}; triangle < numTriangles; ++triangle) {
+        auto const globalTriangle{offset.triangle + triangle};
+        while (shapeIndex + 1 < shapeRanges.size() &&
+               shapeRanges.at(shapeIndex + 1).first <= globalTriangle) {
+          ++shapeIndex;
+        }
+        while (materialIndex + 1 < materialRanges.size() &&
+               materialRanges.at(materialIndex + 1).first <= globalTriangle) {
+          ++materialIndex;
+        }
+
+        auto const &shapeRange{shapeRanges.at(shapeIndex)};
+        auto &mesh{contents.shapes.at(shapeRange.shapeOrMaterial).mesh};
+        auto const face{globalTriangle - shapeRange.first};
+        auto const materialID{materialRanges.at(materialIndex).shapeOrMaterial};
+        mesh.material_ids.at(face) =
+            materialID == std::numeric_limits<std::size_t>::max()
+                ? -1
+                : gsl::narrow<int>(materialID);
+
+        for (auto const corner : iter::range(std::size_t{3})) {
+          auto const &vertex{chunk.triangleVertices.at(triangle * 3 + corner)};
+          auto &objIndex{mesh.indices.at(face * 3 + corner)};
+          if (!resolveIndex(vertex.position, offset.position, totals.position,
+                            objIndex.vertex_index) ||
+              !resolveIndex(vertex.normal, offset.normal, totals.normal,
+                            objIndex.normal_index) ||
+              !resolveIndex(vertex.texCoord, offset.texCoord,
+                            totals.texCoord, objIndex.texcoord_index))
+            return false;
+        }
+      }
+      return true;
+    }));
+  }
+
+  // The tasks reference local variables, so wait for all of them
+  for (auto const &mergedChunk : mergedChunks) {
+    mergedChunk.wait();
+  }
+  for (auto &mergedChunk : mergedChunks) {
+    if (!mergedChunk.get()) {
+      throw abcg::RuntimeError(
+          fmt::format("Failed to load model {} (index out of range)", path));
+    }
+  }
+
+  return contents;
+}
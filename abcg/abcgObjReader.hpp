@@ -0,0 +1,47 @@
+/**
+ * @file abcgObjReader.hpp
+ * @brief Declaration of a parallel Wavefront OBJ reader.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OBJ_READER_HPP_
+#define ABCG_OBJ_READER_HPP_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abcgExternal.hpp"
+
+namespace abcg {
+class ThreadPool;
+struct ObjContents;
+
+[[nodiscard]] ObjContents readObj(std::string_view path,
+                                  ThreadPool *threadPool = nullptr);
+} // namespace abcg
+
+/**
+ * @brief Contents of a Wavefront OBJ file read with abcg::readObj.
+ *
+ * The data is stored in the same structures used by `tinyobj::ObjReader`.
+ * Faces are triangulated, so each face of `tinyobj::mesh_t` has three
+ * vertices.
+ */
+struct abcg::ObjContents {
+  /** @brief Vertex positions, normals and texture coordinates. Vertex colors
+   * and weights are not read. */
+  tinyobj::attrib_t attrib;
+  /** @brief Groups and objects of the file, in the order they appear. */
+  std::vector<tinyobj::shape_t> shapes;
+  /** @brief Materials read from the material libraries of the file. */
+  std::vector<tinyobj::material_t> materials;
+  /** @brief Warning messages, such as missing material libraries. */
+  std::string warning;
+};
+
+#endif
@@ -15,7 +15,12 @@
 
 #include "abcg.hpp"
 #include "abcgOpenGLImage.hpp"
+#include "abcgOpenGLIndexBuffer.hpp"
+#include "abcgOpenGLProgram.hpp"
 #include "abcgOpenGLShader.hpp"
+#include "abcgOpenGLStreamBuffer.hpp"
+#include "abcgOpenGLTextureStreamer.hpp"
+#include "abcgOpenGLUniformBuffer.hpp"
 #include "abcgOpenGLWindow.hpp"
 
 #endif
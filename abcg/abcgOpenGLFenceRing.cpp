@@ -0,0 +1,98 @@
+/**
+ * @file abcgOpenGLFenceRing.cpp
+ * @brief Definition of abcg::OpenGLFenceRing members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLFenceRing.hpp"
+
+#include <algorithm>
+
+#include "abcgOpenGLFunction.hpp"
+
+// Functions taking GLsync are qualified, as GLsync arguments also bring the
+// global declarations into overload resolution
+
+/**
+ * @brief Creates the ring with no pending fences.
+ *
+ * @param size Number of slots of the ring. At least one slot is created.
+ */
+void abcg::OpenGLFenceRing::create(std::size_t size) {
+  destroy();
+  m_fences.assign(std::max(size, std::size_t{1}), nullptr);
+}
+
+/**
+ * @brief Releases the fence sync objects.
+ */
+void abcg::OpenGLFenceRing::destroy() {
+  for (auto &fence : m_fences) {
+    if (fence != nullptr) {
+      abcg::glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+  m_fences.clear();
+  m_currentSlot = 0;
+}
+
+/**
+ * @brief Protects the current slot with a fence and moves to the next slot.
+ *
+ * The fence is signaled when the GPU has executed all commands issued so far,
+ * so this must be called after the commands that read the slot.
+ */
+void abcg::OpenGLFenceRing::advance() {
+  auto &fence{m_fences.at(m_currentSlot)};
+  if (fence != nullptr) {
+    abcg::glDeleteSync(fence);
+  }
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  m_currentSlot = (m_currentSlot + 1) % m_fences.size();
+}
+
+/**
+ * @brief Waits until the GPU has finished reading the current slot.
+ *
+ * This returns immediately if the slot was never protected, or if the GPU is
+ * already done with it. Otherwise, it blocks until the fence is signaled or
+ * the wait fails (e.g., after a context loss).
+ */
+void abcg::OpenGLFenceRing::waitForCurrent() {
+  auto &fence{m_fences.at(m_currentSlot)};
+  if (fence == nullptr)
+    return;
+
+  // Only the first wait needs to flush the commands that signal the fence
+  GLbitfield flags{GL_SYNC_FLUSH_COMMANDS_BIT};
+  auto const timeout{GLuint64{1'000'000'000}}; // 1 second
+  while (abcg::glClientWaitSync(fence, flags, timeout) == GL_TIMEOUT_EXPIRED) {
+    flags = 0;
+  }
+  abcg::glDeleteSync(fence);
+  fence = nullptr;
+}
+
+/**
+ * @brief Returns the index of the current slot.
+ *
+ * @return Index of the slot to be written next, from 0 to
+ * abcg::OpenGLFenceRing::size - 1.
+ */
+std::size_t abcg::OpenGLFenceRing::getCurrentSlot() const noexcept {
+  return m_currentSlot;
+}
+
+/**
+ * @brief Returns the number of slots of the ring.
+ *
+ * @return Number of slots, or 0 if the ring was not created.
+ */
+std::size_t abcg::OpenGLFenceRing::size() const noexcept {
+  return m_fences.size();
+}
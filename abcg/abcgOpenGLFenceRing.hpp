@@ -0,0 +1,58 @@
+/**
+ * @file abcgOpenGLFenceRing.hpp
+ * @brief Header file of abcg::OpenGLFenceRing.
+ *
+ * Declaration of abcg::OpenGLFenceRing.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_FENCE_RING_HPP_
+#define ABCG_OPENGL_FENCE_RING_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "abcgOpenGLExternal.hpp"
+
+namespace abcg {
+class OpenGLFenceRing;
+} // namespace abcg
+
+/**
+ * @brief A class for tracking which slots of a ring buffer may still be read
+ * by the GPU.
+ *
+ * Each slot is associated with a fence sync object that is inserted in the
+ * command stream when the CPU moves to the next slot. Before a slot is written
+ * again, abcg::OpenGLFenceRing::waitForCurrent blocks until the GPU has
+ * executed the commands issued while the slot was current:
+ * @code
+ * fenceRing.waitForCurrent();
+ * ... // Write to slot fenceRing.getCurrentSlot() and issue commands using it
+ * fenceRing.advance();
+ * @endcode
+ *
+ * This is used by abcg::OpenGLUniformBuffer, abcg::OpenGLStreamBuffer and
+ * abcg::OpenGLTextureStreamer.
+ */
+class abcg::OpenGLFenceRing {
+public:
+  void create(std::size_t size);
+  void destroy();
+
+  void advance();
+  void waitForCurrent();
+
+  [[nodiscard]] std::size_t getCurrentSlot() const noexcept;
+  [[nodiscard]] std::size_t size() const noexcept;
+
+private:
+  std::vector<GLsync> m_fences;
+  std::size_t m_currentSlot{};
+};
+
+#endif
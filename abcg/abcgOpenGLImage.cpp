@@ -15,7 +15,65 @@
 #include <fmt/core.h>
 #include <gsl/gsl>
 
+#include <future>
+#include <string>
+#include <vector>
+
 #include "abcgException.hpp"
+#include "abcgThreadPool.hpp"
+
+namespace {
+// Buffer of converted pixels, reused by every texture loaded by the thread
+std::vector<std::byte> &getStagingBuffer() {
+  thread_local std::vector<std::byte> stagingBuffer;
+  return stagingBuffer;
+}
+
+struct CubemapFace {
+  GLenum target{};
+  GLsizei width{};
+  GLsizei height{};
+  std::vector<std::byte> pixels;
+};
+
+// Loads an image file of a cubemap face and converts it to RGB. This is
+// called from a worker thread and must not call OpenGL functions.
+CubemapFace decodeCubemapFace(std::string const &path, GLenum target,
+                              bool rightHandedSystem) {
+  SDL_Surface *const surface{IMG_Load(path.c_str())};
+  if (surface == nullptr) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to load texture file {}", path));
+  }
+  auto const freeSurface{
+      gsl::finally([surface] { SDL_FreeSurface(surface); })};
+
+  CubemapFace face{.target = target,
+                   .width = surface->w,
+                   .height = surface->h,
+                   .pixels = {}};
+  auto const isYFace{target == GL_TEXTURE_CUBE_MAP_POSITIVE_Y ||
+                     target == GL_TEXTURE_CUBE_MAP_NEGATIVE_Y};
+
+  // From LHS to RHS, flip the Y faces upside down and the other faces
+  // horizontally
+  abcg::convertSurface(*surface,
+                       {.bytesPerPixel = 3,
+                        .flipHorizontally = rightHandedSystem && !isYFace,
+                        .flipVertically = rightHandedSystem && isYFace},
+                       face.pixels);
+
+  // Swap -z and +z
+  if (rightHandedSystem) {
+    if (target == GL_TEXTURE_CUBE_MAP_POSITIVE_Z)
+      face.target = GL_TEXTURE_CUBE_MAP_NEGATIVE_Z;
+    else if (target == GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
+      face.target = GL_TEXTURE_CUBE_MAP_POSITIVE_Z;
+  }
+
+  return face;
+}
+} // namespace
 
 /**
  * @brief Creates an OpenGL 2D texture from an image loaded from a filesystem
@@ -31,36 +89,30 @@ GLuint abcg::loadOpenGLTexture(OpenGLTextureCreateInfo const &createInfo) {
   GLuint textureID{};
 
   if (SDL_Surface *const surface{IMG_Load(createInfo.path.data())}) {
+    auto const freeSurface{
+        gsl::finally([surface] { SDL_FreeSurface(surface); })};
+
     // Enforce RGB/RGBA
-    GLenum internalFormat{};
-    GLenum format{};
-    SDL_Surface *formattedSurface{};
-    if (surface->format->BytesPerPixel == 3) {
-      formattedSurface =
-          SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB24, 0);
-      internalFormat = createInfo.sRGBToLinear ? GL_SRGB8 : GL_RGB;
-      format = GL_RGB;
-    } else {
-      formattedSurface =
-          SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
-      internalFormat = createInfo.sRGBToLinear ? GL_SRGB8_ALPHA8 : GL_RGBA;
-      format = GL_RGBA;
+    auto const hasAlpha{surface->format->BytesPerPixel != 3};
+    auto const format{hasAlpha ? GLenum{GL_RGBA} : GLenum{GL_RGB}};
+    GLenum internalFormat{format};
+    if (createInfo.sRGBToLinear) {
+      internalFormat = hasAlpha ? GL_SRGB8_ALPHA8 : GL_SRGB8;
     }
-    SDL_FreeSurface(surface);
 
-    // Flip upside down
-    if (createInfo.flipUpsideDown) {
-      flipVertically(*formattedSurface);
-    }
+    // Convert and flip upside down in a single pass
+    auto &pixels{getStagingBuffer()};
+    convertSurface(*surface,
+                   {.bytesPerPixel = hasAlpha ? 4 : 3,
+                    .flipVertically = createInfo.flipUpsideDown},
+                   pixels);
 
     // Generate the texture
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
     glTexImage2D(GL_TEXTURE_2D, 0, gsl::narrow<GLint>(internalFormat),
-                 formattedSurface->w, formattedSurface->h, 0, format,
-                 GL_UNSIGNED_BYTE, formattedSurface->pixels);
-
-    SDL_FreeSurface(formattedSurface);
+                 surface->w, surface->h, 0, format, GL_UNSIGNED_BYTE,
+                 pixels.data());
 
     // Set texture filtering
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -92,6 +144,9 @@ GLuint abcg::loadOpenGLTexture(OpenGLTextureCreateInfo const &createInfo) {
  * @brief Creates an OpenGL cubemap texture from a set of images loaded from
  * filesystem paths.
  *
+ * The images are decoded concurrently by abcg::ThreadPool::getDefault. Only
+ * the uploads are done in the calling thread.
+ *
  * @param createInfo Texture creation settings.
  *
  * @throw abcg::RuntimeError if any image could not be loaded.
@@ -99,46 +154,39 @@ GLuint abcg::loadOpenGLTexture(OpenGLTextureCreateInfo const &createInfo) {
  * @return ID of the texture, as generated by glGenTextures.
  */
 GLuint abcg::loadOpenGLCubemap(OpenGLCubemapCreateInfo const &createInfo) {
+  // Decode the faces concurrently
+  std::array<std::future<CubemapFace>, 6> faces;
+  for (auto &&[index, path] : iter::enumerate(createInfo.paths)) {
+    auto const target{GL_TEXTURE_CUBE_MAP_POSITIVE_X +
+                      gsl::narrow<GLenum>(index)};
+    faces.at(index) = ThreadPool::getDefault().submit(
+        [path = std::string{path}, target,
+         rightHandedSystem = createInfo.rightHandedSystem] {
+          return decodeCubemapFace(path, target, rightHandedSystem);
+        });
+  }
+
+  // Wait for every face, so that no task outlives a failed load
+  for (auto const &face : faces) {
+    face.wait();
+  }
+
   GLuint textureID{};
   glGenTextures(1, &textureID);
   glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
-  for (auto &&[index, path] : iter::enumerate(createInfo.paths)) {
-    // Load the bitmap
-    if (SDL_Surface *const surface{IMG_Load(path.data())}) {
-      // Enforce RGB
-      SDL_Surface *const formattedSurface{
-          SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB24, 0)};
-      SDL_FreeSurface(surface);
-
-      auto target{GL_TEXTURE_CUBE_MAP_POSITIVE_X + gsl::narrow<GLenum>(index)};
-
-      // LHS to RHS
-      if (createInfo.rightHandedSystem) {
-        if (target == GL_TEXTURE_CUBE_MAP_POSITIVE_Y ||
-            target == GL_TEXTURE_CUBE_MAP_NEGATIVE_Y) {
-          // Flip upside down
-          flipVertically(*formattedSurface);
-        } else {
-          flipHorizontally(*formattedSurface);
-        }
-
-        // Swap -z and +z
-        if (target == GL_TEXTURE_CUBE_MAP_POSITIVE_Z)
-          target = GL_TEXTURE_CUBE_MAP_NEGATIVE_Z;
-        else if (target == GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
-          target = GL_TEXTURE_CUBE_MAP_POSITIVE_Z;
-      }
-
-      // Create texture
-      glTexImage2D(target, 0, GL_RGB, formattedSurface->w, formattedSurface->h,
-                   0, GL_RGB, GL_UNSIGNED_BYTE, formattedSurface->pixels);
-
-      SDL_FreeSurface(formattedSurface);
-    } else {
-      throw abcg::RuntimeError(
-          fmt::format("Failed to load texture file {}", path));
+  // Upload the faces in the GL thread
+  for (auto &future : faces) {
+    CubemapFace face;
+    try {
+      face = future.get();
+    } catch (...) {
+      glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+      glDeleteTextures(1, &textureID);
+      throw;
     }
+    glTexImage2D(face.target, 0, GL_RGB, face.width, face.height, 0, GL_RGB,
+                 GL_UNSIGNED_BYTE, face.pixels.data());
   }
 
   // Set texture wrapping
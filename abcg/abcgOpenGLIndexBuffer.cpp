@@ -0,0 +1,316 @@
+/**
+ * @file abcgOpenGLIndexBuffer.cpp
+ * @brief Definition of abcg::OpenGLIndexBuffer members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLIndexBuffer.hpp"
+
+#include <algorithm>
+
+#include "abcgExternal.hpp"
+#include "abcgOpenGLFunction.hpp"
+
+namespace {
+// Number of vertices addressable by 16-bit indices. Index 0xFFFF is excluded,
+// as WebGL 2 always treats it as the primitive restart index, and so does
+// OpenGL when GL_PRIMITIVE_RESTART_FIXED_INDEX is enabled
+constexpr std::size_t maxShortVertices{0xFFFF};
+
+// Returns true if a mesh can be stored with 16-bit indices without splitting
+constexpr bool fitsShortIndices(std::size_t numVertices) {
+  return numVertices <= maxShortVertices;
+}
+
+static_assert(fitsShortIndices(65535), "Largest mesh with 16-bit indices");
+static_assert(!fitsShortIndices(65536), "Index 0xFFFF is primitive restart");
+
+// Minimum average number of indices per range for splitting a large mesh.
+// Below this, the cost of the additional draw calls outweighs the savings.
+constexpr std::size_t minIndicesPerRange{4096};
+} // namespace
+
+/**
+ * @brief Creates the buffer object.
+ *
+ * @param indices Index array.
+ * @param numVertices Number of vertices referenced by the index array.
+ * @param indicesPerPrimitive Number of indices of each primitive (e.g., 3 for
+ * `GL_TRIANGLES`). Ranges drawn with different base vertices never split a
+ * primitive.
+ */
+void abcg::OpenGLIndexBuffer::create(std::span<std::uint32_t const> indices,
+                                     std::size_t numVertices,
+                                     std::size_t indicesPerPrimitive) {
+  destroy();
+
+  m_count = indices.size();
+  indicesPerPrimitive = std::max(indicesPerPrimitive, std::size_t{1});
+
+  // Split into ranges of primitives spanning at most 65535 vertices
+  std::vector<Range> ranges;
+  if (fitsShortIndices(numVertices) || indices.empty()) {
+    ranges.push_back({.first = 0, .count = m_count, .baseVertex = 0});
+  } else {
+#if !defined(__EMSCRIPTEN__)
+    auto rangeMin{std::numeric_limits<std::uint32_t>::max()};
+    std::uint32_t rangeMax{};
+    std::size_t rangeFirst{};
+    auto isSplittable{true};
+    for (std::size_t first{}; first < m_count; first += indicesPerPrimitive) {
+      auto const primitive{indices.subspan(
+          first, std::min(indicesPerPrimitive, m_count - first))};
+      auto const [primitiveMin, primitiveMax]{std::ranges::minmax(primitive)};
+      if (primitiveMax - primitiveMin >= maxShortVertices) {
+        isSplittable = false;
+        break;
+      }
+      auto const newMin{std::min(rangeMin, primitiveMin)};
+      auto const newMax{std::max(rangeMax, primitiveMax)};
+      if (first > rangeFirst && newMax - newMin >= maxShortVertices) {
+        ranges.push_back({.first = rangeFirst,
+                          .count = first - rangeFirst,
+                          .baseVertex = gsl::narrow<GLint>(rangeMin)});
+        rangeFirst = first;
+        rangeMin = primitiveMin;
+        rangeMax = primitiveMax;
+      } else {
+        rangeMin = newMin;
+        rangeMax = newMax;
+      }
+    }
+    ranges.push_back({.first = rangeFirst,
+                      .count = m_count - rangeFirst,
+                      .baseVertex = gsl::narrow<GLint>(rangeMin)});
+    if (!isSplittable || ranges.size() * minIndicesPerRange > m_count) {
+      ranges.clear();
+    }
+#endif
+  }
+
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer);
+  if (ranges.empty()) {
+    m_type = GL_UNSIGNED_INT;
+    m_ranges = {{.first = 0, .count = m_count, .baseVertex = 0}};
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 gsl::narrow<GLsizeiptr>(indices.size_bytes()), indices.data(),
+                 GL_STATIC_DRAW);
+  } else {
+    m_type = GL_UNSIGNED_SHORT;
+    m_ranges = std::move(ranges);
+    std::vector<std::uint16_t> shortIndices(m_count);
+    for (auto const &range : m_ranges) {
+      for (auto index{range.first}; index < range.first + range.count;
+           ++index) {
+        shortIndices[index] =
+            static_cast<std::uint16_t>(
+                indices[index] - gsl::narrow<std::uint32_t>(range.baseVertex));
+      }
+    }
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 gsl::narrow<GLsizeiptr>(shortIndices.size() *
+                                         sizeof(std::uint16_t)),
+                 shortIndices.data(), GL_STATIC_DRAW);
+  }
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+/**
+ * @brief Releases the buffer object.
+ */
+void abcg::OpenGLIndexBuffer::destroy() {
+  if (m_buffer != 0) {
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+  }
+  m_count = 0;
+  m_ranges.clear();
+}
+
+/**
+ * @brief Binds the buffer object to the `GL_ELEMENT_ARRAY_BUFFER` target.
+ */
+void abcg::OpenGLIndexBuffer::bind() const {
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer);
+}
+
+/**
+ * @brief Renders primitives from the index array.
+ *
+ * The buffer object must be bound to the current vertex array object.
+ *
+ * @param mode Kind of primitives to render (e.g., `GL_TRIANGLES`).
+ * @param count Number of indices to render, starting from the first index.
+ * Values larger than abcg::OpenGLIndexBuffer::getCount render all indices.
+ */
+void abcg::OpenGLIndexBuffer::draw(GLenum mode, std::size_t count) const {
+  draw(mode, 0, count);
+}
+
+/**
+ * @brief Renders primitives from a range of the index array.
+ *
+ * The buffer object must be bound to the current vertex array object.
+ *
+ * @param mode Kind of primitives to render (e.g., `GL_TRIANGLES`).
+ * @param first Index of the first index to render.
+ * @param count Number of indices to render. The range is clamped to the size
+ * of the index array.
+ */
+void abcg::OpenGLIndexBuffer::draw(GLenum mode, std::size_t first,
+                                   std::size_t count) const {
+  first = std::min(first, m_count);
+  auto const last{first + std::min(count, m_count - first)};
+  auto const indexSize{m_type == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t)
+                                                   : sizeof(std::uint32_t)};
+  for (auto const &range : m_ranges) {
+    auto const rangeFirst{std::max(range.first, first)};
+    auto const rangeLast{std::min(range.first + range.count, last)};
+    if (rangeFirst >= rangeLast)
+      continue;
+    auto const rangeCount{gsl::narrow<GLsizei>(rangeLast - rangeFirst)};
+    auto const *offset{reinterpret_cast<void const *>(rangeFirst * indexSize)};
+#if !defined(__EMSCRIPTEN__)
+    // Desktop-only function without an abcg wrapper
+    if (range.baseVertex != 0) {
+      glDrawElementsBaseVertex(mode, rangeCount, m_type, offset,
+                               range.baseVertex);
+      continue;
+    }
+#endif
+    glDrawElements(mode, rangeCount, m_type, offset);
+  }
+}
+
+/**
+ * @brief Renders primitives from several ranges of the index array with a
+ * single draw call, if supported.
+ *
+ * The buffer object must be bound to the current vertex array object. On
+ * desktop OpenGL, this calls `glMultiDrawElements`, or
+ * `glMultiDrawElementsBaseVertex` if the indices are split into ranges with
+ * different base vertices. With OpenGL ES, each range is drawn separately.
+ *
+ * @param mode Kind of primitives to render (e.g., `GL_TRIANGLES`).
+ * @param firsts Index of the first index of each range, in increasing order.
+ * @param counts Number of indices of each range.
+ */
+void abcg::OpenGLIndexBuffer::draw(GLenum mode,
+                                   std::span<std::size_t const> firsts,
+                                   std::span<std::size_t const> counts) const {
+  auto const numDraws{std::min(firsts.size(), counts.size())};
+#if defined(__EMSCRIPTEN__)
+  for (std::size_t draw{}; draw < numDraws; ++draw) {
+    this->draw(mode, firsts[draw], counts[draw]);
+  }
+#else
+  thread_local std::vector<GLsizei> drawCounts;
+  thread_local std::vector<void const *> drawOffsets;
+  thread_local std::vector<GLint> drawBaseVertices;
+  drawCounts.clear();
+  drawOffsets.clear();
+  drawBaseVertices.clear();
+
+  // Split the requested ranges at the boundaries of the stored ranges. As both
+  // are sorted, each stored range is visited once.
+  auto const indexSize{m_type == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t)
+                                                   : sizeof(std::uint32_t)};
+  auto range{m_ranges.begin()};
+  for (std::size_t draw{}; draw < numDraws; ++draw) {
+    auto const first{std::min(firsts[draw], m_count)};
+    auto const last{first + std::min(counts[draw], m_count - first)};
+    if (first == last)
+      continue;
+    while (range != m_ranges.end() && range->first + range->count <= first) {
+      ++range;
+    }
+    for (auto it{range}; it != m_ranges.end() && it->first < last; ++it) {
+      auto const rangeFirst{std::max(it->first, first)};
+      auto const rangeLast{std::min(it->first + it->count, last)};
+      drawCounts.push_back(gsl::narrow<GLsizei>(rangeLast - rangeFirst));
+      drawOffsets.push_back(
+          reinterpret_cast<void const *>(rangeFirst * indexSize));
+      drawBaseVertices.push_back(it->baseVertex);
+    }
+  }
+  if (drawCounts.empty())
+    return;
+
+  // Desktop-only functions without an abcg wrapper
+  auto const numRanges{gsl::narrow<GLsizei>(drawCounts.size())};
+  if (m_ranges.size() > 1) {
+    glMultiDrawElementsBaseVertex(mode, drawCounts.data(), m_type,
+                                  drawOffsets.data(), numRanges,
+                                  drawBaseVertices.data());
+  } else {
+    glMultiDrawElements(mode, drawCounts.data(), m_type, drawOffsets.data(),
+                        numRanges);
+  }
+#endif
+}
+
+/**
+ * @brief Renders several instances of the primitives from the index array.
+ *
+ * The buffer object must be bound to the current vertex array object.
+ *
+ * @param mode Kind of primitives to render (e.g., `GL_TRIANGLES`).
+ * @param instanceCount Number of instances to render.
+ * @param count Number of indices to render, starting from the first index.
+ * Values larger than abcg::OpenGLIndexBuffer::getCount render all indices.
+ */
+void abcg::OpenGLIndexBuffer::drawInstanced(GLenum mode, GLsizei instanceCount,
+                                            std::size_t count) const {
+  if (instanceCount <= 0)
+    return;
+  count = std::min(count, m_count);
+  auto const indexSize{m_type == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t)
+                                                   : sizeof(std::uint32_t)};
+  for (auto const &range : m_ranges) {
+    auto const rangeLast{std::min(range.first + range.count, count)};
+    if (range.first >= rangeLast)
+      continue;
+    auto const rangeCount{gsl::narrow<GLsizei>(rangeLast - range.first)};
+    auto const *offset{reinterpret_cast<void const *>(range.first * indexSize)};
+#if !defined(__EMSCRIPTEN__)
+    // Desktop-only function without an abcg wrapper
+    if (range.baseVertex != 0) {
+      glDrawElementsInstancedBaseVertex(mode, rangeCount, m_type, offset,
+                                        instanceCount, range.baseVertex);
+      continue;
+    }
+#endif
+    glDrawElementsInstanced(mode, rangeCount, m_type, offset, instanceCount);
+  }
+}
+
+/**
+ * @brief Returns the type of the indices stored in the buffer object.
+ *
+ * @return `GL_UNSIGNED_SHORT` or `GL_UNSIGNED_INT`.
+ */
+GLenum abcg::OpenGLIndexBuffer::getType() const noexcept { return m_type; }
+
+/**
+ * @brief Returns the number of indices.
+ *
+ * @return Number of indices.
+ */
+std::size_t abcg::OpenGLIndexBuffer::getCount() const noexcept {
+  return m_count;
+}
+
+/**
+ * @brief Returns the size of the index data stored in the buffer object.
+ *
+ * @return Size in bytes.
+ */
+std::size_t abcg::OpenGLIndexBuffer::getSize() const noexcept {
+  return m_count * (m_type == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t)
+                                                : sizeof(std::uint32_t));
+}
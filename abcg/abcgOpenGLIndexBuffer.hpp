@@ -0,0 +1,78 @@
+/**
+ * @file abcgOpenGLIndexBuffer.hpp
+ * @brief Header file of abcg::OpenGLIndexBuffer.
+ *
+ * Declaration of abcg::OpenGLIndexBuffer.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_INDEX_BUFFER_HPP_
+#define ABCG_OPENGL_INDEX_BUFFER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "abcgOpenGLExternal.hpp"
+
+namespace abcg {
+class OpenGLIndexBuffer;
+} // namespace abcg
+
+/**
+ * @brief A class for representing an element array buffer object with the
+ * smallest index type that fits the mesh.
+ *
+ * Indices are stored as `GL_UNSIGNED_SHORT` if the mesh has at most 65535
+ * vertices, so that index 0xFFFF, which WebGL always uses for primitive
+ * restart, never occurs. Larger meshes are split into consecutive ranges of
+ * primitives whose indices span at most 65535 vertices, and each range is drawn
+ * with a base vertex. If this would result in many small ranges, or if base
+ * vertex draws are not supported (WebGL), the indices are stored as
+ * `GL_UNSIGNED_INT`.
+ *
+ * Since the element array buffer binding is part of the vertex array object
+ * state, call abcg::OpenGLIndexBuffer::bind while setting up the VAO, and
+ * abcg::OpenGLIndexBuffer::draw while the VAO is bound.
+ */
+class abcg::OpenGLIndexBuffer {
+public:
+  void create(std::span<std::uint32_t const> indices, std::size_t numVertices,
+              std::size_t indicesPerPrimitive = 3);
+  void destroy();
+
+  void bind() const;
+  void draw(GLenum mode,
+            std::size_t count = std::numeric_limits<std::size_t>::max()) const;
+  void draw(GLenum mode, std::size_t first, std::size_t count) const;
+  void draw(GLenum mode, std::span<std::size_t const> firsts,
+            std::span<std::size_t const> counts) const;
+  void drawInstanced(
+      GLenum mode, GLsizei instanceCount,
+      std::size_t count = std::numeric_limits<std::size_t>::max()) const;
+
+  [[nodiscard]] GLenum getType() const noexcept;
+  [[nodiscard]] std::size_t getCount() const noexcept;
+  [[nodiscard]] std::size_t getSize() const noexcept;
+
+private:
+  // Consecutive indices drawn with the same base vertex
+  struct Range {
+    std::size_t first{};
+    std::size_t count{};
+    GLint baseVertex{};
+  };
+
+  GLuint m_buffer{};
+  GLenum m_type{GL_UNSIGNED_INT};
+  std::size_t m_count{};
+  std::vector<Range> m_ranges;
+};
+
+#endif
@@ -0,0 +1,393 @@
+/**
+ * @file abcgOpenGLProgram.cpp
+ * @brief Definition of abcg::OpenGLProgram members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLProgram.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "abcgOpenGLFunction.hpp"
+#include "abcgOpenGLShader.hpp"
+
+namespace {
+// Returns the variable with the given name from a table sorted by name, or
+// nullptr if not found.
+[[nodiscard]] abcg::OpenGLProgramVariable const *
+findVariable(std::vector<abcg::OpenGLProgramVariable> const &variables,
+             std::string_view name) {
+  auto const iter{std::lower_bound(
+      variables.begin(), variables.end(), name,
+      [](auto const &variable, std::string_view value) {
+        return std::string_view{variable.name} < value;
+      })};
+  if (iter == variables.end() || iter->name != name)
+    return nullptr;
+  return &*iter;
+}
+
+// Removes the "[0]" suffix of array variable names
+void removeArraySuffix(std::string &name) {
+  if (name.ends_with("[0]")) {
+    name.resize(name.size() - 3);
+  }
+}
+} // namespace
+
+/**
+ * @brief Creates the program object from a group of shader paths or source
+ * codes.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders to be compiled and
+ * linked to the program.
+ *
+ * @throw abcg::RuntimeError if the program could not be built.
+ *
+ * @sa abcg::createOpenGLProgram.
+ */
+void abcg::OpenGLProgram::create(
+    std::vector<ShaderSource> const &pathsOrSources) {
+  create(createOpenGLProgram(pathsOrSources));
+}
+
+/**
+ * @brief Creates the object from an existing program object.
+ *
+ * The program object must be successfully linked. Its ownership is transferred
+ * to this object, and it will be deleted by abcg::OpenGLProgram::destroy.
+ *
+ * @param program ID of the program object.
+ */
+void abcg::OpenGLProgram::create(GLuint program) {
+  destroy();
+  m_program = program;
+  reflect();
+}
+
+/**
+ * @brief Deletes the program object and clears the reflection tables.
+ */
+void abcg::OpenGLProgram::destroy() {
+  if (m_program != 0) {
+    glDeleteProgram(m_program);
+    m_program = 0;
+  }
+  m_uniforms.clear();
+  m_attributes.clear();
+  m_uniformValues.clear();
+  m_uniformValid.clear();
+}
+
+/**
+ * @brief Installs the program object as part of the current rendering state.
+ */
+void abcg::OpenGLProgram::use() const { glUseProgram(m_program); }
+
+/**
+ * @brief Returns the location of an active uniform variable.
+ *
+ * This does not call `glGetUniformLocation`.
+ *
+ * @param name Name of the uniform variable.
+ *
+ * @return Location of the uniform, or -1 if there is no active uniform with
+ * the given name.
+ */
+GLint abcg::OpenGLProgram::getUniformLocation(std::string_view name) const {
+  auto const *variable{findVariable(m_uniforms, name)};
+  return variable == nullptr ? -1 : variable->location;
+}
+
+/**
+ * @brief Returns the location of an active attribute variable.
+ *
+ * This does not call `glGetAttribLocation`.
+ *
+ * @param name Name of the attribute variable.
+ *
+ * @return Location of the attribute, or -1 if there is no active attribute
+ * with the given name.
+ */
+GLint abcg::OpenGLProgram::getAttributeLocation(std::string_view name) const {
+  auto const *variable{findVariable(m_attributes, name)};
+  return variable == nullptr ? -1 : variable->location;
+}
+
+/**
+ * @brief Returns the active uniform variables of the program.
+ *
+ * @return Reference to the uniforms, sorted by name.
+ */
+std::vector<abcg::OpenGLProgramVariable> const &
+abcg::OpenGLProgram::getUniforms() const noexcept {
+  return m_uniforms;
+}
+
+/**
+ * @brief Returns the active attribute variables of the program.
+ *
+ * @return Reference to the attributes, sorted by name.
+ */
+std::vector<abcg::OpenGLProgramVariable> const &
+abcg::OpenGLProgram::getAttributes() const noexcept {
+  return m_attributes;
+}
+
+/**
+ * @brief Associates a uniform block of the program with a uniform buffer
+ * binding point.
+ *
+ * @param blockName Name of the uniform block.
+ * @param bindingPoint Index of the uniform buffer binding point.
+ *
+ * @return `true` if the program has an active uniform block with the given
+ * name; `false` otherwise.
+ *
+ * @sa abcg::OpenGLUniformBuffer.
+ */
+bool abcg::OpenGLProgram::setUniformBlockBinding(std::string_view blockName,
+                                                 GLuint bindingPoint) {
+  std::string const name{blockName};
+  auto const blockIndex{glGetUniformBlockIndex(m_program, name.c_str())};
+  if (blockIndex == GL_INVALID_INDEX)
+    return false;
+  glUniformBlockBinding(m_program, blockIndex, bindingPoint);
+  return true;
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `int`, `bool` or
+ * sampler.
+ *
+ * The value is not uploaded if it is equal to the last value set to the same
+ * location.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, GLint value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniform1i(location, value);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `uint`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, GLuint value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniform1ui(location, value);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `float`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, GLfloat value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniform1f(location, value);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `vec2`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, glm::vec2 const &value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniform2fv(location, 1, &value.x);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `vec3`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, glm::vec3 const &value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniform3fv(location, 1, &value.x);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `vec4`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, glm::vec4 const &value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniform4fv(location, 1, &value.x);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `ivec2`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, glm::ivec2 const &value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniform2iv(location, 1, &value.x);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `ivec3`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, glm::ivec3 const &value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniform3iv(location, 1, &value.x);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `ivec4`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, glm::ivec4 const &value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniform4iv(location, 1, &value.x);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `mat2`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, glm::mat2 const &value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniformMatrix2fv(location, 1, GL_FALSE, &value[0][0]);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `mat3`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, glm::mat3 const &value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniformMatrix3fv(location, 1, GL_FALSE, &value[0][0]);
+}
+
+/**
+ * @brief Sets the value of a uniform variable of type `mat4`.
+ *
+ * @param location Location of the uniform variable.
+ * @param value New value.
+ */
+void abcg::OpenGLProgram::setUniform(GLint location, glm::mat4 const &value) {
+  if (updateCachedValue(location, &value, sizeof(value)))
+    glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+}
+
+// Returns true if the value must be uploaded, i.e., if the location is valid
+// and the value differs from the last value stored at that location.
+bool abcg::OpenGLProgram::updateCachedValue(GLint location, void const *data,
+                                            std::size_t size) {
+  if (location < 0)
+    return false;
+
+  auto const index{gsl::narrow<std::size_t>(location)};
+  if (index >= m_uniformValues.size()) {
+    // Not a location reported by reflection (e.g., an element of an array):
+    // upload without caching
+    return true;
+  }
+
+  auto &cachedValue{m_uniformValues.at(index)};
+  if (m_uniformValid.at(index) &&
+      std::memcmp(cachedValue.data(), data, size) == 0) {
+    return false;
+  }
+
+  std::memcpy(cachedValue.data(), data, size);
+  m_uniformValid.at(index) = true;
+  return true;
+}
+
+void abcg::OpenGLProgram::reflect() {
+  if (m_program == 0)
+    return;
+
+  GLint maxNameLength{};
+  std::string name;
+
+  // Uniforms
+  GLint numUniforms{};
+  glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &numUniforms);
+  glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+  m_uniforms.reserve(gsl::narrow<std::size_t>(numUniforms));
+  for (auto const index : iter::range(gsl::narrow<GLuint>(numUniforms))) {
+    name.resize(gsl::narrow<std::size_t>(std::max(maxNameLength, 1)));
+    GLsizei length{};
+    GLint size{};
+    GLenum type{};
+    glGetActiveUniform(m_program, index, maxNameLength, &length, &size, &type,
+                       name.data());
+    name.resize(gsl::narrow<std::size_t>(length));
+
+    // Uniforms of uniform blocks have no location
+    auto const location{glGetUniformLocation(m_program, name.c_str())};
+    if (location < 0)
+      continue;
+
+    removeArraySuffix(name);
+    m_uniforms.push_back(
+        {.name = name, .location = location, .type = type, .size = size});
+  }
+
+  // Attributes
+  GLint numAttributes{};
+  glGetProgramiv(m_program, GL_ACTIVE_ATTRIBUTES, &numAttributes);
+  glGetProgramiv(m_program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength);
+  m_attributes.reserve(gsl::narrow<std::size_t>(numAttributes));
+  for (auto const index : iter::range(gsl::narrow<GLuint>(numAttributes))) {
+    name.resize(gsl::narrow<std::size_t>(std::max(maxNameLength, 1)));
+    GLsizei length{};
+    GLint size{};
+    GLenum type{};
+    glGetActiveAttrib(m_program, index, maxNameLength, &length, &size, &type,
+                      name.data());
+    name.resize(gsl::narrow<std::size_t>(length));
+
+    // Built-in attributes (e.g., gl_VertexID) have no location
+    auto const location{glGetAttribLocation(m_program, name.c_str())};
+    if (location < 0)
+      continue;
+
+    removeArraySuffix(name);
+    m_attributes.push_back(
+        {.name = name, .location = location, .type = type, .size = size});
+  }
+
+  auto const byName{[](auto const &lhs, auto const &rhs) {
+    return lhs.name < rhs.name;
+  }};
+  std::sort(m_uniforms.begin(), m_uniforms.end(), byName);
+  std::sort(m_attributes.begin(), m_attributes.end(), byName);
+
+  // Value cache indexed by location
+  GLint maxLocation{-1};
+  for (auto const &uniform : m_uniforms) {
+    maxLocation = std::max(maxLocation, uniform.location);
+  }
+  m_uniformValues.resize(gsl::narrow<std::size_t>(maxLocation + 1));
+  m_uniformValid.assign(m_uniformValues.size(), false);
+}
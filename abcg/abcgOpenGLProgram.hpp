@@ -0,0 +1,137 @@
+/**
+ * @file abcgOpenGLProgram.hpp
+ * @brief Header file of abcg::OpenGLProgram.
+ *
+ * Declaration of abcg::OpenGLProgram.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_PROGRAM_HPP_
+#define ABCG_OPENGL_PROGRAM_HPP_
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abcgExternal.hpp"
+#include "abcgOpenGLExternal.hpp"
+#include "abcgShader.hpp"
+
+namespace abcg {
+struct OpenGLProgramVariable;
+class OpenGLProgram;
+} // namespace abcg
+
+/**
+ * @brief Active uniform or attribute variable of a program object.
+ *
+ * @sa abcg::OpenGLProgram::getUniforms.
+ * @sa abcg::OpenGLProgram::getAttributes.
+ */
+struct abcg::OpenGLProgramVariable {
+  /** @brief Name of the variable. For arrays, the name does not include the
+   * `[0]` suffix. */
+  std::string name{};
+  /** @brief Location of the variable. */
+  GLint location{-1};
+  /** @brief Data type of the variable (e.g., `GL_FLOAT_VEC4`). */
+  GLenum type{};
+  /** @brief Number of array elements, or 1 if the variable is not an array. */
+  GLint size{};
+};
+
+/**
+ * @brief A class for representing an OpenGL program object.
+ *
+ * On creation, the active uniforms and attributes of the program are queried
+ * once and stored in flat tables sorted by name, so that looking up a location
+ * does not call into the driver.
+ *
+ * The typed abcg::OpenGLProgram::setUniform functions keep a copy of the last
+ * value uploaded to each uniform location and skip the upload if the value has
+ * not changed. For this reason, uniform values must only be modified through
+ * these functions.
+ *
+ * Uniforms that belong to uniform blocks are not included in the table.
+ *
+ * @remark The program must be in use (see abcg::OpenGLProgram::use) when
+ * calling abcg::OpenGLProgram::setUniform.
+ */
+class abcg::OpenGLProgram {
+public:
+  void create(std::vector<ShaderSource> const &pathsOrSources);
+  void create(GLuint program);
+  void destroy();
+
+  void use() const;
+
+  /**
+   * @brief Conversion to GLuint.
+   *
+   * @return ID of the program object.
+   */
+  explicit operator GLuint() const noexcept { return m_program; }
+
+  [[nodiscard]] GLint getUniformLocation(std::string_view name) const;
+  [[nodiscard]] GLint getAttributeLocation(std::string_view name) const;
+  [[nodiscard]] std::vector<OpenGLProgramVariable> const &
+  getUniforms() const noexcept;
+  [[nodiscard]] std::vector<OpenGLProgramVariable> const &
+  getAttributes() const noexcept;
+
+  bool setUniformBlockBinding(std::string_view blockName, GLuint bindingPoint);
+
+  void setUniform(GLint location, GLint value);
+  void setUniform(GLint location, GLuint value);
+  void setUniform(GLint location, GLfloat value);
+  void setUniform(GLint location, glm::vec2 const &value);
+  void setUniform(GLint location, glm::vec3 const &value);
+  void setUniform(GLint location, glm::vec4 const &value);
+  void setUniform(GLint location, glm::ivec2 const &value);
+  void setUniform(GLint location, glm::ivec3 const &value);
+  void setUniform(GLint location, glm::ivec4 const &value);
+  void setUniform(GLint location, glm::mat2 const &value);
+  void setUniform(GLint location, glm::mat3 const &value);
+  void setUniform(GLint location, glm::mat4 const &value);
+
+  /**
+   * @brief Sets the value of a uniform variable given its name.
+   *
+   * This is equivalent to calling abcg::OpenGLProgram::setUniform with the
+   * location returned by abcg::OpenGLProgram::getUniformLocation. Nothing is
+   * done if the program has no active uniform with the given name.
+   *
+   * @tparam T Type of the value.
+   *
+   * @param name Name of the uniform variable.
+   * @param value New value.
+   */
+  template <typename T> void setUniform(std::string_view name, T const &value) {
+    setUniform(getUniformLocation(name), value);
+  }
+
+private:
+  // Last value uploaded to a uniform location (up to a mat4)
+  using UniformValue = std::array<std::byte, sizeof(glm::mat4)>;
+
+  [[nodiscard]] bool updateCachedValue(GLint location, void const *data,
+                                       std::size_t size);
+  void reflect();
+
+  GLuint m_program{};
+
+  std::vector<OpenGLProgramVariable> m_uniforms;
+  std::vector<OpenGLProgramVariable> m_attributes;
+
+  // Cached uniform values indexed by location
+  std::vector<UniformValue> m_uniformValues;
+  std::vector<bool> m_uniformValid;
+};
+
+#endif
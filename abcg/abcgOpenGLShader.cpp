@@ -16,12 +16,21 @@
 
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <vector>
 
 #include "abcgException.hpp"
+#include "abcgUtil.hpp"
 
 namespace {
+// Directory of the program binary cache. The cache is disabled if empty.
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+std::string programCacheDirectory;
+
+// Magic number of the program binary cache files ("ABCG")
+constexpr std::uint32_t programCacheMagic{0x47434241};
+
 void printShaderInfoLog(GLuint const shader, std::string_view prefix) {
   GLint infoLogLength{};
   glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
@@ -113,6 +122,148 @@ void deleteShaders(std::vector<abcg::OpenGLShader> const &shaderIDs) {
   }
 }
 
+// Returns true if the context supports retrieving and loading program
+// binaries in at least one binary format.
+[[nodiscard]] bool isProgramBinarySupported() {
+#if defined(__EMSCRIPTEN__)
+  return false;
+#else
+  if (GLEW_ARB_get_program_binary == GL_FALSE)
+    return false;
+  GLint numFormats{};
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+  return numFormats > 0;
+#endif
+}
+
+// Returns the path of the cache file of the program built from the given
+// sources, or an empty path if the cache is disabled or not supported. The key
+// combines the final source code and stage of each shader with the vendor,
+// renderer and version strings of the OpenGL implementation, so that a driver
+// update invalidates the cache.
+[[nodiscard]] std::filesystem::path
+programCachePath(std::vector<abcg::ShaderSource> const &sources) {
+  if (programCacheDirectory.empty() || !isProgramBinarySupported())
+    return {};
+
+  auto const toString{[](GLenum name) {
+    auto const *str{reinterpret_cast<char const *>(glGetString(name))};
+    return std::string{str == nullptr ? "" : str};
+  }};
+
+  auto key{abcg::hashCombine(toString(GL_VENDOR), toString(GL_RENDERER),
+                             toString(GL_VERSION))};
+  for (auto const &source : sources) {
+    abcg::hashCombineSeed(key, source.source, static_cast<int>(source.stage));
+  }
+
+  return std::filesystem::path{programCacheDirectory} /
+         fmt::format("{:016x}.bin", key);
+}
+
+// Creates a program object from a cached program binary. Returns 0 if the file
+// does not exist or if the binary was rejected by the driver, in which case the
+// stale file is removed.
+[[nodiscard]] GLuint loadProgramBinary(std::filesystem::path const &path) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream)
+    return 0;
+
+  std::error_code errorCode;
+  std::uint32_t magic{};
+  GLenum binaryFormat{};
+  if (!stream.read(reinterpret_cast<char *>(&magic), sizeof(magic)) ||
+      !stream.read(reinterpret_cast<char *>(&binaryFormat),
+                   sizeof(binaryFormat)) ||
+      magic != programCacheMagic) {
+    stream.close();
+    std::filesystem::remove(path, errorCode);
+    return 0;
+  }
+  std::vector<char> const binary{std::istreambuf_iterator<char>(stream),
+                                 std::istreambuf_iterator<char>()};
+  stream.close();
+  if (binary.empty()) {
+    std::filesystem::remove(path, errorCode);
+    return 0;
+  }
+
+  auto const program{glCreateProgram()};
+  if (program == 0)
+    return 0;
+
+  // Not using the abcg wrapper here, as the driver is allowed to reject the
+  // binary with GL_INVALID_ENUM/GL_INVALID_VALUE. Any error is cleared and
+  // treated as a cache miss.
+  ::glProgramBinary(program, binaryFormat, binary.data(),
+                    gsl::narrow<GLsizei>(binary.size()));
+  while (::glGetError() != GL_NO_ERROR) {
+  }
+
+  GLint linkStatus{};
+  glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+  if (linkStatus == GL_FALSE) {
+    glDeleteProgram(program);
+    std::filesystem::remove(path, errorCode);
+    return 0;
+  }
+
+  return program;
+}
+
+// Writes the binary of a successfully linked program to the cache. Failures
+// are not reported, as the cache is only an optimization.
+void saveProgramBinary(GLuint program, std::filesystem::path const &path) {
+  GLint binaryLength{};
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+  if (binaryLength <= 0)
+    return;
+
+  std::vector<char> binary(gsl::narrow<std::size_t>(binaryLength));
+  GLenum binaryFormat{};
+  glGetProgramBinary(program, binaryLength, nullptr, &binaryFormat,
+                     binary.data());
+
+  abcg::writeFileAtomically(path,
+                            {std::as_bytes(std::span{&programCacheMagic, 1}),
+                             std::as_bytes(std::span{&binaryFormat, 1}),
+                             std::as_bytes(std::span{binary})});
+}
+
+// Returns true if the context supports GL_KHR_parallel_shader_compile or
+// GL_ARB_parallel_shader_compile. On the first call, lets the driver choose
+// the maximum number of shader compiler threads.
+[[nodiscard]] bool isParallelShaderCompileSupported() {
+#if defined(__EMSCRIPTEN__) || !defined(GL_COMPLETION_STATUS_KHR)
+  return false;
+#else
+  static auto const supported{[] {
+    if (GLEW_KHR_parallel_shader_compile == GL_TRUE) {
+      glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+      return true;
+    }
+    if (GLEW_ARB_parallel_shader_compile == GL_TRUE) {
+      glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+      return true;
+    }
+    return false;
+  }()};
+  return supported;
+#endif
+}
+
+// Deletes the program and shader objects of a batch that are still alive
+void deleteProgramBatch(abcg::OpenGLProgramBatch &batch) {
+  for (auto &&[program, shaders] : iter::zip(batch.programs, batch.shaders)) {
+    deleteShaders(shaders);
+    shaders.clear();
+    if (program != 0) {
+      glDeleteProgram(program);
+      program = 0;
+    }
+  }
+}
+
 [[nodiscard]] GLuint abcgStageToOpenGLStage(abcg::ShaderStage stage) {
   switch (stage) {
   case abcg::ShaderStage::Vertex:
@@ -143,9 +294,35 @@ void deleteShaders(std::vector<abcg::OpenGLShader> const &shaderIDs) {
 }
 } // namespace
 
+/**
+ * @brief Sets the directory of the on-disk program binary cache.
+ *
+ * When the cache is enabled, abcg::createOpenGLProgram looks up a program
+ * binary previously saved for the same shader sources, stages and OpenGL
+ * implementation (vendor, renderer and version) before compiling the shaders.
+ * If the driver accepts the binary, no shader is compiled or linked. If the
+ * binary is rejected (e.g., after a driver update), the stale file is removed
+ * and the program is built from the sources as usual, and its binary is saved
+ * again.
+ *
+ * @param directory Path to the cache directory. It is created if it does not
+ * exist. An empty path disables the cache, which is the default.
+ *
+ * @remark The cache is not supported in WebGL, or if the OpenGL context does
+ * not support `GL_ARB_get_program_binary`. In that case, this function has no
+ * effect.
+ */
+void abcg::setOpenGLProgramCacheDirectory(std::string_view directory) {
+  programCacheDirectory = directory;
+}
+
 /**
  * @brief Creates a program object from a group of shader paths or source codes.
  *
+ * If the program binary cache is enabled with
+ * abcg::setOpenGLProgramCacheDirectory, the program is first looked up in the
+ * cache.
+ *
  * @param pathsOrSources Paths or source codes of the shaders to be compiled and
  * linked to the program.
  * @param throwOnError Whether to throw exceptions on compile/link errors.
@@ -166,6 +343,13 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
         {.source = toSource(pathOrSource.source), .stage = pathOrSource.stage});
   }
 
+  auto const cachePath{programCachePath(sources)};
+  if (!cachePath.empty()) {
+    if (auto const program{loadProgramBinary(cachePath)}; program != 0) {
+      return program;
+    }
+  }
+
   std::vector<OpenGLShader> compiledShaders;
   compiledShaders.reserve(sources.size());
   for (auto const &source : sources) {
@@ -189,6 +373,11 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
     glAttachShader(shaderProgram, shader.shader);
   }
 
+  if (!cachePath.empty()) {
+    glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                        GL_TRUE);
+  }
+
   glLinkProgram(shaderProgram);
 
   for (auto const &shader : compiledShaders) {
@@ -209,6 +398,10 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
     return 0U;
   }
 
+  if (!cachePath.empty()) {
+    saveProgramBinary(shaderProgram, cachePath);
+  }
+
   return shaderProgram;
 }
 
@@ -361,4 +554,217 @@ bool abcg::checkOpenGLShaderLink(GLuint shaderProgram, bool throwOnError) {
   }
 
   return true;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Creates a group of program objects, overlapping the build of all
+ * programs.
+ *
+ * This is equivalent to calling abcg::createOpenGLProgram for each group of
+ * shaders, but all shaders are submitted for compilation before any program is
+ * linked, and no compile or link status is queried until all programs have
+ * been submitted. If `GL_KHR_parallel_shader_compile` (or its ARB variant) is
+ * available, the driver is allowed to use multiple threads to build the
+ * programs.
+ *
+ * Programs found in the program binary cache (see
+ * abcg::setOpenGLProgramCacheDirectory) are not compiled.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders of each program.
+ * @param throwOnError Whether to throw exceptions on compile/link errors.
+ *
+ * @throw abcg::RuntimeError if a shader could not be read from file, or if a
+ * program could not be created, or if the compilation of any shader has
+ * failed, or if the linking of any program has failed.
+ *
+ * @return IDs of the program objects, in the same order of @a pathsOrSources.
+ * An ID is 0 if the corresponding program failed to build.
+ *
+ * @sa abcg::triggerOpenGLProgramsBuild for a non-blocking alternative.
+ */
+std::vector<GLuint> abcg::createOpenGLPrograms(
+    std::vector<std::vector<ShaderSource>> const &pathsOrSources,
+    bool throwOnError) {
+  auto batch{triggerOpenGLProgramsBuild(pathsOrSources)};
+  return checkOpenGLProgramsBuild(batch, throwOnError);
+}
+
+/**
+ * @brief Triggers the build of a group of programs and returns immediately.
+ *
+ * All shaders are submitted for compilation first, and then all programs are
+ * submitted for linking, without querying any status in between.
+ *
+ * Use abcg::isOpenGLProgramsBuildComplete to poll whether the build has
+ * completed (e.g., while a loading screen is being rendered), and
+ * abcg::checkOpenGLProgramsBuild to get the program objects.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders of each program.
+ *
+ * @throw abcg::RuntimeError if a shader could not be read from file, or if a
+ * program object could not be created.
+ *
+ * @return Batch of programs being built.
+ */
+abcg::OpenGLProgramBatch abcg::triggerOpenGLProgramsBuild(
+    std::vector<std::vector<ShaderSource>> const &pathsOrSources) {
+  [[maybe_unused]] auto const parallel{isParallelShaderCompileSupported()};
+
+  OpenGLProgramBatch batch;
+  batch.programs.resize(pathsOrSources.size());
+  batch.shaders.resize(pathsOrSources.size());
+  batch.cachePaths.resize(pathsOrSources.size());
+
+  // Submit the compilation of all shaders
+  for (auto const index : iter::range(pathsOrSources.size())) {
+    std::vector<ShaderSource> sources;
+    sources.reserve(pathsOrSources.at(index).size());
+    for (auto const &pathOrSource : pathsOrSources.at(index)) {
+      sources.push_back({.source = toSource(pathOrSource.source),
+                         .stage = pathOrSource.stage});
+    }
+
+    auto const cachePath{programCachePath(sources)};
+    if (!cachePath.empty()) {
+      if (auto const program{loadProgramBinary(cachePath)}; program != 0) {
+        batch.programs.at(index) = program;
+        continue;
+      }
+      batch.cachePaths.at(index) = cachePath.string();
+    }
+
+    auto &shaders{batch.shaders.at(index)};
+    shaders.reserve(sources.size());
+    for (auto const &source : sources) {
+      shaders.push_back(
+          compileHelper(source.source, abcgStageToOpenGLStage(source.stage)));
+    }
+  }
+
+  // Submit the linking of all programs
+  for (auto const index : iter::range(pathsOrSources.size())) {
+    auto const &shaders{batch.shaders.at(index)};
+    if (shaders.empty())
+      continue;
+
+    auto const program{glCreateProgram()};
+    if (program == 0) {
+      deleteProgramBatch(batch);
+      throw abcg::RuntimeError("Failed to create program");
+    }
+    batch.programs.at(index) = program;
+
+    for (auto const &shader : shaders) {
+      glAttachShader(program, shader.shader);
+    }
+    if (!batch.cachePaths.at(index).empty()) {
+      glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                          GL_TRUE);
+    }
+    glLinkProgram(program);
+  }
+
+  return batch;
+}
+
+/**
+ * @brief Returns whether the build of a group of programs has completed.
+ *
+ * This function does not block if `GL_KHR_parallel_shader_compile` (or its ARB
+ * variant) is available. Otherwise, it always returns `true`, and the build
+ * will be completed by abcg::checkOpenGLProgramsBuild.
+ *
+ * @param batch Batch returned by abcg::triggerOpenGLProgramsBuild.
+ *
+ * @return `true` if abcg::checkOpenGLProgramsBuild can be called without
+ * waiting for the driver; `false` otherwise.
+ */
+bool abcg::isOpenGLProgramsBuildComplete(
+    [[maybe_unused]] OpenGLProgramBatch const &batch) {
+#if !defined(__EMSCRIPTEN__) && defined(GL_COMPLETION_STATUS_KHR)
+  if (!isParallelShaderCompileSupported())
+    return true;
+
+  for (auto &&[program, shaders] : iter::zip(batch.programs, batch.shaders)) {
+    if (shaders.empty())
+      continue;
+    GLint completionStatus{};
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completionStatus);
+    if (completionStatus == GL_FALSE)
+      return false;
+  }
+#endif
+  return true;
+}
+
+/**
+ * @brief Queries the compile and link status of a group of programs.
+ *
+ * This should be called after abcg::triggerOpenGLProgramsBuild. The function
+ * waits until all programs are built. Shader objects are released, and the
+ * binaries of the new programs are saved to the program binary cache, if
+ * enabled.
+ *
+ * @param batch Batch returned by abcg::triggerOpenGLProgramsBuild.
+ * @param throwOnError Whether to throw exceptions on compile/link errors.
+ *
+ * @throw abcg::RuntimeError if the compilation of any shader failed, or if the
+ * linking of any program failed. In that case, all programs of the batch are
+ * deleted.
+ *
+ * @return IDs of the program objects. An ID is 0 if the corresponding program
+ * failed to build.
+ */
+std::vector<GLuint>
+abcg::checkOpenGLProgramsBuild(OpenGLProgramBatch &batch, bool throwOnError) {
+  for (auto &&[program, shaders, cachePath] :
+       iter::zip(batch.programs, batch.shaders, batch.cachePaths)) {
+    if (shaders.empty())
+      continue;
+
+    GLint linkStatus{};
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE) {
+      // Find out whether the failure happened at compile or link time
+      std::string error{"Failed to link program"};
+      for (auto const &shader : shaders) {
+        GLint compileStatus{};
+        glGetShaderiv(shader.shader, GL_COMPILE_STATUS, &compileStatus);
+        if (compileStatus == GL_FALSE) {
+          auto const *shaderStage{shaderStageToText(shader.stage)};
+          if (throwOnError) {
+            fmt::print("\n");
+            printShaderInfoLog(shader.shader, shaderStage);
+          }
+          error = fmt::format("Failed to compile {} shader", shaderStage);
+          break;
+        }
+      }
+      if (throwOnError) {
+        if (error.starts_with("Failed to link")) {
+          fmt::print("\n");
+          printProgramInfoLog(program);
+        }
+        deleteProgramBatch(batch);
+        throw abcg::RuntimeError(error);
+      }
+      deleteShaders(shaders);
+      shaders.clear();
+      glDeleteProgram(program);
+      program = 0;
+      continue;
+    }
+
+    for (auto const &shader : shaders) {
+      glDetachShader(program, shader.shader);
+    }
+    deleteShaders(shaders);
+    shaders.clear();
+
+    if (!cachePath.empty()) {
+      saveProgramBinary(program, cachePath);
+    }
+  }
+
+  return batch.programs;
+}
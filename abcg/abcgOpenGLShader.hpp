@@ -14,11 +14,14 @@
 #include "abcgOpenGLExternal.hpp"
 #include "abcgShader.hpp"
 
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace abcg {
 struct OpenGLShader;
-}
+struct OpenGLProgramBatch;
+} // namespace abcg
 
 /**
  * @brief OpenGL shader object and its corresponding stage.
@@ -30,7 +33,24 @@ struct abcg::OpenGLShader {
   GLuint stage{};
 };
 
+/**
+ * @brief Group of OpenGL programs being built together.
+ *
+ * @sa abcg::triggerOpenGLProgramsBuild.
+ */
+struct abcg::OpenGLProgramBatch {
+  /** @brief Program objects, one for each group of shaders. */
+  std::vector<GLuint> programs;
+  /** @brief Shader objects attached to each program. This is empty for
+   * programs loaded from the program binary cache. */
+  std::vector<std::vector<OpenGLShader>> shaders;
+  /** @brief Path of the program binary cache file of each program, or an empty
+   * string if the program does not need to be saved to the cache. */
+  std::vector<std::string> cachePaths;
+};
+
 namespace abcg {
+void setOpenGLProgramCacheDirectory(std::string_view directory);
 [[nodiscard]] GLuint
 createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
                     bool throwOnError = true);
@@ -41,6 +61,14 @@ bool checkOpenGLShaderCompile(std::vector<OpenGLShader> const &shaders,
 GLuint triggerOpenGLShaderLink(std::vector<OpenGLShader> const &shaders,
                                bool throwOnError = true);
 bool checkOpenGLShaderLink(GLuint shaderProgram, bool throwOnError = true);
+[[nodiscard]] std::vector<GLuint> createOpenGLPrograms(
+    std::vector<std::vector<ShaderSource>> const &pathsOrSources,
+    bool throwOnError = true);
+[[nodiscard]] OpenGLProgramBatch triggerOpenGLProgramsBuild(
+    std::vector<std::vector<ShaderSource>> const &pathsOrSources);
+[[nodiscard]] bool isOpenGLProgramsBuildComplete(OpenGLProgramBatch const &batch);
+[[nodiscard]] std::vector<GLuint>
+checkOpenGLProgramsBuild(OpenGLProgramBatch &batch, bool throwOnError = true);
 } // namespace abcg
 
 #endif
@@ -0,0 +1,196 @@
+/**
+ * @file abcgOpenGLStreamBuffer.cpp
+ * @brief Definition of abcg::OpenGLStreamBuffer members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLStreamBuffer.hpp"
+
+#include <algorithm>
+
+#include "abcgExternal.hpp"
+#include "abcgOpenGLFunction.hpp"
+
+/**
+ * @brief Creates the buffer object.
+ *
+ * @param target Target to which the buffer object is bound while it is
+ * written (e.g., `GL_ARRAY_BUFFER`).
+ * @param size Maximum size of the data written between a call to
+ * abcg::OpenGLStreamBuffer::map and abcg::OpenGLStreamBuffer::unmap, in bytes.
+ * Offsets returned by abcg::OpenGLStreamBuffer::unmap are multiples of this
+ * size, so use a multiple of the size of the elements.
+ * @param ringSize Number of slots of the persistently mapped ring. This should
+ * be at least the number of calls to abcg::OpenGLStreamBuffer::map that can be
+ * in flight, i.e., the number of frames the GPU can lag behind the CPU times
+ * the number of calls per frame.
+ */
+void abcg::OpenGLStreamBuffer::create(GLenum target, std::size_t size,
+                                      std::size_t ringSize) {
+  destroy();
+
+  m_target = target;
+  m_slotSize = std::max(size, std::size_t{1});
+  m_written = false;
+
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(m_target, m_buffer);
+
+#if !defined(__EMSCRIPTEN__)
+  // Desktop-only functions without an abcg wrapper
+  if (GLEW_ARB_buffer_storage == GL_TRUE) {
+    m_fenceRing.create(ringSize);
+    auto const bufferSize{
+        gsl::narrow<GLsizeiptr>(m_slotSize * m_fenceRing.size())};
+    GLbitfield const flags{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                           GL_MAP_COHERENT_BIT};
+    glBufferStorage(m_target, bufferSize, nullptr, flags);
+    m_persistent = static_cast<std::byte *>(
+        glMapBufferRange(m_target, 0, bufferSize, flags));
+    if (m_persistent == nullptr) {
+      // Recreate the buffer, as the storage of the first one is immutable
+      m_fenceRing.destroy();
+      glBindBuffer(m_target, 0);
+      glDeleteBuffers(1, &m_buffer);
+      glGenBuffers(1, &m_buffer);
+      glBindBuffer(m_target, m_buffer);
+    }
+  }
+#endif
+
+  if (m_persistent == nullptr) {
+    glBufferData(m_target, gsl::narrow<GLsizeiptr>(m_slotSize), nullptr,
+                 GL_STREAM_DRAW);
+  }
+  glBindBuffer(m_target, 0);
+}
+
+/**
+ * @brief Releases the buffer object and the fence sync objects.
+ */
+void abcg::OpenGLStreamBuffer::destroy() {
+  m_fenceRing.destroy();
+  if (m_buffer != 0) {
+    if (m_persistent != nullptr || m_mapped != nullptr) {
+      glBindBuffer(m_target, m_buffer);
+      glUnmapBuffer(m_target);
+      glBindBuffer(m_target, 0);
+    }
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+  }
+  m_persistent = nullptr;
+  m_mapped = nullptr;
+  m_mappedSize = 0;
+  m_staging.clear();
+}
+
+/**
+ * @brief Returns memory to be written with data for the buffer.
+ *
+ * With a persistently mapped buffer, this waits until the GPU has finished
+ * reading the next slot of the ring, which only happens if more than
+ * `ringSize` calls are in flight.
+ *
+ * @param size Size of the data, in bytes. It must not be larger than the size
+ * given to abcg::OpenGLStreamBuffer::create.
+ *
+ * @return Memory of the given size. It is valid until the call to
+ * abcg::OpenGLStreamBuffer::unmap and must only be written.
+ */
+std::span<std::byte> abcg::OpenGLStreamBuffer::map(std::size_t size) {
+  Expects(size <= m_slotSize);
+
+  if (m_persistent != nullptr) {
+    if (m_written) {
+      // Protect the current slot until the GPU is done with the commands
+      // issued since it was written
+      m_fenceRing.advance();
+    }
+    m_written = true;
+
+    // Wait until the GPU has finished reading the next slot
+    m_fenceRing.waitForCurrent();
+
+    return {m_persistent + m_fenceRing.getCurrentSlot() * m_slotSize, size};
+  }
+
+  // Orphan the storage that the GPU may still be reading
+  glBindBuffer(m_target, m_buffer);
+  glBufferData(m_target, gsl::narrow<GLsizeiptr>(m_slotSize), nullptr,
+               GL_STREAM_DRAW);
+  m_mappedSize = size;
+
+#if !defined(__EMSCRIPTEN__)
+  if (size > 0) {
+    m_mapped = static_cast<std::byte *>(
+        glMapBufferRange(m_target, 0, gsl::narrow<GLsizeiptr>(size),
+                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  }
+  if (m_mapped != nullptr) {
+    glBindBuffer(m_target, 0);
+    return {m_mapped, size};
+  }
+#endif
+
+  // WebGL does not support buffer mapping, so write to client memory instead
+  glBindBuffer(m_target, 0);
+  m_staging.resize(size);
+  return m_staging;
+}
+
+/**
+ * @brief Finishes writing the data returned by abcg::OpenGLStreamBuffer::map.
+ *
+ * @return Offset of the data in the buffer object, in bytes.
+ */
+std::size_t abcg::OpenGLStreamBuffer::unmap() {
+  if (m_persistent != nullptr) {
+    // The mapping is coherent, so the data is visible to subsequent commands
+    return m_fenceRing.getCurrentSlot() * m_slotSize;
+  }
+
+  glBindBuffer(m_target, m_buffer);
+  if (m_mapped != nullptr) {
+    m_mapped = nullptr;
+    // If this fails (e.g., after a change of screen mode), the contents are
+    // undefined until the next call to map
+    glUnmapBuffer(m_target);
+  } else if (m_mappedSize > 0) {
+    glBufferSubData(m_target, 0, gsl::narrow<GLsizeiptr>(m_mappedSize),
+                    m_staging.data());
+  }
+  glBindBuffer(m_target, 0);
+  m_mappedSize = 0;
+  return 0;
+}
+
+/**
+ * @brief Binds the buffer object to its target.
+ */
+void abcg::OpenGLStreamBuffer::bind() const {
+  glBindBuffer(m_target, m_buffer);
+}
+
+/**
+ * @brief Returns the name of the buffer object.
+ *
+ * @return Name of the buffer object.
+ */
+GLuint abcg::OpenGLStreamBuffer::getBuffer() const noexcept {
+  return m_buffer;
+}
+
+/**
+ * @brief Returns whether the buffer is a persistently mapped ring.
+ *
+ * @return `true` if the buffer is persistently mapped, or `false` if it is
+ * orphaned on each call to abcg::OpenGLStreamBuffer::map.
+ */
+bool abcg::OpenGLStreamBuffer::isPersistent() const noexcept {
+  return m_persistent != nullptr;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file abcgOpenGLStreamBuffer.hpp
+ * @brief Header file of abcg::OpenGLStreamBuffer.
+ *
+ * Declaration of abcg::OpenGLStreamBuffer.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_STREAM_BUFFER_HPP_
+#define ABCG_OPENGL_STREAM_BUFFER_HPP_
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "abcgOpenGLExternal.hpp"
+#include "abcgOpenGLFenceRing.hpp"
+
+namespace abcg {
+class OpenGLStreamBuffer;
+} // namespace abcg
+
+/**
+ * @brief A class for representing a buffer object whose contents are written
+ * by the CPU every frame (e.g., vertices generated on the fly).
+ *
+ * Data is written between calls to abcg::OpenGLStreamBuffer::map and
+ * abcg::OpenGLStreamBuffer::unmap, which returns the offset of the data in the
+ * buffer:
+ * @code
+ * auto const vertices{streamBuffer.map<Vertex>(count)};
+ * ... // Write to vertices
+ * auto const first{streamBuffer.unmap() / sizeof(Vertex)};
+ * glDrawArrays(GL_POINTS, gsl::narrow<GLint>(first), count);
+ * @endcode
+ *
+ * If `GL_ARB_buffer_storage` is supported, the buffer is a ring of slots that
+ * stays persistently mapped. Each call to abcg::OpenGLStreamBuffer::map
+ * returns the next slot, and slots that may still be read by the GPU are
+ * protected with fence sync objects, as in abcg::OpenGLUniformBuffer.
+ * Otherwise, the buffer is orphaned on each call to
+ * abcg::OpenGLStreamBuffer::map, so the driver can allocate new storage
+ * instead of waiting for the GPU, and the offset is always zero. On WebGL, the
+ * data is written to client memory and uploaded with `glBufferSubData`.
+ *
+ * Since the buffer object never changes, it can be bound to a vertex array
+ * object once.
+ */
+class abcg::OpenGLStreamBuffer {
+public:
+  void create(GLenum target, std::size_t size, std::size_t ringSize = 3);
+  void destroy();
+
+  [[nodiscard]] std::span<std::byte> map(std::size_t size);
+
+  /**
+   * @brief Returns an array to be written with data for the buffer.
+   *
+   * @tparam T Type of the elements. It must be trivially copyable.
+   *
+   * @param count Number of elements.
+   *
+   * @return Array of elements. It is valid until the call to
+   * abcg::OpenGLStreamBuffer::unmap.
+   */
+  template <typename T> [[nodiscard]] std::span<T> map(std::size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Stream buffer elements must be trivially copyable");
+    auto const bytes{map(count * sizeof(T))};
+    return {reinterpret_cast<T *>(bytes.data()), count};
+  }
+
+  std::size_t unmap();
+
+  void bind() const;
+
+  [[nodiscard]] GLuint getBuffer() const noexcept;
+  [[nodiscard]] bool isPersistent() const noexcept;
+
+private:
+  GLenum m_target{GL_ARRAY_BUFFER};
+  GLuint m_buffer{};
+  std::size_t m_slotSize{};
+  bool m_written{};
+  OpenGLFenceRing m_fenceRing;
+
+  // Start of the persistently mapped ring, if supported
+  std::byte *m_persistent{};
+
+  // Data being written with the orphaning fallback
+  std::byte *m_mapped{};
+  std::size_t m_mappedSize{};
+  std::vector<std::byte> m_staging;
+};
+
+#endif
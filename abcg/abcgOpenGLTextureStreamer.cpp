@@ -0,0 +1,332 @@
+/**
+ * @file abcgOpenGLTextureStreamer.cpp
+ * @brief Definition of abcg::OpenGLTextureStreamer members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLTextureStreamer.hpp"
+
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+
+#include "abcgException.hpp"
+#include "abcgImage.hpp"
+#include "abcgOpenGLFunction.hpp"
+#include "abcgThreadPool.hpp"
+
+/**
+ * @brief Creates the pixel unpack buffer used for uploads.
+ *
+ * @param slotCount Number of slots of the ring.
+ * @param slotSize Size of each slot, in bytes. This is the maximum amount of
+ * pixel data uploaded by each call to abcg::OpenGLTextureStreamer::update.
+ * @param threadPool Pool of worker threads used for decoding the images. If
+ * null, abcg::ThreadPool::getDefault is used.
+ */
+void abcg::OpenGLTextureStreamer::create(std::size_t slotCount,
+                                         std::size_t slotSize,
+                                         ThreadPool *threadPool) {
+  destroy();
+
+  m_threadPool = threadPool;
+  m_slotSize = std::max(slotSize, std::size_t{1});
+  m_fenceRing.create(slotCount);
+
+#if !defined(__EMSCRIPTEN__)
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+  glBufferData(GL_PIXEL_UNPACK_BUFFER,
+               gsl::narrow<GLsizeiptr>(m_slotSize * m_fenceRing.size()),
+               nullptr, GL_STREAM_DRAW);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+#endif
+}
+
+/**
+ * @brief Waits for the pending decodes and releases the pixel unpack buffer.
+ *
+ * Pending requests are discarded. Their textures are not deleted and keep the
+ * placeholder or partially uploaded contents.
+ */
+void abcg::OpenGLTextureStreamer::destroy() {
+  for (auto &request : m_requests) {
+    if (request.decoded.valid()) {
+      request.decoded.wait();
+    }
+  }
+  m_requests.clear();
+
+  m_fenceRing.destroy();
+  if (m_buffer != 0) {
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+  }
+}
+
+/**
+ * @brief Starts loading a 2D texture from an image file.
+ *
+ * The image is decoded by a worker thread. Its pixels are then uploaded by
+ * subsequent calls to abcg::OpenGLTextureStreamer::update.
+ *
+ * Before deleting the texture, call abcg::OpenGLTextureStreamer::cancel if the
+ * upload may not be complete.
+ *
+ * @param createInfo Texture creation settings.
+ * @param onLoaded Function to be called by abcg::OpenGLTextureStreamer::update
+ * when the texture is completely uploaded.
+ *
+ * @return ID of the texture, as generated by glGenTextures. Until the upload is
+ * complete, the texture contains a 1x1 white image.
+ */
+GLuint abcg::OpenGLTextureStreamer::load(
+    OpenGLTextureCreateInfo const &createInfo, Callback onLoaded) {
+  GLuint texture{};
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  std::array<GLubyte, 4> const placeholder{255, 255, 255, 255};
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               placeholder.data());
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  auto &threadPool{m_threadPool == nullptr ? ThreadPool::getDefault()
+                                           : *m_threadPool};
+  auto decoded{threadPool.submit(
+      [path = std::string{createInfo.path},
+       flipUpsideDown = createInfo.flipUpsideDown,
+       sRGBToLinear = createInfo.sRGBToLinear] {
+        return decode(path, flipUpsideDown, sRGBToLinear);
+      })};
+
+  m_requests.push_back({.texture = texture,
+                        .generateMipmaps = createInfo.generateMipmaps,
+                        .onLoaded = std::move(onLoaded),
+                        .decoded = std::move(decoded),
+                        .image = {},
+                        .isDecoded = false,
+                        .uploadedRows = 0});
+
+  return texture;
+}
+
+/**
+ * @brief Uploads pending pixel data.
+ *
+ * This must be called once per frame with the OpenGL context current. At most
+ * one slot of the ring is uploaded per call. Completion callbacks are called
+ * from this function.
+ *
+ * @throw abcg::RuntimeError if an image could not be loaded. The corresponding
+ * request is discarded, and its texture keeps the placeholder image.
+ */
+void abcg::OpenGLTextureStreamer::update() {
+  // Find the first request that is being uploaded or has finished decoding
+  auto const iter{std::ranges::find_if(m_requests, [](auto const &request) {
+    return request.isDecoded ||
+           request.decoded.wait_for(std::chrono::seconds{0}) ==
+               std::future_status::ready;
+  })};
+  if (iter == m_requests.end())
+    return;
+
+  auto &request{*iter};
+  if (!request.isDecoded) {
+    try {
+      request.image = request.decoded.get();
+    } catch (...) {
+      m_requests.erase(iter);
+      throw;
+    }
+    request.isDecoded = true;
+
+    // Replace the placeholder with the storage of the final image
+    auto const &image{request.image};
+    glBindTexture(GL_TEXTURE_2D, request.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, gsl::narrow<GLint>(image.internalFormat),
+                 image.width, image.height, 0, image.format, GL_UNSIGNED_BYTE,
+                 nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  if (uploadRows(request)) {
+    finalize(request);
+    auto const texture{request.texture};
+    auto const onLoaded{std::move(request.onLoaded)};
+    m_requests.erase(iter);
+    if (onLoaded) {
+      onLoaded(texture);
+    }
+  }
+}
+
+/**
+ * @brief Discards the pending request of a texture.
+ *
+ * The texture is not deleted and keeps the contents uploaded so far. This
+ * must be called before deleting a texture returned by
+ * abcg::OpenGLTextureStreamer::load whose upload may not be complete, as
+ * OpenGL can reuse the name for a texture created afterwards. Its completion
+ * callback is not called.
+ *
+ * @param texture ID of a texture returned by abcg::OpenGLTextureStreamer::load.
+ * Nothing is done if the texture has no pending request.
+ */
+void abcg::OpenGLTextureStreamer::cancel(GLuint texture) {
+  // A decode still running in a worker thread only writes to its own future,
+  // so it does not need to be waited for
+  std::erase_if(m_requests, [texture](auto const &request) {
+    return request.texture == texture;
+  });
+}
+
+/**
+ * @brief Returns whether a texture is completely loaded.
+ *
+ * @param texture ID of a texture returned by abcg::OpenGLTextureStreamer::load.
+ *
+ * @return `false` if the texture is still being loaded; `true` otherwise.
+ */
+bool abcg::OpenGLTextureStreamer::isLoaded(GLuint texture) const {
+  return std::ranges::none_of(m_requests, [texture](auto const &request) {
+    return request.texture == texture;
+  });
+}
+
+/**
+ * @brief Returns the number of textures still being loaded.
+ *
+ * @return Number of pending requests.
+ */
+std::size_t abcg::OpenGLTextureStreamer::getPendingCount() const noexcept {
+  return m_requests.size();
+}
+
+// Loads an image file and converts it to RGB or RGBA rows aligned to 4 bytes.
+// This is called from a worker thread and must not call OpenGL functions.
+abcg::OpenGLTextureStreamer::Image
+abcg::OpenGLTextureStreamer::decode(std::string const &path,
+                                    bool flipUpsideDown, bool sRGBToLinear) {
+  SDL_Surface *const surface{IMG_Load(path.c_str())};
+  if (surface == nullptr) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to load texture file {}", path));
+  }
+
+  auto const freeSurface{
+      gsl::finally([surface] { SDL_FreeSurface(surface); })};
+
+  // Enforce RGB/RGBA
+  auto const hasAlpha{surface->format->BytesPerPixel != 3};
+  Image image{.width = surface->w,
+              .height = surface->h,
+              .format = hasAlpha ? GLenum{GL_RGBA} : GLenum{GL_RGB},
+              .internalFormat = {},
+              .rowSize = {},
+              .pixels = {}};
+  if (sRGBToLinear) {
+    image.internalFormat = hasAlpha ? GL_SRGB8_ALPHA8 : GL_SRGB8;
+  } else {
+    image.internalFormat = hasAlpha ? GL_RGBA : GL_RGB;
+  }
+
+  // Convert and flip upside down in a single pass
+  image.rowSize = convertSurface(*surface,
+                                 {.bytesPerPixel = hasAlpha ? 4 : 3,
+                                  .flipVertically = flipUpsideDown},
+                                 image.pixels);
+
+  return image;
+}
+
+// Uploads the next rows of a decoded image. Returns true if all rows were
+// uploaded.
+bool abcg::OpenGLTextureStreamer::uploadRows(Request &request) {
+  auto const &image{request.image};
+  auto const rowSize{image.rowSize};
+  auto const firstRow{request.uploadedRows};
+  auto rowCount{image.height - firstRow};
+  void const *pixels{image.pixels.data() +
+                     rowSize * gsl::narrow<std::size_t>(firstRow)};
+
+  glBindTexture(GL_TEXTURE_2D, request.texture);
+
+#if !defined(__EMSCRIPTEN__)
+  auto usesBuffer{false};
+  if (m_buffer != 0 && rowSize <= m_slotSize) {
+    // Wait until the GPU has finished reading the slot
+    m_fenceRing.waitForCurrent();
+
+    // Copy as many rows as the slot can hold
+    rowCount = std::min(rowCount, gsl::narrow<GLsizei>(m_slotSize / rowSize));
+    auto const size{rowSize * gsl::narrow<std::size_t>(rowCount)};
+    auto const offset{m_fenceRing.getCurrentSlot() * m_slotSize};
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+    if (auto *mapped{glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER, gsl::narrow<GLintptr>(offset),
+            gsl::narrow<GLsizeiptr>(size),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                GL_MAP_UNSYNCHRONIZED_BIT)};
+        mapped != nullptr) {
+      std::memcpy(mapped, pixels, size);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      // NOLINTNEXTLINE(performance-no-int-to-ptr)
+      pixels = reinterpret_cast<void const *>(offset);
+      usesBuffer = true;
+    } else {
+      // Upload from client memory instead
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+  }
+#endif
+
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, image.width, rowCount,
+                  image.format, GL_UNSIGNED_BYTE, pixels);
+  request.uploadedRows += rowCount;
+
+#if !defined(__EMSCRIPTEN__)
+  if (usesBuffer) {
+    m_fenceRing.advance();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+#endif
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  return request.uploadedRows == image.height;
+}
+
+// Sets the filtering and wrapping parameters of a completely uploaded texture,
+// as in abcg::loadOpenGLTexture
+void abcg::OpenGLTextureStreamer::finalize(Request const &request) {
+  glBindTexture(GL_TEXTURE_2D, request.texture);
+
+  // Set texture filtering
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  // Generate the mipmap levels
+  if (request.generateMipmaps) {
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    // Override minifying filtering
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    GL_LINEAR_MIPMAP_LINEAR);
+  }
+
+  // Set texture wrapping
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file abcgOpenGLTextureStreamer.hpp
+ * @brief Header file of abcg::OpenGLTextureStreamer.
+ *
+ * Declaration of abcg::OpenGLTextureStreamer.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_TEXTURE_STREAMER_HPP_
+#define ABCG_OPENGL_TEXTURE_STREAMER_HPP_
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "abcgOpenGLExternal.hpp"
+#include "abcgOpenGLFenceRing.hpp"
+#include "abcgOpenGLImage.hpp"
+
+namespace abcg {
+class OpenGLTextureStreamer;
+class ThreadPool;
+} // namespace abcg
+
+/**
+ * @brief A class for loading 2D textures asynchronously.
+ *
+ * abcg::OpenGLTextureStreamer::load returns a texture immediately. The texture
+ * contains a 1x1 white placeholder until the image is decoded by a worker
+ * thread and uploaded by abcg::OpenGLTextureStreamer::update, which must be
+ * called once per frame from the thread that owns the OpenGL context.
+ *
+ * The upload goes through a ring of slots of a persistent pixel unpack buffer.
+ * Each call to abcg::OpenGLTextureStreamer::update copies at most one slot of
+ * pixel data, so large images are uploaded over several frames instead of
+ * stalling a single frame. Fence sync objects guarantee that a slot is not
+ * overwritten while the GPU is still reading it.
+ *
+ * Textures are not usable until they are completely uploaded. Use the
+ * completion callback, abcg::OpenGLTextureStreamer::isLoaded or
+ * abcg::OpenGLTextureStreamer::getPendingCount to check for completion. Call
+ * abcg::OpenGLTextureStreamer::cancel before deleting a texture that may still
+ * be loading, as OpenGL may reuse its name for the next texture.
+ *
+ * @remark In WebGL, the pixel data is uploaded directly from client memory in
+ * a single call.
+ */
+class abcg::OpenGLTextureStreamer {
+public:
+  /** @brief Function called when a texture is completely uploaded. */
+  using Callback = std::function<void(GLuint texture)>;
+
+  void create(std::size_t slotCount = 3, std::size_t slotSize = 4 << 20,
+              ThreadPool *threadPool = nullptr);
+  void destroy();
+
+  [[nodiscard]] GLuint load(OpenGLTextureCreateInfo const &createInfo,
+                            Callback onLoaded = {});
+  void update();
+  void cancel(GLuint texture);
+
+  [[nodiscard]] bool isLoaded(GLuint texture) const;
+  [[nodiscard]] std::size_t getPendingCount() const noexcept;
+
+private:
+  // Decoded image with rows aligned to 4 bytes, as expected by the default
+  // GL_UNPACK_ALIGNMENT
+  struct Image {
+    GLsizei width{};
+    GLsizei height{};
+    GLenum format{};
+    GLenum internalFormat{};
+    std::size_t rowSize{};
+    std::vector<std::byte> pixels;
+  };
+
+  struct Request {
+    GLuint texture{};
+    bool generateMipmaps{};
+    Callback onLoaded;
+    std::future<Image> decoded;
+    Image image;
+    bool isDecoded{};
+    GLsizei uploadedRows{};
+  };
+
+  [[nodiscard]] static Image decode(std::string const &path,
+                                    bool flipUpsideDown, bool sRGBToLinear);
+  [[nodiscard]] bool uploadRows(Request &request);
+  static void finalize(Request const &request);
+
+  ThreadPool *m_threadPool{};
+  std::deque<Request> m_requests;
+
+  GLuint m_buffer{};
+  std::size_t m_slotSize{};
+  OpenGLFenceRing m_fenceRing;
+};
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * @file abcgOpenGLUniformBuffer.cpp
+ * @brief Definition of abcg::OpenGLUniformBuffer members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLUniformBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "abcgException.hpp"
+#include "abcgOpenGLFunction.hpp"
+
+/**
+ * @brief Creates the uniform buffer object.
+ *
+ * @param bindingPoint Index of the uniform buffer binding point. Programs must
+ * associate their uniform block with the same index.
+ * @param blockSize Size of the uniform block, in bytes.
+ * @param ringSize Number of slots of the ring. This should be at least the
+ * number of calls to abcg::OpenGLUniformBuffer::update that can be in flight,
+ * i.e., the number of updates per frame times the number of frames the GPU can
+ * lag behind the CPU.
+ *
+ * @throw abcg::RuntimeError if the block is larger than
+ * `GL_MAX_UNIFORM_BLOCK_SIZE`.
+ */
+void abcg::OpenGLUniformBuffer::create(GLuint bindingPoint,
+                                       std::size_t blockSize,
+                                       std::size_t ringSize) {
+  destroy();
+
+  GLint maxBlockSize{};
+  glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize);
+  if (blockSize > gsl::narrow<std::size_t>(maxBlockSize)) {
+    throw abcg::RuntimeError(
+        fmt::format("Uniform block size ({} bytes) exceeds the maximum of {}",
+                    blockSize, maxBlockSize));
+  }
+
+  // Each slot starts at a multiple of the offset alignment
+  GLint offsetAlignment{};
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+  auto const alignment{gsl::narrow<std::size_t>(std::max(offsetAlignment, 1))};
+
+  m_bindingPoint = bindingPoint;
+  m_blockSize = blockSize;
+  m_slotSize = (blockSize + alignment - 1) / alignment * alignment;
+  m_written = false;
+  m_fenceRing.create(ringSize);
+
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+  glBufferData(GL_UNIFORM_BUFFER,
+               gsl::narrow<GLsizeiptr>(m_slotSize * m_fenceRing.size()),
+               nullptr,
+               GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/**
+ * @brief Releases the buffer object and the fence sync objects.
+ */
+void abcg::OpenGLUniformBuffer::destroy() {
+  m_fenceRing.destroy();
+  if (m_buffer != 0) {
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+  }
+}
+
+/**
+ * @brief Writes a block to the next slot of the ring and binds it.
+ *
+ * The slot is bound to the binding point with `glBindBufferRange`, so
+ * subsequent draw calls read the new data.
+ *
+ * @param data Pointer to the block data.
+ * @param size Size of the data, in bytes. It must not be larger than the block
+ * size given to abcg::OpenGLUniformBuffer::create.
+ */
+void abcg::OpenGLUniformBuffer::update(void const *data, std::size_t size) {
+  Expects(size <= m_blockSize);
+
+  if (m_written) {
+    // Protect the current slot until the GPU is done with the commands issued
+    // since it was bound
+    m_fenceRing.advance();
+  }
+  m_written = true;
+
+  // Wait until the GPU has finished reading the next slot
+  m_fenceRing.waitForCurrent();
+
+  auto const offset{
+      gsl::narrow<GLintptr>(m_fenceRing.getCurrentSlot() * m_slotSize)};
+
+  glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+#if defined(__EMSCRIPTEN__)
+  // WebGL does not support buffer mapping
+  glBufferSubData(GL_UNIFORM_BUFFER, offset, gsl::narrow<GLsizeiptr>(size),
+                  data);
+#else
+  // The fence guarantees that the range is not in use
+  if (auto *mapped{glMapBufferRange(
+          GL_UNIFORM_BUFFER, offset, gsl::narrow<GLsizeiptr>(size),
+          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+              GL_MAP_UNSYNCHRONIZED_BIT)};
+      mapped != nullptr) {
+    std::memcpy(mapped, data, size);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+  }
+#endif
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  glBindBufferRange(GL_UNIFORM_BUFFER, m_bindingPoint, m_buffer, offset,
+                    gsl::narrow<GLsizeiptr>(m_blockSize));
+}
+
+/**
+ * @brief Returns the index of the uniform buffer binding point.
+ *
+ * @return Index of the binding point given to
+ * abcg::OpenGLUniformBuffer::create.
+ */
+GLuint abcg::OpenGLUniformBuffer::getBindingPoint() const noexcept {
+  return m_bindingPoint;
+}
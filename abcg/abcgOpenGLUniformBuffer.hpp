@@ -0,0 +1,144 @@
+/**
+ * @file abcgOpenGLUniformBuffer.hpp
+ * @brief Header file of abcg::OpenGLUniformBuffer.
+ *
+ * Declaration of abcg::OpenGLUniformBuffer and of the helpers for checking the
+ * std140 layout of uniform block structures.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_UNIFORM_BUFFER_HPP_
+#define ABCG_OPENGL_UNIFORM_BUFFER_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include "abcgExternal.hpp"
+#include "abcgOpenGLExternal.hpp"
+#include "abcgOpenGLFenceRing.hpp"
+
+namespace abcg {
+class OpenGLUniformBuffer;
+
+/**
+ * @brief Base alignment of a type in the std140 layout.
+ *
+ * Only types whose size and alignment in C++ match the std140 layout are
+ * supported: scalars, two-, three- and four-component vectors, `mat4`, and
+ * arrays of 16-byte multiples (e.g., `std::array<glm::vec4, N>`). Using any
+ * other type (e.g., `glm::mat3` or `std::array<float, N>`, which have a
+ * different stride in std140) results in a compile-time error.
+ *
+ * @tparam T Type of the block member.
+ */
+template <typename T> constexpr std::size_t std140Alignment{[] {
+  static_assert(!std::is_same_v<T, T>,
+                "Type not supported in a std140 uniform block");
+  return std::size_t{};
+}()};
+
+// @cond Skipped by Doxygen
+template <> constexpr std::size_t std140Alignment<float>{4};
+template <> constexpr std::size_t std140Alignment<int>{4};
+template <> constexpr std::size_t std140Alignment<unsigned int>{4};
+template <> constexpr std::size_t std140Alignment<glm::vec2>{8};
+template <> constexpr std::size_t std140Alignment<glm::ivec2>{8};
+template <> constexpr std::size_t std140Alignment<glm::uvec2>{8};
+template <> constexpr std::size_t std140Alignment<glm::vec3>{16};
+template <> constexpr std::size_t std140Alignment<glm::ivec3>{16};
+template <> constexpr std::size_t std140Alignment<glm::uvec3>{16};
+template <> constexpr std::size_t std140Alignment<glm::vec4>{16};
+template <> constexpr std::size_t std140Alignment<glm::ivec4>{16};
+template <> constexpr std::size_t std140Alignment<glm::uvec4>{16};
+template <> constexpr std::size_t std140Alignment<glm::mat4>{16};
+
+template <typename T, std::size_t N>
+constexpr std::size_t std140Alignment<std::array<T, N>>{[] {
+  static_assert(sizeof(T) % 16 == 0,
+                "The stride of std140 arrays is a multiple of 16 bytes");
+  return std::max(std140Alignment<T>, std::size_t{16});
+}()};
+// @endcond
+} // namespace abcg
+
+/**
+ * @brief Checks at compile time that a member of a uniform block structure is
+ * at the same offset as in the std140 layout.
+ *
+ * Since the alignment of the supported types in C++ is never greater than their
+ * std140 base alignment, the C++ offset of a member matches the std140 offset
+ * if and only if it is a multiple of the std140 base alignment. Use `alignas`
+ * to fix mismatches. For example:
+ * @code
+ * struct LightData {
+ *   float intensity;
+ *   alignas(16) glm::vec3 direction; // Would be at offset 4 without alignas
+ * };
+ * ABCG_CHECK_STD140(LightData, intensity);
+ * ABCG_CHECK_STD140(LightData, direction);
+ * @endcode
+ *
+ * @param type Structure type.
+ * @param member Name of the member.
+ */
+#define ABCG_CHECK_STD140(type, member)                                        \
+  static_assert(offsetof(type, member) %                                       \
+                        abcg::std140Alignment<decltype(type::member)> ==       \
+                    0,                                                         \
+                "Member " #member " of " #type " does not match std140")
+
+/**
+ * @brief A class for representing a uniform buffer object.
+ *
+ * The buffer is a ring of slots, each large enough to hold one block. Each call
+ * to abcg::OpenGLUniformBuffer::update writes the block to the next slot and
+ * binds that slot to the uniform buffer binding point of the object. Slots that
+ * may still be read by the GPU are protected with fence sync objects, so the
+ * CPU never overwrites data in flight and the driver does not need to stall or
+ * duplicate the buffer.
+ *
+ * Programs read the block by associating their uniform block with the same
+ * binding point (see abcg::OpenGLProgram::setUniformBlockBinding). Since the
+ * binding point is shared by every program, switching programs does not
+ * require uploading the block again.
+ */
+class abcg::OpenGLUniformBuffer {
+public:
+  void create(GLuint bindingPoint, std::size_t blockSize,
+              std::size_t ringSize = 3);
+  void destroy();
+
+  void update(void const *data, std::size_t size);
+
+  /**
+   * @brief Writes a block to the next slot of the ring and binds it.
+   *
+   * @tparam T Type of the block structure. Use ABCG_CHECK_STD140 to validate
+   * its layout.
+   *
+   * @param block Block data.
+   */
+  template <typename T> void update(T const &block) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Uniform block must be trivially copyable");
+    update(&block, sizeof(T));
+  }
+
+  [[nodiscard]] GLuint getBindingPoint() const noexcept;
+
+private:
+  GLuint m_buffer{};
+  GLuint m_bindingPoint{};
+  std::size_t m_blockSize{};
+  std::size_t m_slotSize{};
+  bool m_written{};
+  OpenGLFenceRing m_fenceRing;
+};
+
+#endif
@@ -19,6 +19,30 @@
 #include "abcgException.hpp"
 #include "abcgWindow.hpp"
 
+namespace {
+/**
+ * @brief Prints the minimum, median and 99th percentile of a list of frame
+ * times.
+ *
+ * @param frameTimes Frame times, in seconds.
+ */
+void printFrameTimeStatistics(std::vector<double> frameTimes) {
+  if (frameTimes.empty())
+    return;
+
+  std::sort(frameTimes.begin(), frameTimes.end());
+  auto const percentile{[&frameTimes](double const fraction) {
+    auto const index{gsl::narrow<std::size_t>(
+        fraction * gsl::narrow<double>(frameTimes.size() - 1) + 0.5)};
+    return frameTimes.at(index) * 1000.0;
+  }};
+
+  fmt::print("Offscreen frames: {}\n", frameTimes.size());
+  fmt::print("Frame time (ms).: min {:.3f} | median {:.3f} | p99 {:.3f}\n",
+             frameTimes.front() * 1000.0, percentile(0.5), percentile(0.99));
+}
+} // namespace
+
 /**
  * @brief Returns the configuration settings of the OpenGL context.
  *
@@ -57,8 +81,13 @@ void abcg::OpenGLWindow::saveScreenshotPNG(std::string_view filename) const {
 
   auto const numPixels{gsl::narrow<std::size_t>(size.x * size.y * channels)};
   std::vector<unsigned char> pixels(numPixels);
-  glReadBuffer(m_openGLSettings.doubleBuffering ? GL_BACK : GL_FRONT);
-  glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  if (m_offscreenFBO != 0) {
+    readOffscreenPixels(pixels);
+  } else {
+    glReadBuffer(m_openGLSettings.doubleBuffering ? GL_BACK : GL_FRONT);
+    glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE,
+                 pixels.data());
+  }
 
   // Flip upside down
   for (auto const line : iter::range(size.y / 2)) {
@@ -361,7 +390,11 @@ void abcg::OpenGLWindow::create() {
 #endif
 
 #if !defined(__EMSCRIPTEN__)
-  if (auto const err{glewInit()}; GLEW_OK != err) {
+  if (auto const err{glewInit()};
+      GLEW_OK != err &&
+      // GLEW built for GLX reports a missing display with EGL contexts, even
+      // though the OpenGL entry points were successfully loaded
+      !(isOffscreen() && err == GLEW_ERROR_NO_GLX_DISPLAY)) {
     throw abcg::Exception{
         fmt::format("Failed to initialize OpenGL loader: {}",
                     reinterpret_cast<char const *>(glewGetErrorString(err)))};
@@ -419,19 +452,29 @@ void abcg::OpenGLWindow::create() {
     throw abcg::RuntimeError("Failed to load font file");
   }
 
+  if (isOffscreen()) {
+    createOffscreenFramebuffer();
+  }
+
   onCreate();
 
   onResize(getWindowSize());
 }
 
 void abcg::OpenGLWindow::paint() {
+  m_frameTimer.restart();
+
   onUpdate();
 
-  if (m_hidden || m_minimized)
+  if ((m_hidden || m_minimized) && m_offscreenFBO == 0)
     return;
 
   SDL_GL_MakeCurrent(abcg::Window::getSDLWindow(), m_GLContext);
 
+  if (m_offscreenFBO != 0) {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_offscreenFBO);
+  }
+
 #if defined(__EMSCRIPTEN__)
   // Force window size in windowed mode
   EmscriptenFullscreenChangeEvent fullscreenStatus{};
@@ -454,6 +497,19 @@ void abcg::OpenGLWindow::paint() {
   onPaint();
 
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+  if (m_offscreenFBO != 0) {
+    // Wait for the GPU so that the frame time includes the rendering time
+    glFinish();
+    m_frameTimes.push_back(m_frameTimer.elapsed());
+    if (std::ssize(m_frameTimes) >= m_openGLSettings.offscreenFrames) {
+      SDL_Event quitEvent{};
+      quitEvent.type = SDL_QUIT;
+      SDL_PushEvent(&quitEvent);
+    }
+    return;
+  }
+
   if (m_openGLSettings.doubleBuffering) {
     SDL_GL_SwapWindow(abcg::Window::getSDLWindow());
   } else {
@@ -464,6 +520,11 @@ void abcg::OpenGLWindow::paint() {
 void abcg::OpenGLWindow::destroy() {
   onDestroy();
 
+  if (m_offscreenFBO != 0) {
+    printFrameTimeStatistics(m_frameTimes);
+    destroyOffscreenFramebuffer();
+  }
+
   if (ImGui::GetCurrentContext() != nullptr) {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
@@ -482,3 +543,105 @@ void abcg::OpenGLWindow::destroy() {
   }
   return size;
 }
+
+[[nodiscard]] bool abcg::OpenGLWindow::isOffscreen() const noexcept {
+#if defined(__EMSCRIPTEN__)
+  return false;
+#else
+  return m_openGLSettings.offscreen;
+#endif
+}
+
+void abcg::OpenGLWindow::setOffscreen(int frames) noexcept {
+  m_openGLSettings.offscreen = true;
+  if (frames > 0) {
+    m_openGLSettings.offscreenFrames = frames;
+  }
+}
+
+void abcg::OpenGLWindow::createOffscreenFramebuffer() {
+  if (m_openGLSettings.offscreenFrames <= 0) {
+    throw abcg::RuntimeError(
+        fmt::format("Invalid number of offscreen frames: {}",
+                    m_openGLSettings.offscreenFrames));
+  }
+
+  auto const size{getWindowSize()};
+
+  // Renderbuffers of the offscreen framebuffer, multisampled if requested
+  auto const samples{std::max(m_openGLSettings.samples, 0)};
+  GLenum const depthFormat{m_openGLSettings.stencilBufferSize > 0
+                               ? GLenum{GL_DEPTH24_STENCIL8}
+                               : GLenum{GL_DEPTH_COMPONENT24}};
+
+  glGenRenderbuffers(1, &m_offscreenColorRBO);
+  glBindRenderbuffer(GL_RENDERBUFFER, m_offscreenColorRBO);
+  glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, size.x,
+                                   size.y);
+
+  glGenRenderbuffers(1, &m_offscreenDepthRBO);
+  glBindRenderbuffer(GL_RENDERBUFFER, m_offscreenDepthRBO);
+  glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, depthFormat,
+                                   size.x, size.y);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glGenFramebuffers(1, &m_offscreenFBO);
+  glBindFramebuffer(GL_FRAMEBUFFER, m_offscreenFBO);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, m_offscreenColorRBO);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+                            m_openGLSettings.stencilBufferSize > 0
+                                ? GL_DEPTH_STENCIL_ATTACHMENT
+                                : GL_DEPTH_ATTACHMENT,
+                            GL_RENDERBUFFER, m_offscreenDepthRBO);
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    throw abcg::RuntimeError("Failed to create offscreen framebuffer");
+  }
+
+  m_frameTimes.reserve(
+      gsl::narrow<std::size_t>(m_openGLSettings.offscreenFrames));
+
+  fmt::print("Rendering {} frames offscreen ({}x{})\n",
+             m_openGLSettings.offscreenFrames, size.x, size.y);
+}
+
+void abcg::OpenGLWindow::destroyOffscreenFramebuffer() {
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &m_offscreenFBO);
+  glDeleteRenderbuffers(1, &m_offscreenColorRBO);
+  glDeleteRenderbuffers(1, &m_offscreenDepthRBO);
+  m_offscreenFBO = 0;
+  m_offscreenColorRBO = 0;
+  m_offscreenDepthRBO = 0;
+}
+
+void abcg::OpenGLWindow::readOffscreenPixels(
+    std::vector<unsigned char> &pixels) const {
+  auto const size{getWindowSize()};
+
+  // Resolve into a single-sampled framebuffer before reading the pixels
+  GLuint resolveRBO{};
+  glGenRenderbuffers(1, &resolveRBO);
+  glBindRenderbuffer(GL_RENDERBUFFER, resolveRBO);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  GLuint resolveFBO{};
+  glGenFramebuffers(1, &resolveFBO);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFBO);
+  glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, resolveRBO);
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_offscreenFBO);
+  glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y,
+                    GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, resolveFBO);
+  glReadBuffer(GL_COLOR_ATTACHMENT0);
+  glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+  glBindFramebuffer(GL_FRAMEBUFFER, m_offscreenFBO);
+  glDeleteFramebuffers(1, &resolveFBO);
+  glDeleteRenderbuffers(1, &resolveRBO);
+}
@@ -14,6 +14,7 @@
 #define ABCG_OPENGL_WINDOW_HPP_
 
 #include <string>
+#include <vector>
 
 #include "abcgExternal.hpp"
 #include "abcgOpenGLFunction.hpp"
@@ -77,6 +78,27 @@ struct abcg::OpenGLSettings {
   bool vSync{false};
   /** @brief Whether the output is double buffered. */
   bool doubleBuffering{true};
+  /** @brief Whether to render offscreen, without a visible window.
+   *
+   * The OpenGL context is created through the SDL offscreen video driver
+   * (surfaceless EGL context) and the scene is rendered into a framebuffer
+   * object with the size given by abcg::WindowSettings. The application exits
+   * after abcg::OpenGLSettings::offscreenFrames frames and prints the frame
+   * time statistics (minimum, median and 99th percentile).
+   *
+   * This can also be enabled without changing the application with the
+   * `--offscreen[=N]` command-line argument or the `ABCG_OFFSCREEN=N`
+   * environment variable, where `N` overrides
+   * abcg::OpenGLSettings::offscreenFrames.
+   *
+   * @remark This is ignored when the application is built for WebAssembly.
+   */
+  bool offscreen{false};
+  /** @brief Number of frames rendered in offscreen mode.
+   *
+   * Must be positive when abcg::OpenGLSettings::offscreen is `true`.
+   */
+  int offscreenFrames{300};
 };
 
 /**
@@ -117,12 +139,25 @@ private:
   void paint() final;
   void destroy() final;
   [[nodiscard]] glm::ivec2 getWindowSize() const final;
+  [[nodiscard]] bool isOffscreen() const noexcept final;
+  void setOffscreen(int frames) noexcept final;
+
+  void createOffscreenFramebuffer();
+  void destroyOffscreenFramebuffer();
+  void readOffscreenPixels(std::vector<unsigned char> &pixels) const;
 
   OpenGLSettings m_openGLSettings;
   std::string m_GLSLVersion;
   SDL_GLContext m_GLContext{};
   bool m_hidden{};
   bool m_minimized{};
+
+  // Offscreen rendering
+  GLuint m_offscreenFBO{};
+  GLuint m_offscreenColorRBO{};
+  GLuint m_offscreenDepthRBO{};
+  Timer m_frameTimer;
+  std::vector<double> m_frameTimes;
 };
 
 #endif
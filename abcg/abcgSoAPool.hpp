@@ -0,0 +1,307 @@
+/**
+ * @file abcgSoAPool.hpp
+ * @brief Header file of abcg::SoAPool.
+ *
+ * Declaration and definition of abcg::SoAPool.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_SOA_POOL_HPP_
+#define ABCG_SOA_POOL_HPP_
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "abcgExternal.hpp"
+
+namespace abcg {
+template <typename... TComponents> class SoAPool;
+} // namespace abcg
+
+/**
+ * @brief A pool of objects stored as a structure of arrays.
+ *
+ * Each component of the objects is stored in its own dense array, so that
+ * loops over a few components of all objects access contiguous memory:
+ * @code
+ * abcg::SoAPool<glm::vec2, glm::vec2> particles; // Positions and velocities
+ * auto const handle{particles.insert(position, velocity)};
+ * ...
+ * auto const positions{particles.get<0>()};
+ * auto const velocities{particles.get<1>()};
+ * for (auto const index : iter::range(particles.size())) {
+ *   positions[index] += velocities[index] * deltaTime;
+ * }
+ * @endcode
+ *
+ * Objects are removed by moving the last object into their place, so the
+ * arrays have no holes but the order of the objects is not preserved. An
+ * object can still be found through the handle returned by
+ * abcg::SoAPool::insert, which is invalidated when the object is removed.
+ * Slots of removed objects are reused by later insertions, and the arrays keep
+ * their capacity, so insertions and removals do not allocate memory once the
+ * pool has reached its largest size.
+ *
+ * @tparam TComponents Typenames of the components of each object. `bool` is
+ * not allowed, as `std::vector<bool>` is not contiguous; use `std::uint8_t`
+ * instead.
+ */
+template <typename... TComponents> class abcg::SoAPool {
+  static_assert(sizeof...(TComponents) > 0);
+  static_assert((!std::is_same_v<TComponents, bool> && ...),
+                "std::vector<bool> cannot be viewed as a span");
+
+public:
+  /**
+   * @brief Stable reference to an object of the pool.
+   */
+  struct Handle {
+    /** @brief Slot of the object. */
+    std::uint32_t slot{invalidIndex};
+    /** @brief Number of times the slot was released when the handle was
+     * created. */
+    std::uint32_t generation{};
+
+    friend bool operator==(Handle const &, Handle const &) = default;
+  };
+
+  /**
+   * @brief Typename of the component with a given index.
+   */
+  template <std::size_t I>
+  using Component = std::tuple_element_t<I, std::tuple<TComponents...>>;
+
+  /**
+   * @brief Adds an object to the end of the arrays.
+   *
+   * @param components Components of the object.
+   *
+   * @return Handle of the object.
+   */
+  Handle insert(TComponents... components) {
+    std::uint32_t slot{};
+    if (m_freeSlot != invalidIndex) {
+      slot = m_freeSlot;
+      m_freeSlot = m_slots[slot].index;
+    } else {
+      slot = gsl::narrow<std::uint32_t>(m_slots.size());
+      m_slots.emplace_back();
+    }
+    m_slots[slot].index = gsl::narrow<std::uint32_t>(m_denseSlots.size());
+    m_denseSlots.push_back(slot);
+
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      (std::get<I>(m_components).push_back(std::move(components)), ...);
+    }(std::index_sequence_for<TComponents...>{});
+
+    return {.slot = slot, .generation = m_slots[slot].generation};
+  }
+
+  /**
+   * @brief Removes the object referenced by a handle.
+   *
+   * @param handle Handle of the object.
+   *
+   * @return `false` if the handle is no longer valid.
+   */
+  bool erase(Handle const &handle) {
+    auto const index{indexOf(handle)};
+    if (!index)
+      return false;
+    eraseAt(*index);
+    return true;
+  }
+
+  /**
+   * @brief Removes the object at a given position of the arrays.
+   *
+   * The last object is moved to this position.
+   *
+   * @param index Position of the object.
+   */
+  void eraseAt(std::size_t index) {
+    auto const last{m_denseSlots.size() - 1};
+    auto const slot{m_denseSlots[index]};
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      if (index != last) {
+        ((std::get<I>(m_components)[index] =
+              std::move(std::get<I>(m_components)[last])),
+         ...);
+      }
+      (std::get<I>(m_components).pop_back(), ...);
+    }(std::index_sequence_for<TComponents...>{});
+
+    if (index != last) {
+      m_denseSlots[index] = m_denseSlots[last];
+      m_slots[m_denseSlots[index]].index = gsl::narrow<std::uint32_t>(index);
+    }
+    m_denseSlots.pop_back();
+    releaseSlot(slot);
+  }
+
+  /**
+   * @brief Removes the objects that satisfy a predicate.
+   *
+   * @param predicate Function that takes the position of an object in the
+   * arrays and returns `true` if the object must be removed. Objects can be
+   * moved between calls, so the predicate must read their components through
+   * the position it receives.
+   *
+   * @return Number of objects removed.
+   */
+  template <typename TPredicate> std::size_t eraseIf(TPredicate &&predicate) {
+    std::size_t numErased{};
+    for (std::size_t index{}; index < m_denseSlots.size();) {
+      if (predicate(index)) {
+        eraseAt(index);
+        ++numErased;
+      } else {
+        ++index;
+      }
+    }
+    return numErased;
+  }
+
+  /**
+   * @brief Removes all objects and invalidates their handles.
+   *
+   * The capacity of the arrays is kept.
+   */
+  void clear() {
+    for (auto const slot : m_denseSlots) {
+      releaseSlot(slot);
+    }
+    m_denseSlots.clear();
+    std::apply([](auto &...arrays) { (arrays.clear(), ...); }, m_components);
+  }
+
+  /**
+   * @brief Reserves memory for a number of objects.
+   *
+   * @param capacity Number of objects.
+   */
+  void reserve(std::size_t capacity) {
+    m_slots.reserve(capacity);
+    m_denseSlots.reserve(capacity);
+    std::apply([&](auto &...arrays) { (arrays.reserve(capacity), ...); },
+               m_components);
+  }
+
+  /**
+   * @brief Returns the position in the arrays of the object referenced by a
+   * handle.
+   *
+   * @param handle Handle of the object.
+   *
+   * @return Position of the object, or `std::nullopt` if the object was
+   * removed.
+   */
+  [[nodiscard]] std::optional<std::size_t>
+  indexOf(Handle const &handle) const noexcept {
+    if (handle.slot >= m_slots.size() ||
+        m_slots[handle.slot].generation != handle.generation)
+      return std::nullopt;
+    return m_slots[handle.slot].index;
+  }
+
+  /**
+   * @brief Returns whether a handle references an object of the pool.
+   *
+   * @param handle Handle of the object.
+   *
+   * @return `true` if the object was not removed.
+   */
+  [[nodiscard]] bool contains(Handle const &handle) const noexcept {
+    return indexOf(handle).has_value();
+  }
+
+  /**
+   * @brief Returns the handle of the object at a given position of the
+   * arrays.
+   *
+   * @param index Position of the object.
+   *
+   * @return Handle of the object.
+   */
+  [[nodiscard]] Handle handleAt(std::size_t index) const {
+    auto const slot{m_denseSlots[index]};
+    return {.slot = slot, .generation = m_slots[slot].generation};
+  }
+
+  /**
+   * @brief Returns the array of a component.
+   *
+   * The span is invalidated by insertions and removals.
+   *
+   * @tparam I Index of the component.
+   *
+   * @return Values of the component, one per object.
+   */
+  template <std::size_t I> [[nodiscard]] std::span<Component<I>> get() {
+    return std::get<I>(m_components);
+  }
+
+  /**
+   * @brief Returns the array of a component.
+   *
+   * The span is invalidated by insertions and removals.
+   *
+   * @tparam I Index of the component.
+   *
+   * @return Values of the component, one per object.
+   */
+  template <std::size_t I>
+  [[nodiscard]] std::span<Component<I> const> get() const {
+    return std::get<I>(m_components);
+  }
+
+  /**
+   * @brief Returns the number of objects.
+   *
+   * @return Number of objects.
+   */
+  [[nodiscard]] std::size_t size() const noexcept {
+    return m_denseSlots.size();
+  }
+
+  /**
+   * @brief Returns whether the pool has no objects.
+   *
+   * @return `true` if the pool is empty.
+   */
+  [[nodiscard]] bool empty() const noexcept { return m_denseSlots.empty(); }
+
+private:
+  static constexpr auto invalidIndex{std::numeric_limits<std::uint32_t>::max()};
+
+  // Position in the arrays of the object of a slot in use, or next slot of
+  // the free list
+  struct Slot {
+    std::uint32_t index{};
+    std::uint32_t generation{};
+  };
+
+  std::tuple<std::vector<TComponents>...> m_components;
+  std::vector<std::uint32_t> m_denseSlots;
+  std::vector<Slot> m_slots;
+  std::uint32_t m_freeSlot{invalidIndex};
+
+  // Invalidates the handles of a slot and pushes it to the free list
+  void releaseSlot(std::uint32_t slot) noexcept {
+    ++m_slots[slot].generation;
+    m_slots[slot].index = m_freeSlot;
+    m_freeSlot = slot;
+  }
+};
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file abcgThreadPool.cpp
+ * @brief Definition of abcg::ThreadPool members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgThreadPool.hpp"
+
+#include <algorithm>
+
+/**
+ * @brief Creates the worker threads.
+ *
+ * @param threadCount Number of worker threads. If zero, tasks are run in the
+ * thread that submits them.
+ */
+abcg::ThreadPool::ThreadPool(std::size_t threadCount) {
+  m_threads.reserve(threadCount);
+  for (std::size_t index{}; index < threadCount; ++index) {
+    m_threads.emplace_back([this] { workerLoop(); });
+  }
+}
+
+/**
+ * @brief Waits for the pending tasks to finish and joins the worker threads.
+ */
+abcg::ThreadPool::~ThreadPool() {
+  {
+    std::scoped_lock const lock{m_mutex};
+    m_stopping = true;
+  }
+  m_condition.notify_all();
+  for (auto &thread : m_threads) {
+    thread.join();
+  }
+}
+
+/**
+ * @brief Returns the number of worker threads.
+ *
+ * @return Number of worker threads.
+ */
+std::size_t abcg::ThreadPool::getThreadCount() const noexcept {
+  return m_threads.size();
+}
+
+/**
+ * @brief Returns the default number of worker threads.
+ *
+ * @return Number of hardware threads minus one (the main thread), with a
+ * minimum of one. In WebAssembly builds without pthreads support, returns zero.
+ */
+std::size_t abcg::ThreadPool::getDefaultThreadCount() noexcept {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+  return 0;
+#else
+  auto const hardwareThreads{std::thread::hardware_concurrency()};
+  return std::max(hardwareThreads, 2U) - 1;
+#endif
+}
+
+/**
+ * @brief Returns a pool shared by the whole application.
+ *
+ * The pool is created on the first call with the default number of threads.
+ *
+ * @return Reference to the shared pool.
+ */
+abcg::ThreadPool &abcg::ThreadPool::getDefault() {
+  static ThreadPool pool;
+  return pool;
+}
+
+void abcg::ThreadPool::enqueue(std::function<void()> task) {
+  if (m_threads.empty()) {
+    task();
+    return;
+  }
+  {
+    std::scoped_lock const lock{m_mutex};
+    m_tasks.push(std::move(task));
+  }
+  m_condition.notify_one();
+}
+
+void abcg::ThreadPool::workerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock{m_mutex};
+      m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+      if (m_tasks.empty())
+        return;
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+    }
+    task();
+  }
+}
@@ -0,0 +1,86 @@
+/**
+ * @file abcgThreadPool.hpp
+ * @brief Header file of abcg::ThreadPool.
+ *
+ * Declaration of abcg::ThreadPool.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_THREAD_POOL_HPP_
+#define ABCG_THREAD_POOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace abcg {
+class ThreadPool;
+} // namespace abcg
+
+/**
+ * @brief A fixed-size pool of worker threads that run tasks in FIFO order.
+ *
+ * Tasks are submitted with abcg::ThreadPool::submit, which returns a
+ * `std::future` holding the result of the task or the exception it threw.
+ *
+ * If the pool has no worker threads (e.g., in WebAssembly builds without
+ * pthreads support), tasks are run immediately in the calling thread.
+ *
+ * @remark Objects of this type cannot be copied or moved.
+ */
+class abcg::ThreadPool {
+public:
+  explicit ThreadPool(std::size_t threadCount = getDefaultThreadCount());
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const &) = delete;
+  ThreadPool &operator=(ThreadPool const &) = delete;
+  ThreadPool(ThreadPool &&) = delete;
+  ThreadPool &operator=(ThreadPool &&) = delete;
+
+  /**
+   * @brief Submits a task to be run by a worker thread.
+   *
+   * @tparam TFun Typename of the task, a callable object with no parameters.
+   *
+   * @param task Task to be run.
+   *
+   * @return Future holding the value returned by the task.
+   */
+  template <typename TFun> auto submit(TFun &&task) {
+    using Result = std::invoke_result_t<std::decay_t<TFun>>;
+    auto packagedTask{std::make_shared<std::packaged_task<Result()>>(
+        std::forward<TFun>(task))};
+    auto future{packagedTask->get_future()};
+    enqueue([packagedTask] { (*packagedTask)(); });
+    return future;
+  }
+
+  [[nodiscard]] std::size_t getThreadCount() const noexcept;
+
+  [[nodiscard]] static std::size_t getDefaultThreadCount() noexcept;
+  [[nodiscard]] static ThreadPool &getDefault();
+
+private:
+  void enqueue(std::function<void()> task);
+  void workerLoop();
+
+  std::vector<std::thread> m_threads;
+  std::queue<std::function<void()>> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_stopping{};
+};
+
+#endif
@@ -10,11 +10,26 @@
 
 #include "abcgUtil.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <random>
+
+#include "abcgExternal.hpp"
+
 namespace {
 auto const codeBoldRed{"\033[1;31m"};
 auto const codeBoldYellow{"\033[1;33m"};
 auto const codeBoldBlue{"\033[1;34m"};
 auto const codeReset{"\033[0m"};
+
+// Returns a file name suffix that is unique across threads and processes
+std::string temporarySuffix() {
+  static std::atomic<std::uint64_t> counter{};
+  std::random_device randomDevice;
+  auto const random{(std::uint64_t{randomDevice()} << 32U) | randomDevice()};
+  return fmt::format(".{:016x}.{}.tmp", random, counter++);
+}
 } // namespace
 
 /**
@@ -54,4 +69,58 @@ std::string abcg::toYellowString(std::string_view str) {
  */
 std::string abcg::toBlueString(std::string_view str) {
   return std::string{codeBoldBlue} + str.data() + std::string{codeReset};
+}
+
+/**
+ * @brief Writes data to a binary file without ever exposing a partially
+ * written file.
+ *
+ * The data is written to a temporary file with a unique name next to the
+ * destination, which is then renamed to the destination. Concurrent writers of
+ * the same file, in the same or in different processes, thus never write to
+ * the same temporary file, and the last rename wins. The parent directories are created if
+ * needed. This is meant for on-disk caches, which may be read concurrently by
+ * other instances of the application:
+ * @code
+ * abcg::writeFileAtomically(path, {std::as_bytes(std::span{&header, 1}),
+ *                                  std::as_bytes(std::span{payload})});
+ * @endcode
+ *
+ * @param path Path to the destination file.
+ * @param data Chunks of bytes written in sequence.
+ *
+ * @return `true` if the file was written, or `false` otherwise. On failure,
+ * the temporary file is removed and the destination is left untouched.
+ */
+bool abcg::writeFileAtomically(
+    std::filesystem::path const &path,
+    std::initializer_list<std::span<std::byte const>> data) {
+  std::error_code errorCode;
+  std::filesystem::create_directories(path.parent_path(), errorCode);
+  if (errorCode)
+    return false;
+
+  auto temporaryPath{path};
+  temporaryPath += temporarySuffix();
+  {
+    std::ofstream stream(temporaryPath, std::ios::binary);
+    if (!stream)
+      return false;
+    for (auto const &bytes : data) {
+      stream.write(reinterpret_cast<char const *>(bytes.data()),
+                   gsl::narrow<std::streamsize>(bytes.size()));
+    }
+    stream.close();
+    if (!stream.good()) {
+      std::filesystem::remove(temporaryPath, errorCode);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temporaryPath, path, errorCode);
+  if (errorCode) {
+    std::filesystem::remove(temporaryPath, errorCode);
+    return false;
+  }
+  return true;
 }
\ No newline at end of file
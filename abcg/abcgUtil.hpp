@@ -11,7 +11,11 @@
 #ifndef ABCG_UTIL_HPP_
 #define ABCG_UTIL_HPP_
 
+#include <cstddef>
+#include <filesystem>
 #include <functional>
+#include <initializer_list>
+#include <span>
 #include <string>
 
 namespace abcg {
@@ -73,6 +77,10 @@ std::string toRedString(std::string_view str);
 std::string toYellowString(std::string_view str);
 std::string toBlueString(std::string_view str);
 
+bool writeFileAtomically(
+    std::filesystem::path const &path,
+    std::initializer_list<std::span<std::byte const>> data);
+
 } // namespace abcg
 
 #endif
\ No newline at end of file
@@ -0,0 +1,264 @@
+/**
+ * @file abcgVertexWelder.hpp
+ * @brief Header file of abcg::VertexWelder.
+ *
+ * Declaration and definition of abcg::VertexWelder and abcg::weldVertices.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_VERTEX_WELDER_HPP_
+#define ABCG_VERTEX_WELDER_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "abcgThreadPool.hpp"
+#include "abcgTimer.hpp"
+
+namespace abcg {
+template <typename TVertex> class VertexWelder;
+
+template <typename TVertex, typename TIndex, typename TFun>
+void weldVertices(std::size_t numIndices, TFun const &getVertex,
+                  std::vector<TVertex> &vertices, std::vector<TIndex> &indices,
+                  ThreadPool *threadPool = nullptr);
+} // namespace abcg
+
+/**
+ * @brief Merges identical vertices of an indexed mesh.
+ *
+ * abcg::VertexWelder::weld appends a vertex to a vertex array only if it is
+ * not already there, and returns the index of the vertex in the array. This
+ * is typically used for converting the vertices of a mesh loaded from an OBJ
+ * file into an indexed geometry:
+ * @code
+ * abcg::VertexWelder welder{vertices, numIndices};
+ * for (...) {
+ *   indices.push_back(welder.weld(vertex));
+ * }
+ * @endcode
+ *
+ * Vertices are compared by their bits, which are hashed only once per call.
+ * The lookup table is a flat array with open addressing and linear probing.
+ *
+ * @tparam TVertex Typename of the vertex. It must be trivially copyable and
+ * must not contain padding bytes.
+ */
+template <typename TVertex> class abcg::VertexWelder {
+  static_assert(std::is_trivially_copyable_v<TVertex>);
+
+public:
+  /**
+   * @brief Creates a welder for a vertex array.
+   *
+   * Vertices already in the array are added to the lookup table.
+   *
+   * @param vertices Vertex array. It must not be modified by other means
+   * while the welder is in use.
+   * @param maxVertices Expected maximum number of distinct vertices (e.g., the
+   * number of indices of the mesh). The table is sized for this number of
+   * vertices, so that no rehashing is needed.
+   */
+  explicit VertexWelder(std::vector<TVertex> &vertices,
+                        std::size_t maxVertices = 0)
+      : m_vertices{&vertices} {
+    rehash(std::max(maxVertices, vertices.size()));
+  }
+
+  /**
+   * @brief Returns the index of a vertex, adding it to the vertex array if
+   * it is not there yet.
+   *
+   * @param vertex Vertex to be added.
+   *
+   * @return Index of the vertex in the vertex array.
+   */
+  std::uint32_t weld(TVertex const &vertex) {
+    auto const hash{hashBits(vertex)};
+    auto slotIndex{static_cast<std::size_t>(hash) & m_mask};
+    while (true) {
+      auto &slot{m_slots[slotIndex]};
+      if (slot.index == emptyIndex)
+        break;
+      if (slot.hash == static_cast<std::uint32_t>(hash) &&
+          std::memcmp(&(*m_vertices)[slot.index], &vertex, sizeof(TVertex)) ==
+              0)
+        return slot.index;
+      slotIndex = (slotIndex + 1) & m_mask;
+    }
+
+    auto const index{static_cast<std::uint32_t>(m_vertices->size())};
+    m_vertices->push_back(vertex);
+    m_slots[slotIndex] = {.hash = static_cast<std::uint32_t>(hash),
+                          .index = index};
+
+    // Keep the load factor at or below 1/2
+    if (m_vertices->size() * 2 > m_slots.size()) {
+      rehash(m_vertices->size() * 2);
+    }
+    return index;
+  }
+
+  /**
+   * @brief Returns the time spent since the welder was created.
+   *
+   * @return Time, in seconds.
+   */
+  [[nodiscard]] double getElapsedTime() const { return m_timer.elapsed(); }
+
+private:
+  struct Slot {
+    std::uint32_t hash{};
+    std::uint32_t index{emptyIndex};
+  };
+
+  static constexpr auto emptyIndex{std::numeric_limits<std::uint32_t>::max()};
+
+  // Hashes the bits of a vertex 64 bits at a time
+  static std::uint64_t hashBits(TVertex const &vertex) noexcept {
+    constexpr std::uint64_t multiplier{0x9e3779b97f4a7c15};
+    auto const *bytes{reinterpret_cast<unsigned char const *>(&vertex)};
+    std::uint64_t hash{sizeof(TVertex)};
+    std::size_t offset{};
+    for (; offset + sizeof(std::uint64_t) <= sizeof(TVertex);
+         offset += sizeof(std::uint64_t)) {
+      std::uint64_t word{};
+      std::memcpy(&word, bytes + offset, sizeof(word));
+      hash = (hash ^ word) * multiplier;
+      hash ^= hash >> 32;
+    }
+    if (offset < sizeof(TVertex)) {
+      std::uint64_t word{};
+      std::memcpy(&word, bytes + offset, sizeof(TVertex) - offset);
+      hash = (hash ^ word) * multiplier;
+    }
+
+    // Final mix of splitmix64
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111eb;
+    hash ^= hash >> 31;
+    return hash;
+  }
+
+  void rehash(std::size_t maxVertices) {
+    m_slots.assign(std::bit_ceil(std::max(maxVertices * 2, std::size_t{16})),
+                   Slot{});
+    m_mask = m_slots.size() - 1;
+    for (std::uint32_t index{}; index < m_vertices->size(); ++index) {
+      auto const hash{hashBits((*m_vertices)[index])};
+      auto slotIndex{static_cast<std::size_t>(hash) & m_mask};
+      while (m_slots[slotIndex].index != emptyIndex) {
+        slotIndex = (slotIndex + 1) & m_mask;
+      }
+      m_slots[slotIndex] = {.hash = static_cast<std::uint32_t>(hash),
+                            .index = index};
+    }
+  }
+
+  std::vector<TVertex> *m_vertices{};
+  std::vector<Slot> m_slots;
+  std::size_t m_mask{};
+  abcg::Timer m_timer;
+};
+
+/**
+ * @brief Builds an indexed mesh from a sequence of vertices using multiple
+ * threads.
+ *
+ * The sequence is split into ranges that are welded concurrently, each with
+ * its own abcg::VertexWelder. The distinct vertices of the ranges are then
+ * welded into `vertices`, and the indices of the ranges are remapped
+ * concurrently. The result is the same as welding the sequence with a single
+ * abcg::VertexWelder.
+ *
+ * @tparam TVertex Typename of the vertex (see abcg::VertexWelder).
+ * @tparam TIndex Typename of the index, an unsigned integer type.
+ * @tparam TFun Typename of a function that returns the `TVertex` at a given
+ * position of the sequence. It is called concurrently.
+ *
+ * @param numIndices Number of vertices of the sequence.
+ * @param getVertex Function that returns the vertex at a given position.
+ * @param vertices Vertex array to which the distinct vertices are appended.
+ * @param indices Index array to which `numIndices` indices are appended.
+ * @param threadPool Pool of worker threads. If null,
+ * abcg::ThreadPool::getDefault is used.
+ */
+template <typename TVertex, typename TIndex, typename TFun>
+void abcg::weldVertices(std::size_t numIndices, TFun const &getVertex,
+                        std::vector<TVertex> &vertices,
+                        std::vector<TIndex> &indices, ThreadPool *threadPool) {
+  auto &pool{threadPool == nullptr ? ThreadPool::getDefault() : *threadPool};
+  auto const firstIndex{indices.size()};
+  indices.resize(firstIndex + numIndices);
+
+  // Weld ranges of at least 64K vertices, one range per thread
+  constexpr std::size_t minRangeSize{std::size_t{1} << 16};
+  auto const numRanges{std::clamp(numIndices / minRangeSize, std::size_t{1},
+                                  pool.getThreadCount() + 1)};
+  auto const rangeSize{(numIndices + numRanges - 1) / numRanges};
+
+  std::vector<std::future<std::vector<TVertex>>> weldedRanges;
+  for (std::size_t first{}; first < numIndices; first += rangeSize) {
+    auto const last{std::min(first + rangeSize, numIndices)};
+    weldedRanges.push_back(pool.submit([&, first, last] {
+      std::vector<TVertex> rangeVertices;
+      VertexWelder welder{rangeVertices, last - first};
+      for (auto position{first}; position < last; ++position) {
+        indices[firstIndex + position] =
+            static_cast<TIndex>(welder.weld(getVertex(position)));
+      }
+      return rangeVertices;
+    }));
+  }
+
+  // The tasks reference the arguments, so wait for all of them
+  for (auto const &weldedRange : weldedRanges) {
+    weldedRange.wait();
+  }
+  std::vector<std::vector<TVertex>> rangeVertices;
+  std::size_t maxVertices{vertices.size()};
+  for (auto &weldedRange : weldedRanges) {
+    rangeVertices.push_back(weldedRange.get());
+    maxVertices += rangeVertices.back().size();
+  }
+
+  // Weld the distinct vertices of each range into the final array
+  std::vector<std::vector<TIndex>> remaps(rangeVertices.size());
+  VertexWelder welder{vertices, maxVertices};
+  for (std::size_t range{}; range < rangeVertices.size(); ++range) {
+    remaps[range].reserve(rangeVertices[range].size());
+    for (auto const &vertex : rangeVertices[range]) {
+      remaps[range].push_back(static_cast<TIndex>(welder.weld(vertex)));
+    }
+  }
+
+  // Remap the indices of each range
+  std::vector<std::future<void>> remappedRanges;
+  for (std::size_t range{}; range < remaps.size(); ++range) {
+    remappedRanges.push_back(pool.submit([&, range] {
+      auto const first{range * rangeSize};
+      auto const last{std::min(first + rangeSize, numIndices)};
+      for (auto position{first}; position < last; ++position) {
+        auto &index{indices[firstIndex + position]};
+        index = remaps[range][index];
+      }
+    }));
+  }
+  for (auto &remappedRange : remappedRanges) {
+    remappedRange.get();
+  }
+}
+
+#endif
@@ -12,8 +12,35 @@
 
 #include <gsl/gsl>
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <set>
 
+#include "abcgUtil.hpp"
+
+namespace {
+// Returns true if the data starts with a pipeline cache header created by a
+// device with the given properties
+[[nodiscard]] bool
+isPipelineCacheCompatible(std::vector<char> const &data,
+                          vk::PhysicalDeviceProperties const &properties) {
+  VkPipelineCacheHeaderVersionOne header{};
+  if (data.size() < sizeof(header))
+    return false;
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  return header.headerSize >= sizeof(header) &&
+         header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == properties.vendorID &&
+         header.deviceID == properties.deviceID &&
+         std::equal(properties.pipelineCacheUUID.begin(),
+                    properties.pipelineCacheUUID.end(),
+                    std::begin(header.pipelineCacheUUID));
+}
+} // namespace
+
 void abcg::VulkanDevice::create(VulkanPhysicalDevice const &physicalDevice,
                                 std::vector<char const *> const &extensions) {
   m_physicalDevice = physicalDevice;
@@ -69,6 +96,7 @@ void abcg::VulkanDevice::create(VulkanPhysicalDevice const &physicalDevice,
 }
 
 void abcg::VulkanDevice::destroy() {
+  destroyPipelineCache();
   destroyCommandPools();
   m_device.destroy();
 }
@@ -109,6 +137,71 @@ abcg::VulkanDevice::getCommandPools() const noexcept {
   return m_commandPools;
 }
 
+/**
+ * @brief Returns the pipeline cache of this device.
+ *
+ * abcg::VulkanPipeline::create uses this cache if
+ * abcg::VulkanPipelineCreateInfo::pipelineCache is null.
+ *
+ * @return Pipeline cache, or a null handle if the cache was not created.
+ */
+vk::PipelineCache const &abcg::VulkanDevice::getPipelineCache() const noexcept {
+  return m_pipelineCache;
+}
+
+/**
+ * @brief Creates the pipeline cache of this device.
+ *
+ * The cache is seeded with the contents of the given file, if it exists and
+ * its header matches the vendor ID, device ID and pipeline cache UUID of the
+ * physical device. Otherwise, the cache is created empty.
+ *
+ * @param path Path to the file saved by a previous call to
+ * abcg::VulkanDevice::destroyPipelineCache. If empty, the cache is created
+ * empty.
+ */
+void abcg::VulkanDevice::createPipelineCache(
+    std::filesystem::path const &path) {
+  destroyPipelineCache();
+
+  std::vector<char> data;
+  if (!path.empty()) {
+    if (std::ifstream stream(path, std::ios::binary); stream) {
+      data.assign(std::istreambuf_iterator<char>(stream),
+                  std::istreambuf_iterator<char>());
+    }
+    auto const properties{
+        static_cast<vk::PhysicalDevice>(m_physicalDevice).getProperties()};
+    if (!isPipelineCacheCompatible(data, properties)) {
+      data.clear();
+    }
+  }
+
+  m_pipelineCache = m_device.createPipelineCache(
+      {.initialDataSize = data.size(), .pInitialData = data.data()});
+}
+
+/**
+ * @brief Destroys the pipeline cache of this device.
+ *
+ * @param path Path to the file where the contents of the cache will be saved
+ * before destroying it. If empty, the contents are discarded. Failures to write
+ * the file are not reported, as the cache is only an optimization.
+ */
+void abcg::VulkanDevice::destroyPipelineCache(
+    std::filesystem::path const &path) {
+  if (!m_pipelineCache)
+    return;
+
+  if (!path.empty()) {
+    auto const data{m_device.getPipelineCacheData(m_pipelineCache)};
+    abcg::writeFileAtomically(path, {std::as_bytes(std::span{data})});
+  }
+
+  m_device.destroyPipelineCache(m_pipelineCache);
+  m_pipelineCache = vk::PipelineCache{};
+}
+
 /**
  * @brief Allocates and creates a command buffer to be immediately submitted and
  * released.
@@ -15,6 +15,7 @@
 
 #include "abcgVulkanPhysicalDevice.hpp"
 
+#include <filesystem>
 #include <functional>
 
 namespace abcg {
@@ -50,7 +51,7 @@ struct abcg::VulkanQueues {
  * resources.
  *
  * This class creates and manages the Vulkan logical device, queues, descriptor
- * pool, and command pools.
+ * pool, command pools, and pipeline cache.
  */
 class abcg::VulkanDevice {
 public:
@@ -63,6 +64,10 @@ public:
   [[nodiscard]] VulkanPhysicalDevice const &getPhysicalDevice() const noexcept;
   [[nodiscard]] VulkanQueues const &getQueues() const noexcept;
   [[nodiscard]] VulkanCommandPools const &getCommandPools() const noexcept;
+  [[nodiscard]] vk::PipelineCache const &getPipelineCache() const noexcept;
+
+  void createPipelineCache(std::filesystem::path const &path = {});
+  void destroyPipelineCache(std::filesystem::path const &path = {});
 
   void withCommandBuffer(
       std::function<void(vk::CommandBuffer const &commandBuffer)> const &fun,
@@ -77,6 +82,7 @@ private:
   VulkanPhysicalDevice m_physicalDevice;
   VulkanCommandPools m_commandPools;
   VulkanQueues m_queues;
+  vk::PipelineCache m_pipelineCache;
 };
 
 #endif
\ No newline at end of file
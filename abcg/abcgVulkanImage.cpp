@@ -10,12 +10,15 @@
 
 #include "abcgVulkanImage.hpp"
 #include "abcgVulkanBuffer.hpp"
+#include "abcgImage.hpp"
 
 #include <SDL_image.h>
 #include <cppitertools/itertools.hpp>
 #include <fmt/core.h>
 #include <gsl/gsl>
 
+#include <vector>
+
 #include "abcgException.hpp"
 
 void abcg::VulkanImage::create(VulkanDevice const &device,
@@ -24,13 +27,17 @@ void abcg::VulkanImage::create(VulkanDevice const &device,
 
   // Load the bitmap
   if (SDL_Surface *const surface{IMG_Load(path.data())}) {
+    auto const texWidth{gsl::narrow<uint32_t>(surface->w)};
+    auto const texHeight{gsl::narrow<uint32_t>(surface->h)};
+
     // Enforce RGBA
-    SDL_Surface *formattedSurface{
-        SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0)};
-    SDL_FreeSurface(surface);
+    std::vector<std::byte> pixels;
+    {
+      auto const freeSurface{
+          gsl::finally([surface] { SDL_FreeSurface(surface); })};
+      convertSurface(*surface, {.bytesPerPixel = 4}, pixels);
+    }
 
-    auto const texWidth{gsl::narrow<uint32_t>(formattedSurface->w)};
-    auto const texHeight{gsl::narrow<uint32_t>(formattedSurface->h)};
     vk::DeviceSize const imageSize{
         static_cast<vk::DeviceSize>(texWidth * texHeight * 4)};
 
@@ -47,9 +54,7 @@ void abcg::VulkanImage::create(VulkanDevice const &device,
                  .usage = vk::BufferUsageFlagBits::eTransferSrc,
                  .properties = vk::MemoryPropertyFlagBits::eHostVisible |
                                vk::MemoryPropertyFlagBits::eHostCoherent,
-                 .data = formattedSurface->pixels});
-
-    SDL_FreeSurface(formattedSurface);
+                 .data = pixels.data()});
 
     // TODO: Look for other formats if RGBA8 is not supported
     auto const imageFormat{vk::Format::eR8G8B8A8Srgb};
@@ -38,6 +38,8 @@ struct abcg::VulkanPipelineCreateInfo {
   std::optional<vk::PipelineColorBlendStateCreateInfo> colorBlendState{};
   std::vector<vk::DynamicState> dynamicStates{};
   vk::PipelineLayoutCreateInfo pipelineLayout{};
+  /** @brief Pipeline cache. If null, the pipeline cache of the device is used
+   * (see abcg::VulkanDevice::getPipelineCache). */
   vk::PipelineCache pipelineCache{};
 };
 
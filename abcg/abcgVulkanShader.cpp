@@ -12,14 +12,27 @@
 #include "abcgException.hpp"
 
 #include <glslang/SPIRV/GlslangToSpv.h>
+#include <glslang/SPIRV/spirv.hpp>
 
 #include <fmt/core.h>
 #include <gsl/gsl>
 
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+
+#include "abcgUtil.hpp"
 
 namespace {
+// Directory of the SPIR-V cache. The cache is disabled if empty.
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+std::string spirvCacheDirectory;
+
+// Version of the SPIR-V cache key. Increment this to invalidate the cache
+// whenever the compilation settings (e.g., resource limits) change.
+constexpr int spirvCacheVersion{1};
+
 TBuiltInResource InitResources() {
   TBuiltInResource Resources{
       .maxLights = 32,
@@ -252,6 +265,61 @@ abcgStageToVulkanStage(abcg::ShaderStage stage) {
   }
   return source.str();
 }
+
+// Initializes glslang on the first call. The process is finalized on exit.
+void initializeGlslang() {
+  static std::once_flag flag;
+  std::call_once(flag, [] {
+    glslang::InitializeProcess();
+    std::atexit([] { glslang::FinalizeProcess(); });
+  });
+}
+
+// Returns the path of the cache file of the given shader, or an empty path if
+// the cache is disabled. The key combines the final source code and the stage.
+[[nodiscard]] std::filesystem::path
+spirvCachePath(abcg::ShaderSource const &source) {
+  if (spirvCacheDirectory.empty())
+    return {};
+
+  auto const key{abcg::hashCombine(spirvCacheVersion, source.source,
+                                   static_cast<int>(source.stage))};
+  return std::filesystem::path{spirvCacheDirectory} /
+         fmt::format("{:016x}.spv", key);
+}
+
+// Reads SPIR-V words from a cache file. Returns an empty vector if the file
+// does not exist or is not a valid SPIR-V module, in which case the stale file
+// is removed.
+[[nodiscard]] std::vector<uint32_t>
+loadSpirv(std::filesystem::path const &path) {
+  std::error_code errorCode;
+  auto const size{std::filesystem::file_size(path, errorCode)};
+  if (errorCode)
+    return {};
+
+  std::vector<uint32_t> code;
+  if (size >= sizeof(uint32_t) && size % sizeof(uint32_t) == 0) {
+    code.resize(size / sizeof(uint32_t));
+    if (std::ifstream stream(path, std::ios::binary);
+        !stream.read(reinterpret_cast<char *>(code.data()),
+                     gsl::narrow<std::streamsize>(size))) {
+      code.clear();
+    }
+  }
+  if (code.empty() || code.front() != spv::MagicNumber) {
+    std::filesystem::remove(path, errorCode);
+    return {};
+  }
+  return code;
+}
+
+// Writes SPIR-V words to the cache. Failures are not reported, as the cache is
+// only an optimization.
+void saveSpirv(std::vector<uint32_t> const &code,
+               std::filesystem::path const &path) {
+  abcg::writeFileAtomically(path, {std::as_bytes(std::span{code})});
+}
 } // namespace
 
 // Compiles the given GLSL shader source into Vulkan SPIR-V.
@@ -301,9 +369,28 @@ std::vector<uint32_t> GLSLtoSPV(abcg::ShaderSource shaderSource) {
   return outCode;
 }
 
+/**
+ * @brief Sets the directory of the on-disk SPIR-V cache.
+ *
+ * When the cache is enabled, abcg::VulkanShader::create looks up the SPIR-V
+ * code previously compiled from the same source code and stage before invoking
+ * the GLSL compiler. On a cache hit, the shader module is created directly from
+ * the cached code. Otherwise, the shader is compiled as usual, and its code is
+ * saved to the cache.
+ *
+ * @param directory Path to the cache directory. It is created if it does not
+ * exist. An empty path disables the cache, which is the default.
+ */
+void abcg::setVulkanShaderCacheDirectory(std::string_view directory) {
+  spirvCacheDirectory = directory;
+}
+
 /**
  * @brief Compiles a GLSL shader to SPIR-V and creates its module.
  *
+ * If the SPIR-V cache is enabled with abcg::setVulkanShaderCacheDirectory, the
+ * SPIR-V code is first looked up in the cache.
+ *
  * @param device Vulkan device to be used to create the shader module.
  * @param pathOrSource Path or source code of the GLSL shader to be compiled to
  * SPIR-V.
@@ -318,10 +405,20 @@ void abcg::VulkanShader::create(VulkanDevice const &device,
   ShaderSource const source{.source = toSource(pathOrSource.source),
                             .stage = pathOrSource.stage};
 
-  glslang::InitializeProcess();
-  std::vector<uint32_t> shader{GLSLtoSPV(source)};
   m_stage = abcgStageToVulkanStage(source.stage);
-  glslang::FinalizeProcess();
+
+  auto const cachePath{spirvCachePath(source)};
+  std::vector<uint32_t> shader;
+  if (!cachePath.empty()) {
+    shader = loadSpirv(cachePath);
+  }
+  if (shader.empty()) {
+    initializeGlslang();
+    shader = GLSLtoSPV(source);
+    if (!cachePath.empty()) {
+      saveSpirv(shader, cachePath);
+    }
+  }
 
   m_module = m_device.createShaderModule(
       {.codeSize = shader.size() * sizeof(uint32_t), .pCode = shader.data()});
@@ -11,11 +11,14 @@
 #ifndef ABCG_VULKAN_SHADER_HPP_
 #define ABCG_VULKAN_SHADER_HPP_
 
+#include <string_view>
+
 #include "abcgShader.hpp"
 #include "abcgVulkanDevice.hpp"
 
 namespace abcg {
 class VulkanShader;
+void setVulkanShaderCacheDirectory(std::string_view directory);
 } // namespace abcg
 
 /**
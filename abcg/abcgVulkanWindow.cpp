@@ -16,6 +16,7 @@
 #include <imgui_impl_sdl2.h>
 #include <imgui_impl_vulkan.h>
 
+#include "abcgApplication.hpp"
 #include "abcgEmbeddedFonts.hpp"
 #include "abcgException.hpp"
 #include "abcgVulkanError.hpp"
@@ -57,6 +58,16 @@ getRequiredExtensions(gsl::not_null<SDL_Window *> window) {
 }
 
 void checkVkResultSingleArg(VkResult retCode) { abcg::checkVkResult(retCode); }
+
+// Returns the path of the pipeline cache file, or an empty path if the cache
+// is not persisted
+[[nodiscard]] std::filesystem::path
+pipelineCachePath(abcg::VulkanSettings const &settings) {
+  if (settings.pipelineCacheFile.empty())
+    return {};
+  return std::filesystem::path{abcg::Application::getBasePath()} /
+         settings.pipelineCacheFile;
+}
 } // namespace
 
 /**
@@ -304,6 +315,9 @@ void abcg::VulkanWindow::create() {
   // Create logical device
   m_device.create(m_physicalDevice, m_deviceExtensions);
 
+  // Create pipeline cache, seeded from the previous run if possible
+  m_device.createPipelineCache(pipelineCachePath(m_vulkanSettings));
+
   // Create swapchain
   m_swapchain.create(m_device, m_vulkanSettings, getWindowSize());
 
@@ -352,7 +366,7 @@ void abcg::VulkanWindow::create() {
       .Device = static_cast<vk::Device>(m_device),
       .QueueFamily = m_physicalDevice.getQueuesFamilies().graphics.value_or(0),
       .Queue = m_device.getQueues().graphics,
-      .PipelineCache = VK_NULL_HANDLE,
+      .PipelineCache = m_device.getPipelineCache(),
       .DescriptorPool = m_UIdescriptorPool,
       .Subpass = 0,
       .MinImageCount = 2,
@@ -434,6 +448,7 @@ void abcg::VulkanWindow::destroy() {
 
   static_cast<vk::Device>(m_device).destroyDescriptorPool(m_UIdescriptorPool);
   m_swapchain.destroy();
+  m_device.destroyPipelineCache(pipelineCachePath(m_vulkanSettings));
   m_device.destroy();
   m_physicalDevice.destroy();
   static_cast<vk::Instance>(m_instance).destroySurfaceKHR(m_surface);
@@ -57,6 +57,15 @@ struct abcg::VulkanSettings {
    * comes first.
    */
   bool vSync{false};
+
+  /** @brief Name of the file where the pipeline cache is persisted between
+   * runs, relative to abcg::Application::getBasePath.
+   *
+   * The file is read on creation, if it was saved by the same physical device
+   * and driver, and is written on destruction. If empty, the pipeline cache is
+   * only kept in memory.
+   */
+  std::string pipelineCacheFile{"pipelinecache.bin"};
 };
 
 /**
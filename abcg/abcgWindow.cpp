@@ -209,6 +209,30 @@ void abcg::Window::setWindowSettings(WindowSettings const &windowSettings) {
   m_windowSettings = windowSettings;
 }
 
+/**
+ * @brief Returns whether the window is rendered offscreen.
+ *
+ * This is queried by abcg::Application::run before initializing SDL, so that
+ * a window without a visible surface can select a headless video driver.
+ * Override it in derived classes that support offscreen rendering.
+ *
+ * @returns `false` by default.
+ */
+bool abcg::Window::isOffscreen() const noexcept { return false; }
+
+/**
+ * @brief Requests offscreen rendering.
+ *
+ * This is called by abcg::Application::run before initializing SDL when
+ * offscreen rendering is requested from the command line or the environment,
+ * and overrides the settings given by the application. Override it in derived
+ * classes that support offscreen rendering.
+ *
+ * @param frames Number of frames to render, or 0 to keep the number of frames
+ * given by the application.
+ */
+void abcg::Window::setOffscreen([[maybe_unused]] int frames) noexcept {}
+
 /**
  * @brief Returns the SDL window previously created with
  * abcg::Window::createOpenGLWindow or abcg::Window::createVulkanWindow.
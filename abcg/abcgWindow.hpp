@@ -152,6 +152,9 @@ protected:
    */
   [[nodiscard]] virtual glm::ivec2 getWindowSize() const = 0;
 
+  [[nodiscard]] virtual bool isOffscreen() const noexcept;
+  virtual void setOffscreen(int frames) noexcept;
+
   [[nodiscard]] double getDeltaTime() const noexcept;
   [[nodiscard]] double getElapsedTime() const;
   [[nodiscard]] SDL_Window *getSDLWindow() const noexcept;
@@ -0,0 +1,44 @@
+#version 300 es
+
+// Attributes of each asteroid. Every asteroid is drawn as 9 consecutive
+// instances, one for each copy of the toroidal wraparound.
+layout(location = 0) in vec2 inTranslation;
+layout(location = 1) in float inRotation;
+layout(location = 2) in float inScale;
+layout(location = 3) in vec4 inColor;
+layout(location = 4) in float inPolygonSides;
+layout(location = 5) in float inSeed;
+
+out vec4 fragColor;
+
+// Pseudo-random number in [0, 1)
+float random(float seed, float n) {
+  return fract(sin(dot(vec2(seed, n), vec2(12.9898, 78.233))) * 43758.5453);
+}
+
+void main() {
+  // Vertex 0 is the center of the triangle fan. The following vertices go
+  // around the polygon, and those past the last side repeat the first vertex
+  // of the perimeter, so polygons with fewer sides get degenerate triangles.
+  vec2 position = vec2(0);
+  if (gl_VertexID > 0) {
+    int sides = int(inPolygonSides);
+    int side = min(gl_VertexID - 1, sides) % sides;
+    float angle = float(side) * 6.28318530718 / float(sides);
+    float radius = 0.8 + 0.2 * random(inSeed, float(side));
+    position = radius * vec2(cos(angle), sin(angle));
+  }
+
+  float sinAngle = sin(inRotation);
+  float cosAngle = cos(inRotation);
+  vec2 rotated = vec2(position.x * cosAngle - position.y * sinAngle,
+                      position.x * sinAngle + position.y * cosAngle);
+
+  // Offsets in {-2, 0, 2} x {-2, 0, 2}
+  int copy = gl_InstanceID % 9;
+  vec2 offset = vec2(float(copy % 3 - 1), float(copy / 3 - 1)) * 2.0;
+
+  vec2 newPosition = rotated * inScale + inTranslation + offset;
+  gl_Position = vec4(newPosition, 0, 1);
+  fragColor = inColor;
+}
\ No newline at end of file
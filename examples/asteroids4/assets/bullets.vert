@@ -0,0 +1,17 @@
+#version 300 es
+
+layout(location = 0) in vec2 inPosition;
+
+// Translation of each bullet
+layout(location = 1) in vec2 inTranslation;
+
+uniform vec4 color;
+uniform float scale;
+
+out vec4 fragColor;
+
+void main() {
+  vec2 newPosition = inPosition * scale + inTranslation;
+  gl_Position = vec4(newPosition, 0, 1);
+  fragColor = color;
+}
\ No newline at end of file
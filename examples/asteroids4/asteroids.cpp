@@ -2,7 +2,7 @@
 
 #include <glm/gtx/fast_trigonometry.hpp>
 
-void Asteroids::create(GLuint program, int quantity) {
+void Asteroids::create(GLuint program, int quantity, float scale) {
   destroy();
 
   m_randomEngine.seed(
@@ -10,139 +10,148 @@ void Asteroids::create(GLuint program, int quantity) {
 
   m_program = program;
 
-  // Get location of uniforms in the program
-  m_colorLoc = abcg::glGetUniformLocation(m_program, "color");
-  m_rotationLoc = abcg::glGetUniformLocation(m_program, "rotation");
-  m_scaleLoc = abcg::glGetUniformLocation(m_program, "scale");
-  m_translationLoc = abcg::glGetUniformLocation(m_program, "translation");
+  // Generate instance VBO. Its storage is allocated in paint.
+  abcg::glGenBuffers(1, &m_instanceVBO);
+
+  // Create VAO
+  abcg::glGenVertexArrays(1, &m_VAO);
+
+  // Bind instance attributes to current VAO
+  abcg::glBindVertexArray(m_VAO);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+
+  // Each asteroid is drawn as 9 instances that read the same attributes
+  auto const bindAttribute{[&](char const *name, GLint size,
+                               std::size_t offset) {
+    auto const attribute{abcg::glGetAttribLocation(m_program, name)};
+    if (attribute < 0)
+      return;
+    abcg::glEnableVertexAttribArray(attribute);
+    abcg::glVertexAttribPointer(attribute, size, GL_FLOAT, GL_FALSE,
+                                sizeof(Instance),
+                                reinterpret_cast<void *>(offset));
+    abcg::glVertexAttribDivisor(attribute, 9);
+  }};
+  bindAttribute("inTranslation", 2, offsetof(Instance, translation));
+  bindAttribute("inRotation", 1, offsetof(Instance, rotation));
+  bindAttribute("inScale", 1, offsetof(Instance, scale));
+  bindAttribute("inColor", 4, offsetof(Instance, color));
+  bindAttribute("inPolygonSides", 1, offsetof(Instance, polygonSides));
+  bindAttribute("inSeed", 1, offsetof(Instance, radiusSeed));
+
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // End of binding to current VAO
+  abcg::glBindVertexArray(0);
 
   // Create asteroids
   m_asteroids.clear();
-  m_asteroids.resize(quantity);
-
-  for (auto &asteroid : m_asteroids) {
-    asteroid = makeAsteroid();
+  m_asteroids.reserve(gsl::narrow<std::size_t>(quantity));
 
+  for ([[maybe_unused]] auto const index : iter::range(quantity)) {
     // Make sure the asteroid won't collide with the ship
+    glm::vec2 translation{};
     do {
-      asteroid.m_translation = {m_randomDist(m_randomEngine),
-                                m_randomDist(m_randomEngine)};
-    } while (glm::length(asteroid.m_translation) < 0.5f);
+      translation = {m_randomDist(m_randomEngine),
+                     m_randomDist(m_randomEngine)};
+    } while (glm::length(translation) < 0.5f);
+
+    spawn(translation, scale);
   }
 }
 
 void Asteroids::paint() {
-  abcg::glUseProgram(m_program);
-
-  for (auto const &asteroid : m_asteroids) {
-    abcg::glBindVertexArray(asteroid.m_VAO);
-
-    abcg::glUniform4fv(m_colorLoc, 1, &asteroid.m_color.r);
-    abcg::glUniform1f(m_scaleLoc, asteroid.m_scale);
-    abcg::glUniform1f(m_rotationLoc, asteroid.m_rotation);
+  if (m_asteroids.empty())
+    return;
+
+  auto const translations{m_asteroids.get<Translation>()};
+  auto const rotations{m_asteroids.get<Rotation>()};
+  auto const scales{m_asteroids.get<Scale>()};
+  auto const colors{m_asteroids.get<Color>()};
+  auto const polygonSides{m_asteroids.get<PolygonSides>()};
+  auto const radiusSeeds{m_asteroids.get<RadiusSeed>()};
+
+  // The capacity of the array is kept between frames
+  m_instances.resize(m_asteroids.size());
+  for (auto const index : iter::range(m_asteroids.size())) {
+    m_instances[index] = {
+        .translation = translations[index],
+        .rotation = rotations[index],
+        .scale = scales[index],
+        .color = colors[index],
+        .polygonSides = gsl::narrow_cast<float>(polygonSides[index]),
+        .radiusSeed = radiusSeeds[index]};
+  }
 
-    for (auto i : {-2, 0, 2}) {
-      for (auto j : {-2, 0, 2}) {
-        abcg::glUniform2f(m_translationLoc, asteroid.m_translation.x + j,
-                          asteroid.m_translation.y + i);
+  // Orphan the previous storage before uploading the new attributes
+  auto const size{
+      gsl::narrow<GLsizeiptr>(m_instances.size() * sizeof(Instance))};
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+  abcg::glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  abcg::glBufferSubData(GL_ARRAY_BUFFER, 0, size, m_instances.data());
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-        abcg::glDrawArrays(GL_TRIANGLE_FAN, 0, asteroid.m_polygonSides + 2);
-      }
-    }
+  abcg::glUseProgram(m_program);
+  abcg::glBindVertexArray(m_VAO);
 
-    abcg::glBindVertexArray(0);
-  }
+  // Center of the fan, the vertices of the polygon and the first vertex again
+  abcg::glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, maxPolygonSides + 2,
+                              gsl::narrow<GLsizei>(m_instances.size() * 9));
 
+  abcg::glBindVertexArray(0);
   abcg::glUseProgram(0);
 }
 
 void Asteroids::destroy() {
-  for (auto &asteroid : m_asteroids) {
-    abcg::glDeleteBuffers(1, &asteroid.m_VBO);
-    abcg::glDeleteVertexArrays(1, &asteroid.m_VAO);
-  }
+  abcg::glDeleteBuffers(1, &m_instanceVBO);
+  abcg::glDeleteVertexArrays(1, &m_VAO);
+  m_instanceVBO = 0;
+  m_VAO = 0;
 }
 
 void Asteroids::update(const Ship &ship, float deltaTime) {
-  for (auto &asteroid : m_asteroids) {
-    asteroid.m_translation -= ship.m_velocity * deltaTime;
-    asteroid.m_rotation = glm::wrapAngle(
-        asteroid.m_rotation + asteroid.m_angularVelocity * deltaTime);
-    asteroid.m_translation += asteroid.m_velocity * deltaTime;
+  auto const translations{m_asteroids.get<Translation>()};
+  auto const velocities{m_asteroids.get<Velocity>()};
+  for (auto const index : iter::range(m_asteroids.size())) {
+    auto &translation{translations[index]};
+    translation += (velocities[index] - ship.m_velocity) * deltaTime;
 
     // Wrap-around
-    if (asteroid.m_translation.x < -1.0f)
-      asteroid.m_translation.x += 2.0f;
-    if (asteroid.m_translation.x > +1.0f)
-      asteroid.m_translation.x -= 2.0f;
-    if (asteroid.m_translation.y < -1.0f)
-      asteroid.m_translation.y += 2.0f;
-    if (asteroid.m_translation.y > +1.0f)
-      asteroid.m_translation.y -= 2.0f;
+    translation -= 2.0f * glm::round(translation / 2.0f);
   }
-}
 
-Asteroids::Asteroid Asteroids::makeAsteroid(glm::vec2 translation,
-                                            float scale) {
-  Asteroid asteroid;
+  auto const rotations{m_asteroids.get<Rotation>()};
+  auto const angularVelocities{m_asteroids.get<AngularVelocity>()};
+  for (auto const index : iter::range(m_asteroids.size())) {
+    rotations[index] = glm::wrapAngle(rotations[index] +
+                                      angularVelocities[index] * deltaTime);
+  }
+}
 
+void Asteroids::spawn(glm::vec2 translation, float scale) {
   auto &re{m_randomEngine}; // Shortcut
 
   // Randomly pick the number of sides
-  std::uniform_int_distribution randomSides(6, 20);
-  asteroid.m_polygonSides = randomSides(re);
+  std::uniform_int_distribution randomSides(6, maxPolygonSides);
+  auto const polygonSides{randomSides(re)};
+
+  // Seed of the random radius of each vertex, which is computed in the vertex
+  // shader
+  std::uniform_real_distribution randomSeed(0.0f, 100.0f);
+  auto const radiusSeed{randomSeed(re)};
 
   // Get a random color (actually, a grayscale)
   std::uniform_real_distribution randomIntensity(0.5f, 1.0f);
-  asteroid.m_color = glm::vec4(randomIntensity(re));
-
-  asteroid.m_color.a = 1.0f;
-  asteroid.m_rotation = 0.0f;
-  asteroid.m_scale = scale;
-  asteroid.m_translation = translation;
+  glm::vec4 color{randomIntensity(re)};
+  color.a = 1.0f;
 
   // Get a random angular velocity
-  asteroid.m_angularVelocity = m_randomDist(re);
+  auto const angularVelocity{m_randomDist(re)};
 
   // Get a random direction
   glm::vec2 const direction{m_randomDist(re), m_randomDist(re)};
-  asteroid.m_velocity = glm::normalize(direction) / 7.0f;
-
-  // Create geometry data
-  std::vector<glm::vec2> positions{{0, 0}};
-  auto const step{M_PI * 2 / asteroid.m_polygonSides};
-  std::uniform_real_distribution randomRadius(0.8f, 1.0f);
-  for (auto const angle : iter::range(0.0, M_PI * 2, step)) {
-    auto const radius{randomRadius(re)};
-    positions.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
-  }
-  positions.push_back(positions.at(1));
-
-  // Generate VBO
-  abcg::glGenBuffers(1, &asteroid.m_VBO);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, asteroid.m_VBO);
-  abcg::glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2),
-                     positions.data(), GL_STATIC_DRAW);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  // Get location of attributes in the program
-  auto const positionAttribute{
-      abcg::glGetAttribLocation(m_program, "inPosition")};
-
-  // Create VAO
-  abcg::glGenVertexArrays(1, &asteroid.m_VAO);
-
-  // Bind vertex attributes to current VAO
-  abcg::glBindVertexArray(asteroid.m_VAO);
-
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, asteroid.m_VBO);
-  abcg::glEnableVertexAttribArray(positionAttribute);
-  abcg::glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0,
-                              nullptr);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  // End of binding to current VAO
-  abcg::glBindVertexArray(0);
+  auto const velocity{glm::normalize(direction) / 7.0f};
 
-  return asteroid;
+  m_asteroids.insert(translation, velocity, 0.0f, angularVelocity, scale,
+                     color, polygonSides, radiusSeed, 0);
 }
\ No newline at end of file
@@ -1,8 +1,9 @@
 #ifndef ASTEROIDS_HPP_
 #define ASTEROIDS_HPP_
 
-#include <list>
+#include <cstdint>
 #include <random>
+#include <vector>
 
 #include "abcgOpenGL.hpp"
 
@@ -11,35 +12,50 @@
 
 class Asteroids {
 public:
-  void create(GLuint program, int quantity);
+  void create(GLuint program, int quantity, float scale = 0.25f);
   void paint();
   void destroy();
   void update(const Ship &ship, float deltaTime);
 
-  struct Asteroid {
-    GLuint m_VAO{};
-    GLuint m_VBO{};
-
-    float m_angularVelocity{};
-    glm::vec4 m_color{1};
-    int m_polygonSides{};
-    float m_rotation{};
-    float m_scale{};
-    glm::vec2 m_translation{};
-    glm::vec2 m_velocity{};
-    bool m_hit{};
+  // Indices of the components of each asteroid in m_asteroids
+  enum Component : std::size_t {
+    Translation,
+    Velocity,
+    Rotation,
+    AngularVelocity,
+    Scale,
+    Color,
+    PolygonSides,
+    RadiusSeed,
+    Hit
   };
 
-  std::list<Asteroid> m_asteroids;
+  abcg::SoAPool<glm::vec2, glm::vec2, float, float, float, glm::vec4, int,
+                float, std::uint8_t>
+      m_asteroids;
 
-  Asteroid makeAsteroid(glm::vec2 translation = {}, float scale = 0.25f);
+  void spawn(glm::vec2 translation = {}, float scale = 0.25f);
+
+  static constexpr int maxPolygonSides{20};
 
 private:
+  // Per-instance attributes of an asteroid
+  struct Instance {
+    glm::vec2 translation{};
+    float rotation{};
+    float scale{};
+    glm::vec4 color{};
+    float polygonSides{};
+    float radiusSeed{};
+  };
+
   GLuint m_program{};
-  GLint m_colorLoc{};
-  GLint m_rotationLoc{};
-  GLint m_translationLoc{};
-  GLint m_scaleLoc{};
+
+  // All asteroids are drawn from the same VAO. The vertices of the polygons
+  // are computed in the vertex shader, so only the instance VBO is bound.
+  GLuint m_VAO{};
+  GLuint m_instanceVBO{};
+  std::vector<Instance> m_instances;
 
   std::default_random_engine m_randomEngine;
   std::uniform_real_distribution<float> m_randomDist{-1.0f, 1.0f};
@@ -9,15 +9,16 @@ void Bullets::create(GLuint program) {
 
   // Get location of uniforms in the program
   m_colorLoc = abcg::glGetUniformLocation(m_program, "color");
-  m_rotationLoc = abcg::glGetUniformLocation(m_program, "rotation");
   m_scaleLoc = abcg::glGetUniformLocation(m_program, "scale");
-  m_translationLoc = abcg::glGetUniformLocation(m_program, "translation");
 
   // Get location of attributes in the program
   auto const positionAttribute{
       abcg::glGetAttribLocation(m_program, "inPosition")};
+  auto const translationAttribute{
+      abcg::glGetAttribLocation(m_program, "inTranslation")};
 
   m_bullets.clear();
+  m_bullets.reserve(256);
 
   // Create geometry data
   auto const sides{10};
@@ -35,6 +36,9 @@ void Bullets::create(GLuint program) {
                      positions.data(), GL_STATIC_DRAW);
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+  // Generate instance VBO. Its storage is allocated in paint.
+  abcg::glGenBuffers(1, &m_instanceVBO);
+
   // Create VAO
   abcg::glGenVertexArrays(1, &m_VAO);
 
@@ -45,6 +49,12 @@ void Bullets::create(GLuint program) {
   abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
   abcg::glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0,
                               nullptr);
+
+  abcg::glEnableVertexAttribArray(translationAttribute);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+  abcg::glVertexAttribPointer(translationAttribute, 2, GL_FLOAT, GL_FALSE, 0,
+                              nullptr);
+  abcg::glVertexAttribDivisor(translationAttribute, 1);
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
   // End of binding to current VAO
@@ -52,19 +62,26 @@ void Bullets::create(GLuint program) {
 }
 
 void Bullets::paint() {
+  if (m_bullets.empty())
+    return;
+
+  // The translations are stored contiguously, so they are uploaded as they
+  // are. The previous storage is orphaned first.
+  auto const translations{m_bullets.get<Translation>()};
+  auto const size{gsl::narrow<GLsizeiptr>(translations.size_bytes())};
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+  abcg::glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  abcg::glBufferSubData(GL_ARRAY_BUFFER, 0, size, translations.data());
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
   abcg::glUseProgram(m_program);
 
   abcg::glBindVertexArray(m_VAO);
   abcg::glUniform4f(m_colorLoc, 1, 1, 1, 1);
-  abcg::glUniform1f(m_rotationLoc, 0);
   abcg::glUniform1f(m_scaleLoc, m_scale);
 
-  for (auto const &bullet : m_bullets) {
-    abcg::glUniform2f(m_translationLoc, bullet.m_translation.x,
-                      bullet.m_translation.y);
-
-    abcg::glDrawArrays(GL_TRIANGLE_FAN, 0, 12);
-  }
+  abcg::glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 12,
+                              gsl::narrow<GLsizei>(translations.size()));
 
   abcg::glBindVertexArray(0);
 
@@ -73,6 +90,7 @@ void Bullets::paint() {
 
 void Bullets::destroy() {
   abcg::glDeleteBuffers(1, &m_VBO);
+  abcg::glDeleteBuffers(1, &m_instanceVBO);
   abcg::glDeleteVertexArrays(1, &m_VAO);
 }
 
@@ -90,34 +108,33 @@ void Bullets::update(Ship &ship, const GameData &gameData, float deltaTime) {
       auto const cannonOffset{(11.0f / 15.5f) * ship.m_scale};
       auto const bulletSpeed{2.0f};
 
-      Bullet bullet{.m_dead = false,
-                    .m_translation = ship.m_translation + right * cannonOffset,
-                    .m_velocity = ship.m_velocity + forward * bulletSpeed};
-      m_bullets.push_back(bullet);
-
-      bullet.m_translation = ship.m_translation - right * cannonOffset;
-      m_bullets.push_back(bullet);
+      auto const velocity{ship.m_velocity + forward * bulletSpeed};
+      spawn(ship.m_translation + right * cannonOffset, velocity);
+      spawn(ship.m_translation - right * cannonOffset, velocity);
 
       // Moves ship in the opposite direction
       ship.m_velocity -= forward * 0.1f;
     }
   }
 
-  for (auto &bullet : m_bullets) {
-    bullet.m_translation -= ship.m_velocity * deltaTime;
-    bullet.m_translation += bullet.m_velocity * deltaTime;
+  auto const translations{m_bullets.get<Translation>()};
+  auto const velocities{m_bullets.get<Velocity>()};
+  auto const dead{m_bullets.get<Dead>()};
+  for (auto const index : iter::range(m_bullets.size())) {
+    auto &translation{translations[index]};
+    translation += (velocities[index] - ship.m_velocity) * deltaTime;
 
     // Kill bullet if it goes off screen
-    if (bullet.m_translation.x < -1.1f)
-      bullet.m_dead = true;
-    if (bullet.m_translation.x > +1.1f)
-      bullet.m_dead = true;
-    if (bullet.m_translation.y < -1.1f)
-      bullet.m_dead = true;
-    if (bullet.m_translation.y > +1.1f)
-      bullet.m_dead = true;
+    if (glm::any(glm::greaterThan(glm::abs(translation), glm::vec2{1.1f})))
+      dead[index] = 1;
   }
 
   // Remove dead bullets
-  m_bullets.remove_if([](auto const &p) { return p.m_dead; });
+  m_bullets.eraseIf([&](std::size_t index) {
+    return m_bullets.get<Dead>()[index] != 0;
+  });
+}
+
+void Bullets::spawn(glm::vec2 translation, glm::vec2 velocity) {
+  m_bullets.insert(translation, velocity, 0);
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #ifndef BULLETS_HPP_
 #define BULLETS_HPP_
 
-#include <list>
+#include <cstdint>
 
 #include "abcgOpenGL.hpp"
 
@@ -17,25 +17,25 @@ public:
   void destroy();
   void update(Ship &ship, const GameData &gameData, float deltaTime);
 
-  struct Bullet {
-    bool m_dead{};
-    glm::vec2 m_translation{};
-    glm::vec2 m_velocity{};
-  };
+  // Indices of the components of each bullet in m_bullets
+  enum Component : std::size_t { Translation, Velocity, Dead };
 
-  std::list<Bullet> m_bullets;
+  abcg::SoAPool<glm::vec2, glm::vec2, std::uint8_t> m_bullets;
+
+  void spawn(glm::vec2 translation, glm::vec2 velocity);
 
   float m_scale{0.015f};
 
 private:
   GLuint m_program{};
   GLint m_colorLoc{};
-  GLint m_rotationLoc{};
-  GLint m_translationLoc{};
   GLint m_scaleLoc{};
 
+  // All bullets are drawn with a single instanced draw call. The translations
+  // are uploaded to the instance VBO straight from m_bullets.
   GLuint m_VAO{};
   GLuint m_VBO{};
+  GLuint m_instanceVBO{};
 };
 
 #endif
\ No newline at end of file
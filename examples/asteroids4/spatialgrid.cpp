@@ -0,0 +1,43 @@
+#include "spatialgrid.hpp"
+
+#include <numeric>
+
+void SpatialGrid::build(std::span<glm::vec2 const> positions,
+                        std::span<float const> radii) {
+  auto const count{std::min(positions.size(), radii.size())};
+
+  // Cells about twice as large as the average diameter of the objects, so
+  // that most objects overlap at most four cells
+  auto const meanRadius{
+      count > 0 ? std::accumulate(radii.begin(), radii.begin() + count, 0.0) /
+                      gsl::narrow_cast<double>(count)
+                : 1.0};
+  m_resolution =
+      meanRadius > 0.0
+          ? std::clamp(static_cast<int>(2.0 / (4.0 * meanRadius)), 1,
+                       maxResolution)
+          : maxResolution;
+  m_cellSize = 2.0f / gsl::narrow_cast<float>(m_resolution);
+
+  // Count the objects of each cell
+  auto const numCells{
+      gsl::narrow_cast<std::size_t>(m_resolution * m_resolution)};
+  m_offsets.assign(numCells + 1, 0);
+  for (auto const index : iter::range(count)) {
+    forEachCell(positions[index], radii[index],
+                [&](std::size_t cell) { ++m_offsets[cell + 1]; });
+  }
+  std::partial_sum(m_offsets.begin(), m_offsets.end(), m_offsets.begin());
+
+  // Store the objects grouped by cell
+  m_objects.resize(m_offsets.back());
+  m_cursors.assign(m_offsets.begin(), m_offsets.end() - 1);
+  for (auto const index : iter::range(count)) {
+    forEachCell(positions[index], radii[index], [&](std::size_t cell) {
+      m_objects[m_cursors[cell]++] = gsl::narrow_cast<std::uint32_t>(index);
+    });
+  }
+
+  m_visited.assign(count, 0);
+  m_query = 0;
+}
\ No newline at end of file
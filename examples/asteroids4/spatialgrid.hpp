@@ -0,0 +1,100 @@
+#ifndef SPATIALGRID_HPP_
+#define SPATIALGRID_HPP_
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "abcgOpenGL.hpp"
+
+// Uniform grid over the world [-1, 1] x [-1, 1], which wraps around at its
+// borders. Each object is bounded by a circle and stored in every cell
+// overlapped by the bounding square of the circle, so that a query only
+// visits the cells overlapped by the query circle.
+class SpatialGrid {
+public:
+  static constexpr int maxResolution{64};
+
+  void build(std::span<glm::vec2 const> positions,
+             std::span<float const> radii);
+
+  // Calls visit(index) once for each object whose bounding square overlaps
+  // the bounding square of the circle
+  template <typename Visitor>
+  void query(glm::vec2 const &position, float radius, Visitor &&visit);
+
+  [[nodiscard]] int getResolution() const { return m_resolution; }
+
+private:
+  int m_resolution{1};
+  float m_cellSize{2.0f};
+
+  // The objects of cell i are m_objects[m_offsets[i]], ...,
+  // m_objects[m_offsets[i + 1] - 1]
+  std::vector<std::uint32_t> m_offsets;
+  std::vector<std::uint32_t> m_objects;
+  std::vector<std::uint32_t> m_cursors;
+
+  // Query in which each object was last visited, so that objects stored in
+  // several cells are visited once
+  std::vector<std::uint32_t> m_visited;
+  std::uint32_t m_query{};
+
+  template <typename Function>
+  void forEachCell(glm::vec2 const &position, float radius,
+                   Function &&function) const;
+};
+
+template <typename Visitor>
+void SpatialGrid::query(glm::vec2 const &position, float radius,
+                        Visitor &&visit) {
+  if (++m_query == 0) {
+    std::ranges::fill(m_visited, 0);
+    m_query = 1;
+  }
+
+  forEachCell(position, radius, [&](std::size_t cell) {
+    for (auto index{m_offsets[cell]}; index < m_offsets[cell + 1]; ++index) {
+      auto const object{m_objects[index]};
+      if (m_visited[object] != m_query) {
+        m_visited[object] = m_query;
+        visit(std::size_t{object});
+      }
+    }
+  });
+}
+
+template <typename Function>
+void SpatialGrid::forEachCell(glm::vec2 const &position, float radius,
+                              Function &&function) const {
+  // Position wrapped to [-1, 1]
+  auto const wrapped{position - 2.0f * glm::round(position / 2.0f)};
+
+  auto const cellRange{[&](float center) {
+    auto first{static_cast<int>(
+        std::floor((center - radius + 1.0f) / m_cellSize))};
+    auto last{static_cast<int>(
+        std::floor((center + radius + 1.0f) / m_cellSize))};
+    // Visit each cell once if the range covers the whole grid
+    if (last - first + 1 >= m_resolution) {
+      first = 0;
+      last = m_resolution - 1;
+    }
+    return std::pair{first, last};
+  }};
+  auto const wrap{[&](int cell) {
+    return (cell % m_resolution + m_resolution) % m_resolution;
+  }};
+
+  auto const [firstX, lastX]{cellRange(wrapped.x)};
+  auto const [firstY, lastY]{cellRange(wrapped.y)};
+  for (auto y{firstY}; y <= lastY; ++y) {
+    auto const row{gsl::narrow_cast<std::size_t>(wrap(y) * m_resolution)};
+    for (auto x{firstX}; x <= lastX; ++x) {
+      function(row + gsl::narrow_cast<std::size_t>(wrap(x)));
+    }
+  }
+}
+
+#endif
\ No newline at end of file
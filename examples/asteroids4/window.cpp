@@ -1,5 +1,23 @@
 #include "window.hpp"
 
+#include <utility>
+
+namespace {
+// Shortest difference between two positions of the toroidal space in which
+// [-1, 1] wraps around, so no copies of the objects need to be tested
+glm::vec2 wrappedDifference(glm::vec2 const &a, glm::vec2 const &b) {
+  auto const difference{a - b};
+  return difference - 2.0f * glm::round(difference / 2.0f);
+}
+
+// Number of asteroids kept on screen in stress mode, and their scale
+constexpr int stressAsteroids{3000};
+constexpr float stressAsteroidScale{0.02f};
+
+// Number of bullets fired in all directions each frame in stress mode
+constexpr int stressBulletsPerFrame{64};
+} // namespace
+
 void Window::onEvent(SDL_Event const &event) {
   // Keyboard events
   if (event.type == SDL_KEYDOWN) {
@@ -68,6 +86,20 @@ void Window::onCreate() {
                                  {.source = assetsPath + "objects.frag",
                                   .stage = abcg::ShaderStage::Fragment}});
 
+  // Create program to render the asteroids
+  m_asteroidsProgram =
+      abcg::createOpenGLProgram({{.source = assetsPath + "asteroids.vert",
+                                  .stage = abcg::ShaderStage::Vertex},
+                                 {.source = assetsPath + "objects.frag",
+                                  .stage = abcg::ShaderStage::Fragment}});
+
+  // Create program to render the bullets
+  m_bulletsProgram =
+      abcg::createOpenGLProgram({{.source = assetsPath + "bullets.vert",
+                                  .stage = abcg::ShaderStage::Vertex},
+                                 {.source = assetsPath + "objects.frag",
+                                  .stage = abcg::ShaderStage::Fragment}});
+
   // Create program to render the stars
   m_starsProgram =
       abcg::createOpenGLProgram({{.source = assetsPath + "stars.vert",
@@ -93,8 +125,13 @@ void Window::restart() {
 
   m_starLayers.create(m_starsProgram, 25);
   m_ship.create(m_objectsProgram);
-  m_asteroids.create(m_objectsProgram, 3);
-  m_bullets.create(m_objectsProgram);
+  if (m_stressMode) {
+    m_asteroids.create(m_asteroidsProgram, stressAsteroids,
+                       stressAsteroidScale);
+  } else {
+    m_asteroids.create(m_asteroidsProgram, 3);
+  }
+  m_bullets.create(m_bulletsProgram);
 }
 
 void Window::onUpdate() {
@@ -112,12 +149,37 @@ void Window::onUpdate() {
   m_asteroids.update(m_ship, deltaTime);
   m_bullets.update(m_ship, m_gameData, deltaTime);
 
+  if (m_stressMode) {
+    updateStressMode();
+  }
+
   if (m_gameData.m_state == State::Playing) {
     checkCollisions();
     checkWinCondition();
   }
 }
 
+void Window::updateStressMode() {
+  std::uniform_real_distribution randomDist{-1.0f, 1.0f};
+
+  // Replace the asteroids destroyed in the last frame
+  while (std::cmp_less(m_asteroids.m_asteroids.size(), stressAsteroids)) {
+    glm::vec2 const translation{randomDist(m_randomEngine),
+                                randomDist(m_randomEngine)};
+    m_asteroids.spawn(translation, stressAsteroidScale);
+  }
+
+  // Fire bullets from the ship in random directions
+  std::uniform_real_distribution randomAngle{0.0f, glm::two_pi<float>()};
+  for ([[maybe_unused]] auto const bullet :
+       iter::range(stressBulletsPerFrame)) {
+    auto const angle{randomAngle(m_randomEngine)};
+    glm::vec2 const direction{std::cos(angle), std::sin(angle)};
+    m_bullets.spawn(m_ship.m_translation,
+                    m_ship.m_velocity + direction * 2.0f);
+  }
+}
+
 void Window::onPaint() {
   abcg::glClear(GL_COLOR_BUFFER_BIT);
   abcg::glViewport(0, 0, m_viewportSize.x, m_viewportSize.y);
@@ -152,6 +214,24 @@ void Window::onPaintUI() {
     ImGui::PopFont();
     ImGui::End();
   }
+
+  {
+    auto const widgetSize{ImVec2(220, m_stressMode ? 100 : 35)};
+    ImGui::SetNextWindowPos(ImVec2(5, 5));
+    ImGui::SetNextWindowSize(widgetSize);
+    ImGui::Begin("Stress mode", nullptr, ImGuiWindowFlags_NoDecoration);
+
+    if (ImGui::Checkbox("Stress mode", &m_stressMode)) {
+      restart();
+    }
+    if (m_stressMode) {
+      ImGui::Text("%zu asteroids", m_asteroids.m_asteroids.size());
+      ImGui::Text("%zu bullets", m_bullets.m_bullets.size());
+      ImGui::Text("Collisions: %.2f ms", m_collisionTime);
+    }
+
+    ImGui::End();
+  }
 }
 
 void Window::onResize(glm::ivec2 const &size) {
@@ -163,6 +243,8 @@ void Window::onResize(glm::ivec2 const &size) {
 void Window::onDestroy() {
   abcg::glDeleteProgram(m_starsProgram);
   abcg::glDeleteProgram(m_objectsProgram);
+  abcg::glDeleteProgram(m_asteroidsProgram);
+  abcg::glDeleteProgram(m_bulletsProgram);
 
   m_asteroids.destroy();
   m_bullets.destroy();
@@ -171,58 +253,82 @@ void Window::onDestroy() {
 }
 
 void Window::checkCollisions() {
+  abcg::Timer timer;
+
+  auto &asteroids{m_asteroids.m_asteroids};
+  auto const asteroidTranslations{asteroids.get<Asteroids::Translation>()};
+  auto const asteroidScales{asteroids.get<Asteroids::Scale>()};
+  auto const asteroidHits{asteroids.get<Asteroids::Hit>()};
+
+  // Rebuild the grid of asteroids
+  m_gridRadii.resize(asteroids.size());
+  for (auto const index : iter::range(asteroids.size())) {
+    m_gridRadii[index] = asteroidScales[index] * 0.85f;
+  }
+  m_asteroidGrid.build(asteroidTranslations, m_gridRadii);
+
   // Check collision between ship and asteroids
-  for (auto const &asteroid : m_asteroids.m_asteroids) {
-    auto const asteroidTranslation{asteroid.m_translation};
-    auto const distance{
-        glm::distance(m_ship.m_translation, asteroidTranslation)};
+  auto const shipRadius{m_ship.m_scale * 0.9f};
+  m_asteroidGrid.query(m_ship.m_translation, shipRadius, [&](auto index) {
+    auto const distance{glm::length(wrappedDifference(
+        m_ship.m_translation, asteroidTranslations[index]))};
 
-    if (distance < m_ship.m_scale * 0.9f + asteroid.m_scale * 0.85f) {
+    if (distance < shipRadius + m_gridRadii[index] && !m_stressMode) {
       m_gameData.m_state = State::GameOver;
       m_restartWaitTimer.restart();
     }
-  }
+  });
 
   // Check collision between bullets and asteroids
-  for (auto &bullet : m_bullets.m_bullets) {
-    if (bullet.m_dead)
+  auto &bullets{m_bullets.m_bullets};
+  auto const bulletTranslations{bullets.get<Bullets::Translation>()};
+  auto const bulletDead{bullets.get<Bullets::Dead>()};
+  for (auto const bullet : iter::range(bullets.size())) {
+    if (bulletDead[bullet] != 0)
       continue;
 
-    for (auto &asteroid : m_asteroids.m_asteroids) {
-      for (auto const i : {-2, 0, 2}) {
-        for (auto const j : {-2, 0, 2}) {
-          auto const asteroidTranslation{asteroid.m_translation +
-                                         glm::vec2(i, j)};
-          auto const distance{
-              glm::distance(bullet.m_translation, asteroidTranslation)};
-
-          if (distance < m_bullets.m_scale + asteroid.m_scale * 0.85f) {
-            asteroid.m_hit = true;
-            bullet.m_dead = true;
-          }
-        }
-      }
-    }
+    auto const bulletTranslation{bulletTranslations[bullet]};
+    m_asteroidGrid.query(bulletTranslation, m_bullets.m_scale, [&](auto index) {
+      auto const distance{glm::length(
+          wrappedDifference(bulletTranslation, asteroidTranslations[index]))};
 
-    // Break asteroids marked as hit
-    for (auto const &asteroid : m_asteroids.m_asteroids) {
-      if (asteroid.m_hit && asteroid.m_scale > 0.10f) {
-        std::uniform_real_distribution randomDist{-1.0f, 1.0f};
-        std::generate_n(std::back_inserter(m_asteroids.m_asteroids), 3, [&]() {
-          glm::vec2 const offset{randomDist(m_randomEngine),
-                                 randomDist(m_randomEngine)};
-          auto const newScale{asteroid.m_scale * 0.5f};
-          return m_asteroids.makeAsteroid(
-              asteroid.m_translation + offset * newScale, newScale);
-        });
+      if (distance < m_bullets.m_scale + m_gridRadii[index]) {
+        asteroidHits[index] = 1;
+        bulletDead[bullet] = 1;
       }
-    }
+    });
+  }
+
+  // Break asteroids marked as hit. Spawning invalidates the arrays, so the
+  // values of each asteroid are copied first. New pieces are appended after
+  // the asteroids that existed before the loop.
+  std::uniform_real_distribution randomDist{-1.0f, 1.0f};
+  auto const numAsteroids{asteroids.size()};
+  for (auto const index : iter::range(numAsteroids)) {
+    auto const scale{asteroids.get<Asteroids::Scale>()[index]};
+    if (asteroids.get<Asteroids::Hit>()[index] == 0 || scale <= 0.10f)
+      continue;
 
-    m_asteroids.m_asteroids.remove_if([](auto const &a) { return a.m_hit; });
+    auto const translation{asteroids.get<Asteroids::Translation>()[index]};
+    auto const newScale{scale * 0.5f};
+    for ([[maybe_unused]] auto const piece : iter::range(3)) {
+      glm::vec2 const offset{randomDist(m_randomEngine),
+                             randomDist(m_randomEngine)};
+      m_asteroids.spawn(translation + offset * newScale, newScale);
+    }
   }
+
+  asteroids.eraseIf([&](std::size_t index) {
+    return asteroids.get<Asteroids::Hit>()[index] != 0;
+  });
+
+  m_collisionTime = timer.elapsed() * 1000.0;
 }
 
 void Window::checkWinCondition() {
+  if (m_stressMode)
+    return;
+
   if (m_asteroids.m_asteroids.empty()) {
     m_gameData.m_state = State::Win;
     m_restartWaitTimer.restart();
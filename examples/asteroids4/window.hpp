@@ -2,12 +2,14 @@
 #define WINDOW_HPP_
 
 #include <random>
+#include <vector>
 
 #include "abcgOpenGL.hpp"
 
 #include "asteroids.hpp"
 #include "bullets.hpp"
 #include "ship.hpp"
+#include "spatialgrid.hpp"
 #include "starlayers.hpp"
 
 class Window : public abcg::OpenGLWindow {
@@ -25,6 +27,8 @@ private:
 
   GLuint m_starsProgram{};
   GLuint m_objectsProgram{};
+  GLuint m_asteroidsProgram{};
+  GLuint m_bulletsProgram{};
 
   GameData m_gameData;
 
@@ -35,12 +39,21 @@ private:
 
   abcg::Timer m_restartWaitTimer;
 
+  // Grid of asteroids rebuilt every frame, and their collision radii
+  SpatialGrid m_asteroidGrid;
+  std::vector<float> m_gridRadii;
+  double m_collisionTime{};
+
+  // Keeps thousands of asteroids and bullets on screen, and the ship alive
+  bool m_stressMode{};
+
   ImFont *m_font{};
 
   std::default_random_engine m_randomEngine;
 
   void restart();
   void checkCollisions();
+  void updateStressMode();
   void checkWinCondition();
 };
 
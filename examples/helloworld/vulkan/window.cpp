@@ -142,6 +142,10 @@ void Window::destroyBuffers() { m_vertexBuffer.destroy(); }
 void Window::createShaders() {
   auto const assetsPath{abcg::Application::getAssetsPath()};
 
+  // Reuse SPIR-V code from previous runs
+  abcg::setVulkanShaderCacheDirectory(abcg::Application::getBasePath() +
+                                      "/shadercache");
+
   // Crete vertex shader
   m_vertexShader.create(getDevice(),
                         {.source = assetsPath + "UnlitVertexColor.vert",
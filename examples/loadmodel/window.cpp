@@ -1,15 +1,6 @@
 #include "window.hpp"
 
 #include <glm/gtx/fast_trigonometry.hpp>
-#include <unordered_map>
-
-// Explicit specialization of std::hash for Vertex
-template <> struct std::hash<Vertex> {
-  size_t operator()(Vertex const &vertex) const noexcept {
-    auto const h1{std::hash<glm::vec3>()(vertex.position)};
-    return h1;
-  }
-};
 
 void Window::onCreate() {
   auto const &assetsPath{abcg::Application::getAssetsPath()};
@@ -89,8 +80,14 @@ void Window::loadModelFromFile(std::string_view path) {
   m_vertices.clear();
   m_indices.clear();
 
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
+  // Merge identical vertices. The lookup table is sized for the worst case of
+  // no shared vertices
+  std::size_t numIndices{};
+  for (auto const &shape : shapes) {
+    numIndices += shape.mesh.indices.size();
+  }
+  m_indices.reserve(numIndices);
+  abcg::VertexWelder welder{m_vertices, numIndices};
 
   // Loop over shapes
   for (auto const &shape : shapes) {
@@ -107,17 +104,12 @@ void Window::loadModelFromFile(std::string_view path) {
 
       Vertex const vertex{.position = {vx, vy, vz}};
 
-      // If map doesn't contain this vertex
-      if (!hash.contains(vertex)) {
-        // Add this index (size of m_vertices)
-        hash[vertex] = m_vertices.size();
-        // Add this vertex
-        m_vertices.push_back(vertex);
-      }
-
-      m_indices.push_back(hash[vertex]);
+      m_indices.push_back(welder.weld(vertex));
     }
   }
+
+  fmt::print("Welded {} vertices into {} in {:.2f} ms\n", m_indices.size(),
+             m_vertices.size(), welder.getElapsedTime() * 1000.0);
 }
 
 void Window::standardize() {
@@ -6,21 +6,10 @@
 #include <filesystem>
 #include <glm/ext/quaternion_geometric.hpp>
 #include <glm/fwd.hpp>
-#include <unordered_map>
-
-// Explicit specialization of std::hash for Vertex
-template <> struct std::hash<Vertex> {
-  size_t operator()(Vertex const &vertex) const noexcept {
-    auto const h1{std::hash<glm::vec3>()(vertex.position)};
-    auto const h2{std::hash<glm::vec3>()(vertex.normal)};
-    auto const h3{std::hash<glm::vec2>()(vertex.texCoord)};
-    return abcg::hashCombine(h1, h2, h3);
-  }
-};
 
 void Model::createBuffers(GLuint program) {
   // Delete previous buffers
-  abcg::glDeleteBuffers(1, &m_EBO);
+  m_indexBuffer.destroy();
   abcg::glDeleteBuffers(1, &m_VBO);
 
   // VBO
@@ -31,13 +20,8 @@ void Model::createBuffers(GLuint program) {
                      m_vertices.data(), GL_STATIC_DRAW);
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-  // EBO
-  abcg::glGenBuffers(1, &m_EBO);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  abcg::glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     sizeof(m_indices.at(0)) * m_indices.size(),
-                     m_indices.data(), GL_STATIC_DRAW);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  // EBO with 16-bit indices whenever possible
+  m_indexBuffer.create(m_indices, m_vertices.size());
 
   m_modelMatrixLoc = abcg::glGetUniformLocation(program, "modelMatrix");
   m_normalMatrixLoc = abcg::glGetUniformLocation(program, "normalMatrix");
@@ -86,8 +70,14 @@ void Model::loadObj(std::string_view path, GLuint program, bool standardize) {
   m_hasNormals = false;
   m_hasTexCoords = false;
 
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
+  // Merge identical vertices. The lookup table is sized for the worst case of
+  // no shared vertices
+  std::size_t numIndices{};
+  for (auto const &shape : shapes) {
+    numIndices += shape.mesh.indices.size();
+  }
+  m_indices.reserve(numIndices);
+  abcg::VertexWelder welder{m_vertices, numIndices};
 
   // Loop over shapes
   for (auto const &shape : shapes) {
@@ -124,18 +114,13 @@ void Model::loadObj(std::string_view path, GLuint program, bool standardize) {
       Vertex const vertex{
           .position = position, .normal = normal, .texCoord = texCoord};
 
-      // If hash doesn't contain this vertex
-      if (!hash.contains(vertex)) {
-        // Add this index (size of m_vertices)
-        hash[vertex] = m_vertices.size();
-        // Add this vertex
-        m_vertices.push_back(vertex);
-      }
-
-      m_indices.push_back(hash[vertex]);
+      m_indices.push_back(welder.weld(vertex));
     }
   }
 
+  fmt::print("Welded {} vertices into {} in {:.2f} ms\n", m_indices.size(),
+             m_vertices.size(), welder.getElapsedTime() * 1000.0);
+
   // Use properties of first material, if available
   if (!materials.empty()) {
     auto const &mat{materials.at(0)}; // First material
@@ -175,7 +160,7 @@ void Model::setupVAO(GLuint program) {
   abcg::glBindVertexArray(m_VAO);
 
   // Bind EBO and VBO
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+  m_indexBuffer.bind();
   abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
 
   // Bind vertex attributes
@@ -270,9 +255,7 @@ void Model::render(glm::mat4 modelMatrix, glm::mat4 viewMatrix) {
   abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-  auto const numIndices{m_indices.size()};
-
-  abcg::glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, nullptr);
+  m_indexBuffer.draw(GL_TRIANGLES);
 
   abcg::glBindVertexArray(0);
 }
@@ -359,8 +342,8 @@ void Model::computeModelMatrix() {
   m_modelMatrix = glm::scale(m_modelMatrix, glm::vec3(scale));
 }
 
-void Model::destroy() const {
-  abcg::glDeleteBuffers(1, &m_EBO);
+void Model::destroy() {
+  m_indexBuffer.destroy();
   abcg::glDeleteBuffers(1, &m_VBO);
   abcg::glDeleteVertexArrays(1, &m_VAO);
 }
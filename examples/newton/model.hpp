@@ -16,7 +16,7 @@ public:
   void loadDiffuseTexture(std::string_view path);
   void loadObj(std::string_view path, GLuint program, bool standardize = true);
   void render(glm::mat4 modelMatrix, glm::mat4 m_viewMatrix);
-  void destroy() const;
+  void destroy();
   void update(float deltaTime);
   void setHorizontalSpeed(double horizontalSpeed);
   void computeModelMatrix();
@@ -52,7 +52,7 @@ public:
 private:
   GLuint m_VAO{};
   GLuint m_VBO{};
-  GLuint m_EBO{};
+  abcg::OpenGLIndexBuffer m_indexBuffer;
 
   std::vector<Vertex> m_vertices;
   std::vector<GLuint> m_indices;
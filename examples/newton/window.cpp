@@ -75,18 +75,15 @@ void Window::onCreate() {
   abcg::glClearColor(0, 0, 0, 1);
   abcg::glEnable(GL_DEPTH_TEST);
 
-  m_program = abcg::createOpenGLProgram(
-      {{.source = assetsPath + "shaders/blinnphong.vert",
-        .stage = abcg::ShaderStage::Vertex},
-       {.source = assetsPath + "shaders/blinnphong.frag",
-        .stage = abcg::ShaderStage::Fragment}});
+  m_program.create({{.source = assetsPath + "shaders/blinnphong.vert",
+                      .stage = abcg::ShaderStage::Vertex},
+                     {.source = assetsPath + "shaders/blinnphong.frag",
+                      .stage = abcg::ShaderStage::Fragment}});
 
-
-  m_skybox_program =
-      abcg::createOpenGLProgram({{.source = assetsPath + "shaders/skybox.vert",
-                                  .stage = abcg::ShaderStage::Vertex},
-                                 {.source = assetsPath + "shaders/skybox.frag",
-                                  .stage = abcg::ShaderStage::Fragment}});
+  m_skybox_program.create({{.source = assetsPath + "shaders/skybox.vert",
+                            .stage = abcg::ShaderStage::Vertex},
+                           {.source = assetsPath + "shaders/skybox.frag",
+                            .stage = abcg::ShaderStage::Fragment}});
 
   m_planet.mass = 100.0f;
   m_planet.radius = 1.0f;
@@ -103,16 +100,16 @@ void Window::onCreate() {
 
   m_mappingMode = 3; // "From mesh" option
   m_planet.loadDiffuseTexture(assetsPath + "maps/earth.png");
-  m_planet.loadObj(assetsPath + "earth.obj", m_program);
+  m_planet.loadObj(assetsPath + "earth.obj", GLuint{m_program});
   
   m_cannon_model.loadDiffuseTexture(assetsPath + "maps/cannon.png");
-  m_cannon_model.loadObj(assetsPath + "cannon.obj", m_program);
+  m_cannon_model.loadObj(assetsPath + "cannon.obj", GLuint{m_program});
 
   m_satellite_model.loadDiffuseTexture(assetsPath + "maps/cannonball.png");
-  m_satellite_model.loadObj(assetsPath + "cannonball.obj", m_program);
+  m_satellite_model.loadObj(assetsPath + "cannonball.obj", GLuint{m_program});
 
   m_skybox.texture_path = assetsPath + "maps/sky.jpg";
-  m_skybox.createBuffers(m_skybox_program);
+  m_skybox.createBuffers(GLuint{m_skybox_program});
 }
 
 Model Window::createSphere(float horizontalSpeed) {
@@ -156,30 +153,18 @@ void Window::onPaint() {
 
   abcg::glViewport(0, 0, m_viewportSize.x, m_viewportSize.y);
 
-  abcg::glUseProgram(m_program);
-
-  // Get location of uniform variables
-  auto const viewMatrixLoc{abcg::glGetUniformLocation(m_program, "viewMatrix")};
-  auto const projMatrixLoc{abcg::glGetUniformLocation(m_program, "projMatrix")};
-  auto const IaLoc{abcg::glGetUniformLocation(m_program, "Ia")};
-  auto const IdLoc{abcg::glGetUniformLocation(m_program, "Id")};
-  auto const IsLoc{abcg::glGetUniformLocation(m_program, "Is")};
-  
-  auto const diffuseTexLoc{abcg::glGetUniformLocation(m_program, "diffuseTex")};
-  auto const mappingModeLoc{abcg::glGetUniformLocation(m_program, "mappingMode")};
+  m_program.use();
 
   // Set uniform variables that have the same value for every model
-  abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_camera.getViewMatrix()[0][0]);
-  abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_camera.getProjMatrix()[0][0]);
-  abcg::glUniform1i(diffuseTexLoc, 0);
-  abcg::glUniform1i(mappingModeLoc, m_mappingMode);
-
-  abcg::glUniform4fv(IaLoc, 1, &m_Ia.x);
-  abcg::glUniform4fv(IdLoc, 1, &m_Id.x);
-  abcg::glUniform4fv(IsLoc, 1, &m_Is.x);
- 
-  auto const lightDirLoc = abcg::glGetUniformLocation(m_program, "lightDirWorldSpace");
-  abcg::glUniform4fv(lightDirLoc, 1, &m_lightDir.x);
+  m_program.setUniform("viewMatrix", m_camera.getViewMatrix());
+  m_program.setUniform("projMatrix", m_camera.getProjMatrix());
+  m_program.setUniform("diffuseTex", 0);
+  m_program.setUniform("mappingMode", m_mappingMode);
+
+  m_program.setUniform("Ia", m_Ia);
+  m_program.setUniform("Id", m_Id);
+  m_program.setUniform("Is", m_Is);
+  m_program.setUniform("lightDirWorldSpace", m_lightDir);
 
   m_planet.render(m_planet.getModelMatrix(), m_camera.getViewMatrix());
   m_cannon_model.render(m_cannon_model.getModelMatrix(), m_camera.getViewMatrix());
@@ -190,18 +175,11 @@ void Window::onPaint() {
 
   abcg::glUseProgram(0);
 
-  abcg::glUseProgram(m_skybox_program);
+  m_skybox_program.use();
 
-  // Get location of uniform variables
-  auto const skyViewMatrixLoc{abcg::glGetUniformLocation(m_skybox_program, "viewMatrix")};
-  auto const skyProjMatrixLoc{abcg::glGetUniformLocation(m_skybox_program, "projMatrix")};
-
-  abcg::glUniformMatrix4fv(skyViewMatrixLoc, 1, GL_FALSE, &m_camera.getViewMatrix()[0][0]);
-  abcg::glUniformMatrix4fv(skyProjMatrixLoc, 1, GL_FALSE, &m_camera.getProjMatrix()[0][0]);
-
-  auto const skydiffuseTexLoc{abcg::glGetUniformLocation(m_skybox_program, "diffuseTex")};
-  
-  abcg::glUniform1i(skydiffuseTexLoc, 0);
+  m_skybox_program.setUniform("viewMatrix", m_camera.getViewMatrix());
+  m_skybox_program.setUniform("projMatrix", m_camera.getProjMatrix());
+  m_skybox_program.setUniform("diffuseTex", 0);
 
   m_skybox.render();
 
@@ -244,5 +222,6 @@ void Window::onDestroy() {
   m_cannon_model.destroy();
   m_satellite_model.destroy();
 
-  abcg::glDeleteProgram(m_program);
+  m_program.destroy();
+  m_skybox_program.destroy();
 }
\ No newline at end of file
@@ -40,8 +40,8 @@ private:
 
   std::vector<Model> m_satellites;
   
-  GLuint m_program{};
-  GLuint m_skybox_program{};
+  abcg::OpenGLProgram m_program;
+  abcg::OpenGLProgram m_skybox_program;
 
   // Mapping mode
   // 0: triplanar; 1: cylindrical; 2: spherical; 3: from mesh
@@ -3,15 +3,6 @@
 #include <cmath>
 #include <glm/ext/quaternion_geometric.hpp>
 #include <glm/fwd.hpp>
-#include <unordered_map>
-
-// Explicit specialization of std::hash for Vertex
-template <> struct std::hash<Vertex> {
-  size_t operator()(Vertex const &vertex) const noexcept {
-    auto const h1{std::hash<glm::vec3>()(vertex.position)};
-    return h1;
-  }
-};
 
 void Sphere::createBuffers(GLuint program) {
   // Delete previous buffers
@@ -59,8 +50,14 @@ void Sphere::loadObj(std::string_view path, GLuint program, bool standardize) {
   m_vertices.clear();
   m_indices.clear();
 
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
+  // Merge identical vertices. The lookup table is sized for the worst case of
+  // no shared vertices
+  std::size_t numIndices{};
+  for (auto const &shape : shapes) {
+    numIndices += shape.mesh.indices.size();
+  }
+  m_indices.reserve(numIndices);
+  abcg::VertexWelder welder{m_vertices, numIndices};
 
   // Loop over shapes
   for (auto const &shape : shapes) {
@@ -77,18 +74,13 @@ void Sphere::loadObj(std::string_view path, GLuint program, bool standardize) {
 
       Vertex const vertex{.position = {vx, vy, vz}};
 
-      // If hash doesn't contain this vertex
-      if (!hash.contains(vertex)) {
-        // Add this index (size of m_vertices)
-        hash[vertex] = m_vertices.size();
-        // Add this vertex
-        m_vertices.push_back(vertex);
-      }
-
-      m_indices.push_back(hash[vertex]);
+      m_indices.push_back(welder.weld(vertex));
     }
   }
 
+  fmt::print("Welded {} vertices into {} in {:.2f} ms\n", m_indices.size(),
+             m_vertices.size(), welder.getElapsedTime() * 1000.0);
+
   if (standardize) {
     Sphere::standardize();
   }
@@ -45,11 +45,26 @@ void Window::onCreate() {
   std::uniform_real_distribution<float> realDistribution(-1.0f, 1.0f);
   m_P.x = realDistribution(m_randomEngine);
   m_P.y = realDistribution(m_randomEngine);
+
+  // Create OpenGL buffers for drawing the points
+  setupModel();
 }
 
 void Window::onPaint() {
-  // Create OpenGL buffers for drawing the point at m_P
-  setupModel();
+  // Randomly pick the index of a triangle vertex for each new point
+  std::uniform_int_distribution<int> intDistribution(0, m_points.size() - 1);
+
+  // Write the points to the VBO
+  auto const count{gsl::narrow<std::size_t>(m_pointsPerFrame)};
+  auto const points{m_VBOVertices.map<glm::vec2>(count)};
+  for (auto &point : points) {
+    // The new position is the midpoint between the current position and the
+    // chosen vertex position
+    auto const index{intDistribution(m_randomEngine)};
+    m_P = (m_P + m_points.at(index)) / 2.0f;
+    point = m_P;
+  }
+  auto const first{m_VBOVertices.unmap() / sizeof(glm::vec2)};
 
   // Set the viewport
   abcg::glViewport(0, 0, m_viewportSize.x, m_viewportSize.y);
@@ -59,39 +74,24 @@ void Window::onPaint() {
   // Start using VAO
   abcg::glBindVertexArray(m_VAO);
 
-  // Draw a single point
-  abcg::glDrawArrays(GL_POINTS, 0, 1);
+  // Draw the new points. As the window is single-buffered, they accumulate
+  // with the points of the previous frames.
+  abcg::glDrawArrays(GL_POINTS, gsl::narrow<GLint>(first),
+                     gsl::narrow<GLsizei>(count));
 
   // End using VAO
   abcg::glBindVertexArray(0);
   // End using the shader program
   abcg::glUseProgram(0);
-
-  // Randomly pick the index of a triangle vertex
-  std::uniform_int_distribution<int> intDistribution(0, m_points.size() - 1);
-  auto const index{intDistribution(m_randomEngine)};
-
-  // The new position is the midpoint between the current position and the
-  // chosen vertex position
-  m_P = (m_P + m_points.at(index)) / 2.0f;
-
-  // Print coordinates to console
-  // fmt::print("({:+.2f}, {:+.2f})\n", m_P.x, m_P.y);
 }
 
 void Window::setupModel() {
   // Release previous VBO and VAO
-  abcg::glDeleteBuffers(1, &m_VBOVertices);
+  m_VBOVertices.destroy();
   abcg::glDeleteVertexArrays(1, &m_VAO);
 
-  // Generate a new VBO and get the associated ID
-  abcg::glGenBuffers(1, &m_VBOVertices);
-  // Bind VBO in order to use it
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBOVertices);
-  // Upload data to VBO
-  abcg::glBufferData(GL_ARRAY_BUFFER, sizeof(m_P), &m_P, GL_STATIC_DRAW);
-  // Unbinding the VBO is allowed (data can be released now)
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+  // Generate a VBO whose contents are rewritten every frame
+  m_VBOVertices.create(GL_ARRAY_BUFFER, maxPointsPerFrame * sizeof(glm::vec2));
 
   // Get location of attributes in the program
   auto const positionAttribute{
@@ -104,7 +104,7 @@ void Window::setupModel() {
   abcg::glBindVertexArray(m_VAO);
 
   abcg::glEnableVertexAttribArray(positionAttribute);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBOVertices);
+  m_VBOVertices.bind();
   abcg::glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0,
                               nullptr);
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -122,7 +122,7 @@ void Window::onResize(glm::ivec2 const &size) {
 void Window::onDestroy() {
   // Release shader program, VBO and VAO
   abcg::glDeleteProgram(m_program);
-  abcg::glDeleteBuffers(1, &m_VBOVertices);
+  m_VBOVertices.destroy();
   abcg::glDeleteVertexArrays(1, &m_VAO);
 }
 
@@ -137,6 +137,13 @@ void Window::onPaintUI() {
       abcg::glClear(GL_COLOR_BUFFER_BIT);
     }
 
+    ImGui::PushItemWidth(150);
+    ImGui::SliderInt("##points", &m_pointsPerFrame, 1, maxPointsPerFrame,
+                     "%d points/frame", ImGuiSliderFlags_Logarithmic);
+    ImGui::PopItemWidth();
+    ImGui::Text("%.1f M points/s", gsl::narrow_cast<double>(m_pointsPerFrame) *
+                                       ImGui::GetIO().Framerate / 1e6);
+
     ImGui::End();
   }
 }
\ No newline at end of file
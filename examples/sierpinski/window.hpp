@@ -17,13 +17,17 @@ private:
   glm::ivec2 m_viewportSize{};
 
   GLuint m_VAO{};
-  GLuint m_VBOVertices{};
+  abcg::OpenGLStreamBuffer m_VBOVertices;
   GLuint m_program{};
 
   std::default_random_engine m_randomEngine;
   std::array<glm::vec2, 3> const m_points{{{0, 1}, {-1, -1}, {1, -1}}};
   glm::vec2 m_P{};
 
+  // Points generated and drawn with a single call each frame
+  static constexpr int maxPointsPerFrame{1'000'000};
+  int m_pointsPerFrame{10'000};
+
   void setupModel();
 };
 
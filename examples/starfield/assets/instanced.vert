@@ -0,0 +1,19 @@
+#version 300 es
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in mat4 inModelMatrix;
+
+uniform mat4 viewMatrix;
+uniform mat4 projMatrix;
+
+out vec4 fragColor;
+
+void main() {
+  vec4 posEyeSpace = viewMatrix * inModelMatrix * vec4(inPosition, 1);
+
+  float i = 1.0 - (-posEyeSpace.z / 100.0);
+  fragColor = vec4(i, i, i, 1) * inColor;
+
+  gl_Position = projMatrix * posEyeSpace;
+}
\ No newline at end of file
@@ -9,12 +9,19 @@ struct Vertex {
   friend bool operator==(Vertex const &, Vertex const &) = default;
 };
 
+// Per-instance attributes read from the instance VBO
+struct Instance {
+  glm::mat4 modelMatrix{1.0f};
+  glm::vec4 color{1.0f};
+};
+
 class Model {
 public:
   void loadObj(std::string_view path, bool standardize = true);
   void render(int numTriangles = -1) const;
-  void setupVAO(GLuint program);
-  void destroy() const;
+  void renderInstanced(GLsizei numInstances) const;
+  void setupVAO(GLuint program, GLuint instanceVBO = 0);
+  void destroy();
 
   [[nodiscard]] int getNumTriangles() const {
     return gsl::narrow<int>(m_indices.size()) / 3;
@@ -23,7 +30,7 @@ public:
 private:
   GLuint m_VAO{};
   GLuint m_VBO{};
-  GLuint m_EBO{};
+  abcg::OpenGLIndexBuffer m_indexBuffer;
 
   std::vector<Vertex> m_vertices;
   std::vector<GLuint> m_indices;
@@ -2,6 +2,7 @@
 
 #include <glm/gtc/random.hpp>
 #include <glm/gtx/fast_trigonometry.hpp>
+#include <utility>
 
 void Window::onCreate() {
   auto const assetsPath{abcg::Application::getAssetsPath()};
@@ -9,14 +10,23 @@ void Window::onCreate() {
   abcg::glClearColor(0, 0, 0, 1);
   abcg::glEnable(GL_DEPTH_TEST);
 
-  m_program =
-      abcg::createOpenGLProgram({{.source = assetsPath + "depth.vert",
-                                  .stage = abcg::ShaderStage::Vertex},
-                                 {.source = assetsPath + "depth.frag",
-                                  .stage = abcg::ShaderStage::Fragment}});
+  m_program.create({{.source = assetsPath + "depth.vert",
+                      .stage = abcg::ShaderStage::Vertex},
+                     {.source = assetsPath + "depth.frag",
+                      .stage = abcg::ShaderStage::Fragment}});
+  m_modelMatrixLoc = m_program.getUniformLocation("modelMatrix");
+  m_colorLoc = m_program.getUniformLocation("color");
+
+  m_instancedProgram.create({{.source = assetsPath + "instanced.vert",
+                              .stage = abcg::ShaderStage::Vertex},
+                             {.source = assetsPath + "depth.frag",
+                              .stage = abcg::ShaderStage::Fragment}});
+  abcg::glGenBuffers(1, &m_instanceVBO);
 
   m_model.loadObj(assetsPath + "box.obj");
-  m_model.setupVAO(m_program);
+  // Both programs read the vertex positions from location 0, so the VAO that
+  // also reads the instance attributes works with either of them
+  m_model.setupVAO(GLuint{m_instancedProgram}, m_instanceVBO);
 
   // Camera at (0,0,0) and looking towards the negative z
   glm::vec3 const eye{0.0f, 0.0f, 0.0f};
@@ -25,6 +35,7 @@ void Window::onCreate() {
   m_viewMatrix = glm::lookAt(eye, at, up);
 
   // Setup stars
+  m_stars.resize(gsl::narrow<std::size_t>(m_numStars));
   for (auto &star : m_stars) {
     randomizeStar(star);
   }
@@ -40,6 +51,18 @@ void Window::randomizeStar(Star &star) {
 
   // Random rotation axis
   star.m_rotationAxis = glm::sphericalRand(1.0f);
+
+  // Random pale color
+  star.m_color = glm::vec4(glm::linearRand(glm::vec3(0.6f), glm::vec3(1.0f)),
+                           1.0f);
+}
+
+glm::mat4 Window::computeModelMatrix(Star const &star) const {
+  glm::mat4 modelMatrix{1.0f};
+  modelMatrix = glm::translate(modelMatrix, star.m_position);
+  modelMatrix = glm::scale(modelMatrix, glm::vec3(0.2f));
+  modelMatrix = glm::rotate(modelMatrix, m_angle, star.m_rotationAxis);
+  return modelMatrix;
 }
 
 void Window::onUpdate() {
@@ -47,6 +70,15 @@ void Window::onUpdate() {
   auto const deltaTime{gsl::narrow_cast<float>(getDeltaTime())};
   m_angle = glm::wrapAngle(m_angle + glm::radians(90.0f) * deltaTime);
 
+  // Add or remove stars after the number of stars is changed in the UI
+  if (std::cmp_not_equal(m_stars.size(), m_numStars)) {
+    auto const oldSize{m_stars.size()};
+    m_stars.resize(gsl::narrow<std::size_t>(m_numStars));
+    for (auto const index : iter::range(oldSize, m_stars.size())) {
+      randomizeStar(m_stars.at(index));
+    }
+  }
+
   // Update stars
   for (auto &star : m_stars) {
     // Increase z by 10 units per second
@@ -61,37 +93,76 @@ void Window::onUpdate() {
   }
 }
 
+// Uploads the model matrix and color of each star to the instance VBO
+void Window::updateInstances() {
+  auto const fill{[this](std::span<Instance> instances) {
+    for (auto const index : iter::range(m_stars.size())) {
+      auto const &star{m_stars[index]};
+      instances[index] = {.modelMatrix = computeModelMatrix(star),
+                          .color = star.m_color};
+    }
+  }};
+  auto const size{
+      gsl::narrow<GLsizeiptr>(m_stars.size() * sizeof(Instance))};
+
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+
+  // Orphan the storage that the previous frame may still be reading, so that
+  // the new data can be written without waiting for the GPU
+  abcg::glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+#if !defined(__EMSCRIPTEN__)
+  // Write the instances directly to the new storage
+  if (auto *mapped{abcg::glMapBufferRange(
+          GL_ARRAY_BUFFER, 0, size,
+          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)};
+      mapped != nullptr) {
+    fill({static_cast<Instance *>(mapped), m_stars.size()});
+    if (abcg::glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE) {
+      abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+      return;
+    }
+  }
+#endif
+
+  // Upload from client memory instead
+  m_instances.resize(m_stars.size());
+  fill(m_instances);
+  abcg::glBufferSubData(GL_ARRAY_BUFFER, 0, size, m_instances.data());
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void Window::onPaint() {
   abcg::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
   abcg::glViewport(0, 0, m_viewportSize.x, m_viewportSize.y);
 
-  abcg::glUseProgram(m_program);
+  if (m_instanced) {
+    // Fill the instance VBO right before drawing from it, so it is never stale
+    updateInstances();
 
-  // Get location of uniform variables
-  auto const viewMatrixLoc{abcg::glGetUniformLocation(m_program, "viewMatrix")};
-  auto const projMatrixLoc{abcg::glGetUniformLocation(m_program, "projMatrix")};
-  auto const modelMatrixLoc{
-      abcg::glGetUniformLocation(m_program, "modelMatrix")};
-  auto const colorLoc{abcg::glGetUniformLocation(m_program, "color")};
+    m_instancedProgram.use();
 
-  // Set uniform variables that have the same value for every model
-  abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_viewMatrix[0][0]);
-  abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
-  abcg::glUniform4f(colorLoc, 1.0f, 1.0f, 1.0f, 1.0f); // White
+    m_instancedProgram.setUniform("viewMatrix", m_viewMatrix);
+    m_instancedProgram.setUniform("projMatrix", m_projMatrix);
 
-  // Render each star
-  for (auto &star : m_stars) {
-    // Compute model matrix of the current star
-    glm::mat4 modelMatrix{1.0f};
-    modelMatrix = glm::translate(modelMatrix, star.m_position);
-    modelMatrix = glm::scale(modelMatrix, glm::vec3(0.2f));
-    modelMatrix = glm::rotate(modelMatrix, m_angle, star.m_rotationAxis);
+    // Render all stars at once
+    m_model.renderInstanced(gsl::narrow<GLsizei>(m_stars.size()));
+  } else {
+    m_program.use();
 
-    // Set uniform variable
-    abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &modelMatrix[0][0]);
+    // Set uniform variables that have the same value for every model
+    m_program.setUniform("viewMatrix", m_viewMatrix);
+    m_program.setUniform("projMatrix", m_projMatrix);
 
-    m_model.render();
+    // Render each star
+    for (auto const &star : m_stars) {
+      // Set uniform variables of the current star
+      m_program.setUniform(m_modelMatrixLoc, computeModelMatrix(star));
+      m_program.setUniform(m_colorLoc, star.m_color);
+
+      m_model.render();
+    }
   }
 
   abcg::glUseProgram(0);
@@ -101,7 +172,7 @@ void Window::onPaintUI() {
   abcg::OpenGLWindow::onPaintUI();
 
   {
-    auto const widgetSize{ImVec2(218, 62)};
+    auto const widgetSize{ImVec2(218, 110)};
     ImGui::SetNextWindowPos(ImVec2(m_viewportSize.x - widgetSize.x - 5, 5));
     ImGui::SetNextWindowSize(widgetSize);
     ImGui::Begin("Widget window", nullptr, ImGuiWindowFlags_NoDecoration);
@@ -136,7 +207,12 @@ void Window::onPaintUI() {
         m_projMatrix = glm::ortho(-20.0f * aspect, 20.0f * aspect, -20.0f,
                                   20.0f, 0.01f, 100.0f);
       }
+
+      ImGui::SliderInt("Stars", &m_numStars, 1, 200'000, "%d",
+                       ImGuiSliderFlags_Logarithmic);
       ImGui::PopItemWidth();
+
+      ImGui::Checkbox("Instanced rendering", &m_instanced);
     }
 
     ImGui::End();
@@ -147,5 +223,7 @@ void Window::onResize(glm::ivec2 const &size) { m_viewportSize = size; }
 
 void Window::onDestroy() {
   m_model.destroy();
-  abcg::glDeleteProgram(m_program);
+  abcg::glDeleteBuffers(1, &m_instanceVBO);
+  m_instancedProgram.destroy();
+  m_program.destroy();
 }
\ No newline at end of file
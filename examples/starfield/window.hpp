@@ -2,6 +2,7 @@
 #define WINDOW_HPP_
 
 #include <random>
+#include <vector>
 
 #include "abcgOpenGL.hpp"
 #include "model.hpp"
@@ -25,9 +26,12 @@ private:
   struct Star {
     glm::vec3 m_position{};
     glm::vec3 m_rotationAxis{};
+    glm::vec4 m_color{1.0f};
   };
 
-  std::array<Star, 500> m_stars;
+  std::vector<Star> m_stars;
+  int m_numStars{500};
+  bool m_instanced{true};
 
   float m_angle{};
 
@@ -35,9 +39,19 @@ private:
   glm::mat4 m_projMatrix{1.0f};
   float m_FOV{30.0f};
 
-  GLuint m_program{};
+  abcg::OpenGLProgram m_program;
+  GLint m_modelMatrixLoc{-1};
+  GLint m_colorLoc{-1};
+
+  // Draws all stars with a single call, reading their model matrices and
+  // colors from m_instanceVBO
+  abcg::OpenGLProgram m_instancedProgram;
+  GLuint m_instanceVBO{};
+  std::vector<Instance> m_instances;
 
   void randomizeStar(Star &star);
+  [[nodiscard]] glm::mat4 computeModelMatrix(Star const &star) const;
+  void updateInstances();
 };
 
 #endif
\ No newline at end of file
@@ -1,18 +1,8 @@
 #include "model.hpp"
 
-#include <unordered_map>
-
-// Explicit specialization of std::hash for Vertex
-template <> struct std::hash<Vertex> {
-  size_t operator()(Vertex const &vertex) const noexcept {
-    auto const h1{std::hash<glm::vec3>()(vertex.position)};
-    return h1;
-  }
-};
-
 void Model::createBuffers() {
   // Delete previous buffers
-  abcg::glDeleteBuffers(1, &m_EBO);
+  m_indexBuffer.destroy();
   abcg::glDeleteBuffers(1, &m_VBO);
 
   // VBO
@@ -23,13 +13,8 @@ void Model::createBuffers() {
                      m_vertices.data(), GL_STATIC_DRAW);
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-  // EBO
-  abcg::glGenBuffers(1, &m_EBO);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  abcg::glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     sizeof(m_indices.at(0)) * m_indices.size(),
-                     m_indices.data(), GL_STATIC_DRAW);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  // EBO with 16-bit indices whenever possible
+  m_indexBuffer.create(m_indices, m_vertices.size());
 }
 
 void Model::loadObj(std::string_view path, bool standardize) {
@@ -53,8 +38,14 @@ void Model::loadObj(std::string_view path, bool standardize) {
   m_vertices.clear();
   m_indices.clear();
 
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
+  // Merge identical vertices. The lookup table is sized for the worst case of
+  // no shared vertices
+  std::size_t numIndices{};
+  for (auto const &shape : shapes) {
+    numIndices += shape.mesh.indices.size();
+  }
+  m_indices.reserve(numIndices);
+  abcg::VertexWelder welder{m_vertices, numIndices};
 
   // Loop over shapes
   for (auto const &shape : shapes) {
@@ -71,18 +62,13 @@ void Model::loadObj(std::string_view path, bool standardize) {
 
       Vertex const vertex{.position = {vx, vy, vz}};
 
-      // If hash doesn't contain this vertex
-      if (!hash.contains(vertex)) {
-        // Add this index (size of m_vertices)
-        hash[vertex] = m_vertices.size();
-        // Add this vertex
-        m_vertices.push_back(vertex);
-      }
-
-      m_indices.push_back(hash[vertex]);
+      m_indices.push_back(welder.weld(vertex));
     }
   }
 
+  fmt::print("Welded {} vertices into {} in {:.2f} ms\n", m_indices.size(),
+             m_vertices.size(), welder.getElapsedTime() * 1000.0);
+
   if (standardize) {
     Model::standardize();
   }
@@ -93,10 +79,11 @@ void Model::loadObj(std::string_view path, bool standardize) {
 void Model::render(int numTriangles) const {
   abcg::glBindVertexArray(m_VAO);
 
-  auto const numIndices{(numTriangles < 0) ? m_indices.size()
-                                           : numTriangles * 3};
+  auto const numIndices{(numTriangles < 0)
+                            ? m_indices.size()
+                            : gsl::narrow<std::size_t>(numTriangles) * 3};
 
-  abcg::glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, nullptr);
+  m_indexBuffer.draw(GL_TRIANGLES, numIndices);
 
   abcg::glBindVertexArray(0);
 }
@@ -110,7 +97,7 @@ void Model::setupVAO(GLuint program) {
   abcg::glBindVertexArray(m_VAO);
 
   // Bind EBO and VBO
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+  m_indexBuffer.bind();
   abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
 
   // Bind vertex attributes
@@ -146,8 +133,8 @@ void Model::standardize() {
   }
 }
 
-void Model::destroy() const {
-  abcg::glDeleteBuffers(1, &m_EBO);
+void Model::destroy() {
+  m_indexBuffer.destroy();
   abcg::glDeleteBuffers(1, &m_VBO);
   abcg::glDeleteVertexArrays(1, &m_VAO);
 }
\ No newline at end of file
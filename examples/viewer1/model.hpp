@@ -14,7 +14,7 @@ public:
   void loadObj(std::string_view path, bool standardize = true);
   void render(int numTriangles = -1) const;
   void setupVAO(GLuint program);
-  void destroy() const;
+  void destroy();
 
   [[nodiscard]] int getNumTriangles() const {
     return gsl::narrow<int>(m_indices.size()) / 3;
@@ -23,7 +23,7 @@ public:
 private:
   GLuint m_VAO{};
   GLuint m_VBO{};
-  GLuint m_EBO{};
+  abcg::OpenGLIndexBuffer m_indexBuffer;
 
   std::vector<Vertex> m_vertices;
   std::vector<GLuint> m_indices;
@@ -15,7 +15,7 @@ public:
   void loadObj(std::string_view path, bool standardize = true);
   void render(int numTriangles = -1) const;
   void setupVAO(GLuint program);
-  void destroy() const;
+  void destroy();
 
   [[nodiscard]] int getNumTriangles() const {
     return gsl::narrow<int>(m_indices.size()) / 3;
@@ -29,7 +29,7 @@ public:
 private:
   GLuint m_VAO{};
   GLuint m_VBO{};
-  GLuint m_EBO{};
+  abcg::OpenGLIndexBuffer m_indexBuffer;
 
   glm::vec4 m_Ka{};
   glm::vec4 m_Kd{};
@@ -9,12 +9,19 @@ in vec2 fragTexCoord;
 in vec3 fragPObj;
 in vec3 fragNObj;
 
-// Light properties
-uniform vec4 Ia, Id, Is;
+// Per-frame data shared by every program
+layout(std140) uniform FrameData {
+  highp mat4 viewMatrix;
+  highp mat4 projMatrix;
+  highp vec4 lightDirWorldSpace;
+  highp vec4 Ia, Id, Is;
+};
 
 // Material properties
-uniform vec4 Ka, Kd, Ks;
-uniform float shininess;
+layout(std140) uniform MaterialData {
+  highp vec4 Ka, Kd, Ks;
+  highp float shininess;
+};
 
 // Diffuse texture sampler
 uniform sampler2D diffuseTex;
@@ -1,17 +1,6 @@
 #include "model.hpp"
 
 #include <filesystem>
-#include <unordered_map>
-
-// Explicit specialization of std::hash for Vertex
-template <> struct std::hash<Vertex> {
-  size_t operator()(Vertex const &vertex) const noexcept {
-    auto const h1{std::hash<glm::vec3>()(vertex.position)};
-    auto const h2{std::hash<glm::vec3>()(vertex.normal)};
-    auto const h3{std::hash<glm::vec2>()(vertex.texCoord)};
-    return abcg::hashCombine(h1, h2, h3);
-  }
-};
 
 void Model::computeNormals() {
   // Clear previous vertex normals
@@ -47,7 +36,7 @@ void Model::computeNormals() {
 
 void Model::createBuffers() {
   // Delete previous buffers
-  abcg::glDeleteBuffers(1, &m_EBO);
+  m_indexBuffer.destroy();
   abcg::glDeleteBuffers(1, &m_VBO);
 
   // VBO
@@ -58,21 +47,23 @@ void Model::createBuffers() {
                      m_vertices.data(), GL_STATIC_DRAW);
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-  // EBO
-  abcg::glGenBuffers(1, &m_EBO);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  abcg::glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     sizeof(m_indices.at(0)) * m_indices.size(),
-                     m_indices.data(), GL_STATIC_DRAW);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  // EBO with 16-bit indices whenever possible
+  m_indexBuffer.create(m_indices, m_vertices.size());
 }
 
 void Model::loadDiffuseTexture(std::string_view path) {
   if (!std::filesystem::exists(path))
     return;
 
+  // Drop the pending upload, as the name may be reused by the next texture
+  if (m_textureStreamer != nullptr) {
+    m_textureStreamer->cancel(m_diffuseTexture);
+  }
   abcg::glDeleteTextures(1, &m_diffuseTexture);
-  m_diffuseTexture = abcg::loadOpenGLTexture({.path = path});
+  // Decode in the background if a streamer is available
+  m_diffuseTexture = m_textureStreamer == nullptr
+                         ? abcg::loadOpenGLTexture({.path = path})
+                         : m_textureStreamer->load({.path = path});
 }
 
 void Model::loadObj(std::string_view path, bool standardize) {
@@ -105,8 +96,14 @@ void Model::loadObj(std::string_view path, bool standardize) {
   m_hasNormals = false;
   m_hasTexCoords = false;
 
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
+  // Merge identical vertices. The lookup table is sized for the worst case of
+  // no shared vertices
+  std::size_t numIndices{};
+  for (auto const &shape : shapes) {
+    numIndices += shape.mesh.indices.size();
+  }
+  m_indices.reserve(numIndices);
+  abcg::VertexWelder welder{m_vertices, numIndices};
 
   // Loop over shapes
   for (auto const &shape : shapes) {
@@ -143,18 +140,13 @@ void Model::loadObj(std::string_view path, bool standardize) {
       Vertex const vertex{
           .position = position, .normal = normal, .texCoord = texCoord};
 
-      // If hash doesn't contain this vertex
-      if (!hash.contains(vertex)) {
-        // Add this index (size of m_vertices)
-        hash[vertex] = m_vertices.size();
-        // Add this vertex
-        m_vertices.push_back(vertex);
-      }
-
-      m_indices.push_back(hash[vertex]);
+      m_indices.push_back(welder.weld(vertex));
     }
   }
 
+  fmt::print("Welded {} vertices into {} in {:.2f} ms\n", m_indices.size(),
+             m_vertices.size(), welder.getElapsedTime() * 1000.0);
+
   // Use properties of first material, if available
   if (!materials.empty()) {
     auto const &mat{materials.at(0)}; // First material
@@ -198,10 +190,11 @@ void Model::render(int numTriangles) const {
   abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-  auto const numIndices{(numTriangles < 0) ? m_indices.size()
-                                           : numTriangles * 3};
+  auto const numIndices{(numTriangles < 0)
+                            ? m_indices.size()
+                            : gsl::narrow<std::size_t>(numTriangles) * 3};
 
-  abcg::glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, nullptr);
+  m_indexBuffer.draw(GL_TRIANGLES, numIndices);
 
   abcg::glBindVertexArray(0);
 }
@@ -215,7 +208,7 @@ void Model::setupVAO(GLuint program) {
   abcg::glBindVertexArray(m_VAO);
 
   // Bind EBO and VBO
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+  m_indexBuffer.bind();
   abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
 
   // Bind vertex attributes
@@ -271,8 +264,11 @@ void Model::standardize() {
 }
 
 void Model::destroy() {
+  if (m_textureStreamer != nullptr) {
+    m_textureStreamer->cancel(m_diffuseTexture);
+  }
   abcg::glDeleteTextures(1, &m_diffuseTexture);
-  abcg::glDeleteBuffers(1, &m_EBO);
+  m_indexBuffer.destroy();
   abcg::glDeleteBuffers(1, &m_VBO);
   abcg::glDeleteVertexArrays(1, &m_VAO);
 }
\ No newline at end of file
@@ -17,6 +17,9 @@ public:
   void loadObj(std::string_view path, bool standardize = true);
   void render(int numTriangles = -1) const;
   void setupVAO(GLuint program);
+  void setTextureStreamer(abcg::OpenGLTextureStreamer *textureStreamer) {
+    m_textureStreamer = textureStreamer;
+  }
   void destroy();
 
   [[nodiscard]] int getNumTriangles() const {
@@ -33,13 +36,14 @@ public:
 private:
   GLuint m_VAO{};
   GLuint m_VBO{};
-  GLuint m_EBO{};
+  abcg::OpenGLIndexBuffer m_indexBuffer;
 
   glm::vec4 m_Ka{};
   glm::vec4 m_Kd{};
   glm::vec4 m_Ks{};
   float m_shininess{};
   GLuint m_diffuseTexture{};
+  abcg::OpenGLTextureStreamer *m_textureStreamer{};
 
   std::vector<Vertex> m_vertices;
   std::vector<GLuint> m_indices;
@@ -38,15 +38,34 @@ void Window::onCreate() {
   abcg::glClearColor(0, 0, 0, 1);
   abcg::glEnable(GL_DEPTH_TEST);
 
+  // Reuse program binaries from previous runs
+  abcg::setOpenGLProgramCacheDirectory(abcg::Application::getBasePath() +
+                                       "/shadercache");
+
   // Create programs
+  std::vector<std::vector<abcg::ShaderSource>> sources;
   for (auto const &name : m_shaderNames) {
     auto const path{assetsPath + "shaders/" + name};
-    auto const program{abcg::createOpenGLProgram(
+    sources.push_back(
         {{.source = path + ".vert", .stage = abcg::ShaderStage::Vertex},
-         {.source = path + ".frag", .stage = abcg::ShaderStage::Fragment}})};
-    m_programs.push_back(program);
+         {.source = path + ".frag", .stage = abcg::ShaderStage::Fragment}});
+  }
+  for (auto const program : abcg::createOpenGLPrograms(sources)) {
+    m_programs.emplace_back().create(program);
+  }
+
+  // Create uniform buffers and bind their blocks in every program
+  m_frameUBO.create(frameDataBinding, sizeof(FrameData));
+  m_materialUBO.create(materialDataBinding, sizeof(MaterialData));
+  for (auto &program : m_programs) {
+    program.setUniformBlockBinding("FrameData", frameDataBinding);
+    program.setUniformBlockBinding("MaterialData", materialDataBinding);
   }
 
+  // Load textures asynchronously
+  m_textureStreamer.create();
+  m_model.setTextureStreamer(&m_textureStreamer);
+
   // Load default model
   loadModel(assetsPath + "roman_lamp.obj");
   m_mappingMode = 3; // "From mesh" option
@@ -63,7 +82,7 @@ void Window::loadModel(std::string_view path) {
 
   m_model.loadDiffuseTexture(assetsPath + "maps/pattern.png");
   m_model.loadObj(path);
-  m_model.setupVAO(m_programs.at(m_currentProgramIndex));
+  m_model.setupVAO(GLuint{m_programs.at(m_currentProgramIndex)});
   m_trianglesToDraw = m_model.getNumTriangles();
 
   // Use material properties from the loaded model
@@ -74,55 +93,38 @@ void Window::loadModel(std::string_view path) {
 }
 
 void Window::onPaint() {
+  // Upload pending texture data
+  m_textureStreamer.update();
+
   abcg::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
   abcg::glViewport(0, 0, m_viewportSize.x, m_viewportSize.y);
 
   // Use currently selected program
-  auto const program{m_programs.at(m_currentProgramIndex)};
-  abcg::glUseProgram(program);
-
-  // Get location of uniform variables
-  auto const viewMatrixLoc{abcg::glGetUniformLocation(program, "viewMatrix")};
-  auto const projMatrixLoc{abcg::glGetUniformLocation(program, "projMatrix")};
-  auto const modelMatrixLoc{abcg::glGetUniformLocation(program, "modelMatrix")};
-  auto const normalMatrixLoc{
-      abcg::glGetUniformLocation(program, "normalMatrix")};
-  auto const lightDirLoc{
-      abcg::glGetUniformLocation(program, "lightDirWorldSpace")};
-  auto const shininessLoc{abcg::glGetUniformLocation(program, "shininess")};
-  auto const IaLoc{abcg::glGetUniformLocation(program, "Ia")};
-  auto const IdLoc{abcg::glGetUniformLocation(program, "Id")};
-  auto const IsLoc{abcg::glGetUniformLocation(program, "Is")};
-  auto const KaLoc{abcg::glGetUniformLocation(program, "Ka")};
-  auto const KdLoc{abcg::glGetUniformLocation(program, "Kd")};
-  auto const KsLoc{abcg::glGetUniformLocation(program, "Ks")};
-  auto const diffuseTexLoc{abcg::glGetUniformLocation(program, "diffuseTex")};
-  auto const mappingModeLoc{abcg::glGetUniformLocation(program, "mappingMode")};
-
-  // Set uniform variables that have the same value for every model
-  abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_viewMatrix[0][0]);
-  abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
-  abcg::glUniform1i(diffuseTexLoc, 0);
-  abcg::glUniform1i(mappingModeLoc, m_mappingMode);
+  auto &program{m_programs.at(m_currentProgramIndex)};
+  program.use();
 
+  // Update uniform blocks
   auto const lightDirRotated{m_trackBallLight.getRotation() * m_lightDir};
-  abcg::glUniform4fv(lightDirLoc, 1, &lightDirRotated.x);
-  abcg::glUniform4fv(IaLoc, 1, &m_Ia.x);
-  abcg::glUniform4fv(IdLoc, 1, &m_Id.x);
-  abcg::glUniform4fv(IsLoc, 1, &m_Is.x);
+  m_frameUBO.update(FrameData{.viewMatrix = m_viewMatrix,
+                              .projMatrix = m_projMatrix,
+                              .lightDirWorldSpace = lightDirRotated,
+                              .Ia = m_Ia,
+                              .Id = m_Id,
+                              .Is = m_Is});
+  m_materialUBO.update(MaterialData{
+      .Ka = m_Ka, .Kd = m_Kd, .Ks = m_Ks, .shininess = m_shininess});
+
+  // Set uniform variables that have the same value for every model
+  program.setUniform("diffuseTex", 0);
+  program.setUniform("mappingMode", m_mappingMode);
 
   // Set uniform variables for the current model
-  abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &m_modelMatrix[0][0]);
+  program.setUniform("modelMatrix", m_modelMatrix);
 
   auto const modelViewMatrix{glm::mat3(m_viewMatrix * m_modelMatrix)};
   auto const normalMatrix{glm::inverseTranspose(modelViewMatrix)};
-  abcg::glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, &normalMatrix[0][0]);
-
-  abcg::glUniform4fv(KaLoc, 1, &m_Ka.x);
-  abcg::glUniform4fv(KdLoc, 1, &m_Kd.x);
-  abcg::glUniform4fv(KsLoc, 1, &m_Ks.x);
-  abcg::glUniform1f(shininessLoc, m_shininess);
+  program.setUniform("normalMatrix", normalMatrix);
 
   m_model.render(m_trianglesToDraw);
 
@@ -284,7 +286,7 @@ void Window::onPaintUI() {
       // Set up VAO if shader program has changed
       if (gsl::narrow<int>(currentIndex) != m_currentProgramIndex) {
         m_currentProgramIndex = gsl::narrow<int>(currentIndex);
-        m_model.setupVAO(m_programs.at(m_currentProgramIndex));
+        m_model.setupVAO(GLuint{m_programs.at(m_currentProgramIndex)});
       }
     }
 
@@ -383,7 +385,10 @@ void Window::onResize(glm::ivec2 const &size) {
 
 void Window::onDestroy() {
   m_model.destroy();
-  for (auto const &program : m_programs) {
-    abcg::glDeleteProgram(program);
+  m_textureStreamer.destroy();
+  m_frameUBO.destroy();
+  m_materialUBO.destroy();
+  for (auto &program : m_programs) {
+    program.destroy();
   }
 }
\ No newline at end of file
@@ -5,6 +5,38 @@
 #include "model.hpp"
 #include "trackball.hpp"
 
+// Uniform buffer binding points shared by every program
+constexpr GLuint frameDataBinding{0};
+constexpr GLuint materialDataBinding{1};
+
+// Layout of the FrameData uniform block
+struct FrameData {
+  glm::mat4 viewMatrix{1.0f};
+  glm::mat4 projMatrix{1.0f};
+  glm::vec4 lightDirWorldSpace{};
+  glm::vec4 Ia{};
+  glm::vec4 Id{};
+  glm::vec4 Is{};
+};
+ABCG_CHECK_STD140(FrameData, viewMatrix);
+ABCG_CHECK_STD140(FrameData, projMatrix);
+ABCG_CHECK_STD140(FrameData, lightDirWorldSpace);
+ABCG_CHECK_STD140(FrameData, Ia);
+ABCG_CHECK_STD140(FrameData, Id);
+ABCG_CHECK_STD140(FrameData, Is);
+
+// Layout of the MaterialData uniform block (padded to a multiple of 16 bytes)
+struct alignas(16) MaterialData {
+  glm::vec4 Ka{};
+  glm::vec4 Kd{};
+  glm::vec4 Ks{};
+  float shininess{};
+};
+ABCG_CHECK_STD140(MaterialData, Ka);
+ABCG_CHECK_STD140(MaterialData, Kd);
+ABCG_CHECK_STD140(MaterialData, Ks);
+ABCG_CHECK_STD140(MaterialData, shininess);
+
 class Window : public abcg::OpenGLWindow {
 protected:
   void onEvent(SDL_Event const &event) override;
@@ -19,6 +51,7 @@ private:
   glm::ivec2 m_viewportSize{};
 
   Model m_model;
+  abcg::OpenGLTextureStreamer m_textureStreamer;
   int m_trianglesToDraw{};
 
   TrackBall m_trackBallModel;
@@ -32,9 +65,13 @@ private:
   // Shaders
   std::vector<char const *> m_shaderNames{"texture", "blinnphong", "phong",
                                           "gouraud", "normal",     "depth"};
-  std::vector<GLuint> m_programs;
+  std::vector<abcg::OpenGLProgram> m_programs;
   int m_currentProgramIndex{};
 
+  // Uniform buffers
+  abcg::OpenGLUniformBuffer m_frameUBO;
+  abcg::OpenGLUniformBuffer m_materialUBO;
+
   // Mapping mode
   // 0: triplanar; 1: cylindrical; 2: spherical; 3: from mesh
   int m_mappingMode{};
@@ -4,8 +4,15 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projMatrix;
+
+// Per-frame data shared by every program
+layout(std140) uniform FrameData {
+  highp mat4 viewMatrix;
+  highp mat4 projMatrix;
+  highp vec4 lightDirWorldSpace;
+  highp vec4 Ia, Id, Is;
+};
+
 uniform mat3 normalMatrix;
 
 out vec3 fragP;
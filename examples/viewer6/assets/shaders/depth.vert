@@ -3,8 +3,14 @@
 layout(location = 0) in vec3 inPosition;
 
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projMatrix;
+
+// Per-frame data shared by every program
+layout(std140) uniform FrameData {
+  highp mat4 viewMatrix;
+  highp mat4 projMatrix;
+  highp vec4 lightDirWorldSpace;
+  highp vec4 Ia, Id, Is;
+};
 
 out vec4 fragColor;
 
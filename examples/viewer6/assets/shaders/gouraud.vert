@@ -4,17 +4,22 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projMatrix;
-uniform mat3 normalMatrix;
 
-// Light properties
-uniform vec4 lightDirWorldSpace;
-uniform vec4 Ia, Id, Is;
+// Per-frame data shared by every program
+layout(std140) uniform FrameData {
+  highp mat4 viewMatrix;
+  highp mat4 projMatrix;
+  highp vec4 lightDirWorldSpace;
+  highp vec4 Ia, Id, Is;
+};
 
 // Material properties
-uniform vec4 Ka, Kd, Ks;
-uniform float shininess;
+layout(std140) uniform MaterialData {
+  highp vec4 Ka, Kd, Ks;
+  highp float shininess;
+};
+
+uniform mat3 normalMatrix;
 
 out vec4 fragColor;
 
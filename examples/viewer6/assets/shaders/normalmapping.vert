@@ -6,10 +6,14 @@ layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec4 inTangent;
 
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projMatrix;
 
-uniform vec4 lightDirWorldSpace;
+// Per-frame data shared by every program
+layout(std140) uniform FrameData {
+  highp mat4 viewMatrix;
+  highp mat4 projMatrix;
+  highp vec4 lightDirWorldSpace;
+  highp vec4 Ia, Id, Is;
+};
 
 out vec2 fragTexCoord;
 out vec3 fragPObj;
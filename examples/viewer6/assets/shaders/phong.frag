@@ -6,12 +6,19 @@ in vec3 fragN;
 in vec3 fragL;
 in vec3 fragV;
 
-// Light properties
-uniform vec4 Ia, Id, Is;
+// Per-frame data shared by every program
+layout(std140) uniform FrameData {
+  highp mat4 viewMatrix;
+  highp mat4 projMatrix;
+  highp vec4 lightDirWorldSpace;
+  highp vec4 Ia, Id, Is;
+};
 
 // Material properties
-uniform vec4 Ka, Kd, Ks;
-uniform float shininess;
+layout(std140) uniform MaterialData {
+  highp vec4 Ka, Kd, Ks;
+  highp float shininess;
+};
 
 out vec4 outColor;
 
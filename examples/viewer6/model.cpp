@@ -1,131 +1,221 @@
 #include "model.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <filesystem>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+
+namespace {
+// Header of a binary mesh cache file. It is followed by the material and
+// submesh tables, then by the vertex array and the index array, both ready to
+// be uploaded to buffer objects.
+struct MeshCacheHeader {
+  std::array<char, 8> magic{};
+  std::uint32_t version{};
+  std::uint32_t vertexSize{};
+  std::uint64_t sourceSize{};
+  std::int64_t sourceTime{};
+  std::uint32_t numVertices{};
+  std::uint32_t numIndices{};
+  std::uint32_t numMaterials{};
+  std::uint32_t numSubmeshes{};
+  std::uint32_t numLODs{};
+  std::array<std::uint32_t, Model::maxLODs> lodNumSubmeshes{};
+  std::array<float, Model::maxLODs> lodErrors{};
+  std::uint32_t standardized{};
+  std::uint32_t optimized{};
+  std::uint32_t hasTexCoords{};
+  glm::vec3 boundsMin{};
+  glm::vec3 boundsMax{};
+};
+static_assert(std::is_trivially_copyable_v<MeshCacheHeader>);
 
-// Explicit specialization of std::hash for Vertex
-template <> struct std::hash<Vertex> {
-  size_t operator()(Vertex const &vertex) const noexcept {
-    auto const h1{std::hash<glm::vec3>()(vertex.position)};
-    auto const h2{std::hash<glm::vec3>()(vertex.normal)};
-    auto const h3{std::hash<glm::vec2>()(vertex.texCoord)};
-    return abcg::hashCombine(h1, h2, h3);
-  }
+struct MeshCacheMaterial {
+  MaterialData data{};
+  std::array<char, 256> diffuseTextureName{};
+  std::array<char, 256> normalTextureName{};
 };
+static_assert(std::is_trivially_copyable_v<MeshCacheMaterial>);
 
-void Model::computeNormals() {
-  // Clear previous vertex normals
-  for (auto &vertex : m_vertices) {
-    vertex.normal = glm::vec3(0.0f);
-  }
+// Submeshes are stored in order, so only their sizes are needed
+struct MeshCacheSubmesh {
+  std::uint32_t material{};
+  std::uint32_t numIndices{};
+};
 
-  // Compute face normals
-  for (auto const offset : iter::range(0UL, m_indices.size(), 3UL)) {
-    // Get face vertices
-    auto &a{m_vertices.at(m_indices.at(offset + 0))};
-    auto &b{m_vertices.at(m_indices.at(offset + 1))};
-    auto &c{m_vertices.at(m_indices.at(offset + 2))};
+// The vertex array is read in place, so everything before it must keep it
+// aligned
+static_assert(sizeof(MeshCacheHeader) % alignof(Vertex) == 0);
+static_assert(sizeof(MeshCacheMaterial) % alignof(Vertex) == 0);
+static_assert(sizeof(MeshCacheSubmesh) % alignof(Vertex) == 0);
+
+constexpr std::array<char, 8> meshCacheMagic{'A', 'B', 'C', 'G',
+                                             'M', 'E', 'S', 'H'};
+// Increment whenever the layout of the cache or Vertex changes
+constexpr std::uint32_t meshCacheVersion{5};
+
+// Initial textures of the units used by bindMaterial. No texture has this name,
+// so the textures of the first material are always bound.
+constexpr std::array<GLuint, 2> unboundTextures{~0U, ~0U};
+
+// Returns the path of the cache file of a mesh file
+std::filesystem::path meshCachePath(std::filesystem::path const &sourcePath) {
+  std::error_code errorCode;
+  auto const absolutePath{std::filesystem::absolute(sourcePath, errorCode)};
+  auto const key{std::hash<std::string>{}(absolutePath.string())};
+  return std::filesystem::path{abcg::Application::getBasePath()} /
+         "meshcache" /
+         fmt::format("{}-{:016x}.mesh", sourcePath.stem().string(), key);
+}
 
-    // Compute normal
-    auto const edge1{b.position - a.position};
-    auto const edge2{c.position - b.position};
-    auto const normal{glm::cross(edge1, edge2)};
+// Size and modification time of a mesh file, used to detect stale caches
+std::pair<std::uint64_t, std::int64_t>
+sourceStamp(std::filesystem::path const &sourcePath) {
+  std::error_code errorCode;
+  auto const size{std::filesystem::file_size(sourcePath, errorCode)};
+  if (errorCode)
+    return {};
+  auto const time{std::filesystem::last_write_time(sourcePath, errorCode)};
+  if (errorCode)
+    return {};
+  return {size, time.time_since_epoch().count()};
+}
+
+template <std::size_t N>
+std::string_view toStringView(std::array<char, N> const &name) {
+  return {name.data(), std::strlen(name.data())};
+}
+
+// Returns false if the name does not fit, as a truncated name would be wrong
+template <std::size_t N>
+bool toCharArray(std::string_view name, std::array<char, N> &array) {
+  if (name.size() >= array.size())
+    return false;
+  std::ranges::copy(name, array.begin());
+  return true;
+}
 
-    // Accumulate on vertices
-    a.normal += normal;
-    b.normal += normal;
-    c.normal += normal;
+// Quantizes the vertex attributes. Positions are mapped to [-1, 1] by a
+// translation and a uniform scale, and decodeMatrix is set to the inverse
+// transformation. Positions that are already in [-1, 1] (e.g., of standardized
+// models) are not transformed, so that shaders that use model-space positions
+// still get the same values.
+std::vector<PackedVertex> packVertices(std::span<Vertex const> vertices,
+                                       glm::mat4 &decodeMatrix) {
+  glm::vec3 max(std::numeric_limits<float>::lowest());
+  glm::vec3 min(std::numeric_limits<float>::max());
+  for (auto const &vertex : vertices) {
+    max = glm::max(max, vertex.position);
+    min = glm::min(min, vertex.position);
   }
 
-  // Normalize
-  for (auto &vertex : m_vertices) {
-    vertex.normal = glm::normalize(vertex.normal);
+  glm::vec3 center{0.0f};
+  auto scale{1.0f};
+  if (glm::any(glm::lessThan(min, glm::vec3(-1.0f))) ||
+      glm::any(glm::greaterThan(max, glm::vec3(1.0f)))) {
+    center = (min + max) / 2.0f;
+    auto const halfExtent{(max - min) / 2.0f};
+    scale = std::max({halfExtent.x, halfExtent.y, halfExtent.z});
+  }
+  decodeMatrix = glm::scale(glm::translate(glm::mat4{1.0f}, center),
+                            glm::vec3{scale});
+
+  std::vector<PackedVertex> packedVertices;
+  packedVertices.reserve(vertices.size());
+  for (auto const &vertex : vertices) {
+    auto const position{glm::round(
+        glm::clamp((vertex.position - center) / scale, -1.0f, 1.0f) *
+        32767.0f)};
+    packedVertices.push_back(
+        {.position = {static_cast<std::int16_t>(position.x),
+                      static_cast<std::int16_t>(position.y),
+                      static_cast<std::int16_t>(position.z), 0},
+         .normal = glm::packSnorm3x10_1x2(glm::vec4(vertex.normal, 0.0f)),
+         .tangent = glm::packSnorm3x10_1x2(vertex.tangent),
+         .texCoord = glm::packHalf2x16(vertex.texCoord)});
+  }
+  return packedVertices;
+}
+// Returns the planes of the view frustum in the space transformed by the given
+// matrix, with normals of unit length pointing inwards
+std::array<glm::vec4, 6> frustumPlanes(glm::mat4 const &clipMatrix) {
+  auto const rows{glm::transpose(clipMatrix)};
+  std::array planes{rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+                    rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2]};
+  for (auto &plane : planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+  return planes;
+}
+} // namespace
+
+void Model::computeNormals(abcg::VertexAdjacency const &adjacency) {
+  std::vector<glm::vec3> positions;
+  positions.reserve(m_vertices.size());
+  for (auto const &vertex : m_vertices) {
+    positions.push_back(vertex.position);
+  }
+
+  std::vector<glm::vec3> normals(m_vertices.size());
+  abcg::computeVertexNormals(adjacency, m_indices, positions, normals);
+  for (auto &&[vertex, normal] : iter::zip(m_vertices, normals)) {
+    vertex.normal = normal;
   }
 
   m_hasNormals = true;
 }
 
-void Model::computeTangents() {
-  // Reserve space for bitangents
-  std::vector bitangents(m_vertices.size(), glm::vec3(0));
-
-  // Compute face tangents and bitangents
-  for (auto const offset : iter::range(0UL, m_indices.size(), 3UL)) {
-    // Get face indices
-    auto const i1{m_indices.at(offset + 0)};
-    auto const i2{m_indices.at(offset + 1)};
-    auto const i3{m_indices.at(offset + 2)};
-
-    // Get face vertices
-    auto &v1{m_vertices.at(i1)};
-    auto &v2{m_vertices.at(i2)};
-    auto &v3{m_vertices.at(i3)};
-
-    auto const e1{v2.position - v1.position};
-    auto const e2{v3.position - v1.position};
-    auto const delta1{v2.texCoord - v1.texCoord};
-    auto const delta2{v3.texCoord - v1.texCoord};
-
-    glm::mat2 M;
-    M[0][0] = delta2.t;
-    M[0][1] = -delta1.t;
-    M[1][0] = -delta2.s;
-    M[1][1] = delta1.s;
-    M *= (1.0f / (delta1.s * delta2.t - delta2.s * delta1.t));
-
-    auto const tangent{glm::vec4(M[0][0] * e1.x + M[0][1] * e2.x,
-                                 M[0][0] * e1.y + M[0][1] * e2.y,
-                                 M[0][0] * e1.z + M[0][1] * e2.z, 0.0f)};
-
-    auto const bitangent{glm::vec3(M[1][0] * e1.x + M[1][1] * e2.x,
-                                   M[1][0] * e1.y + M[1][1] * e2.y,
-                                   M[1][0] * e1.z + M[1][1] * e2.z)};
-
-    // Accumulate on vertices
-    v1.tangent += tangent;
-    v2.tangent += tangent;
-    v3.tangent += tangent;
-
-    bitangents.at(i1) += bitangent;
-    bitangents.at(i2) += bitangent;
-    bitangents.at(i3) += bitangent;
-  }
-
-  for (auto &&[i, vertex] : iter::enumerate(m_vertices)) {
-    auto const &n{vertex.normal};
-    auto const &t{glm::vec3(vertex.tangent)};
-
-    // Orthogonalize t with respect to n
-    auto const tangent{t - n * glm::dot(n, t)};
-    vertex.tangent = glm::vec4(glm::normalize(tangent), 0);
-
-    // Compute handedness of re-orthogonalized basis
-    auto const b{glm::cross(n, t)};
-    auto const handedness{glm::dot(b, bitangents.at(i))};
-    vertex.tangent.w = (handedness < 0.0f) ? -1.0f : 1.0f;
+void Model::computeTangents(abcg::VertexAdjacency const &adjacency) {
+  std::vector<glm::vec3> positions;
+  std::vector<glm::vec3> normals;
+  std::vector<glm::vec2> texCoords;
+  positions.reserve(m_vertices.size());
+  normals.reserve(m_vertices.size());
+  texCoords.reserve(m_vertices.size());
+  for (auto const &vertex : m_vertices) {
+    positions.push_back(vertex.position);
+    normals.push_back(vertex.normal);
+    texCoords.push_back(vertex.texCoord);
+  }
+
+  std::vector<glm::vec4> tangents(m_vertices.size());
+  abcg::computeVertexTangents(adjacency, m_indices, positions, normals,
+                              texCoords, tangents);
+  for (auto &&[vertex, tangent] : iter::zip(m_vertices, tangents)) {
+    vertex.tangent = tangent;
   }
 }
 
-void Model::createBuffers() {
+void Model::createBuffers(std::span<Vertex const> vertices,
+                          std::span<GLuint const> indices) {
   // Delete previous buffers
-  abcg::glDeleteBuffers(1, &m_EBO);
+  m_indexBuffer.destroy();
   abcg::glDeleteBuffers(1, &m_VBO);
 
   // VBO
   abcg::glGenBuffers(1, &m_VBO);
   abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-  abcg::glBufferData(GL_ARRAY_BUFFER,
-                     sizeof(m_vertices.at(0)) * m_vertices.size(),
-                     m_vertices.data(), GL_STATIC_DRAW);
+  if (m_vertexFormat == VertexFormat::Packed) {
+    auto const packedVertices{packVertices(vertices, m_positionDecodeMatrix)};
+    auto const packedSize{packedVertices.size() * sizeof(PackedVertex)};
+    abcg::glBufferData(GL_ARRAY_BUFFER, packedSize, packedVertices.data(),
+                       GL_STATIC_DRAW);
+    fmt::print("Packed vertices into {} KiB ({} KiB unpacked)\n",
+               packedSize / 1024, vertices.size_bytes() / 1024);
+  } else {
+    m_positionDecodeMatrix = glm::mat4{1.0f};
+    abcg::glBufferData(GL_ARRAY_BUFFER, vertices.size_bytes(),
+                       vertices.data(), GL_STATIC_DRAW);
+  }
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-  // EBO
-  abcg::glGenBuffers(1, &m_EBO);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  abcg::glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     sizeof(m_indices.at(0)) * m_indices.size(),
-                     m_indices.data(), GL_STATIC_DRAW);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  // EBO with 16-bit indices whenever possible
+  m_indexBuffer.create(indices, vertices.size());
 }
 
 void Model::loadCubeTexture(std::string const &path) {
@@ -144,6 +234,11 @@ void Model::loadDiffuseTexture(std::string_view path) {
 
   abcg::glDeleteTextures(1, &m_diffuseTexture);
   m_diffuseTexture = abcg::loadOpenGLTexture({.path = path});
+
+  // Replace the textures of the materials as well
+  for (auto &material : m_materials) {
+    material.diffuseTexture = 0;
+  }
 }
 
 void Model::loadNormalTexture(std::string_view path) {
@@ -152,136 +247,632 @@ void Model::loadNormalTexture(std::string_view path) {
 
   abcg::glDeleteTextures(1, &m_normalTexture);
   m_normalTexture = abcg::loadOpenGLTexture({.path = path});
+
+  // Replace the textures of the materials as well
+  for (auto &material : m_materials) {
+    material.normalTexture = 0;
+  }
 }
 
-void Model::loadObj(std::string_view path, bool standardize) {
-  auto const basePath{std::filesystem::path{path}.parent_path().string() + "/"};
+// Sorts the materials by texture names and the triangles by material, so that
+// each material is drawn with a single range of indices and consecutive ranges
+// usually share textures. Materials without triangles are discarded.
+void Model::groupByMaterial(std::vector<Material> materials,
+                            std::span<std::uint32_t const> triangleMaterials,
+                            std::string const &basePath) {
+  std::vector<std::size_t> materialSizes(materials.size());
+  for (auto const material : triangleMaterials) {
+    materialSizes.at(material) += 3;
+  }
 
-  tinyobj::ObjReaderConfig readerConfig;
-  readerConfig.mtl_search_path = basePath; // Path to material files
+  std::vector<std::size_t> order;
+  for (auto const material : iter::range(materials.size())) {
+    if (materialSizes.at(material) > 0) {
+      order.push_back(material);
+    }
+  }
+  std::ranges::stable_sort(order, [&](auto lhs, auto rhs) {
+    return std::tie(materials.at(lhs).diffuseTextureName,
+                    materials.at(lhs).normalTextureName) <
+           std::tie(materials.at(rhs).diffuseTextureName,
+                    materials.at(rhs).normalTextureName);
+  });
+
+  // Submeshes of the original mesh, in the sorted order
+  std::vector<Material> sortedMaterials;
+  std::vector<std::size_t> nextIndex(materials.size());
+  m_submeshes.clear();
+  std::size_t firstIndex{};
+  for (auto const material : order) {
+    nextIndex.at(material) = firstIndex;
+    m_submeshes.push_back({.material = sortedMaterials.size(),
+                           .firstIndex = firstIndex,
+                           .numIndices = materialSizes.at(material)});
+    sortedMaterials.push_back(std::move(materials.at(material)));
+    firstIndex += materialSizes.at(material);
+  }
+  m_lods = {{.firstIndex = 0,
+             .numIndices = firstIndex,
+             .firstSubmesh = 0,
+             .numSubmeshes = m_submeshes.size()}};
+
+  // Counting sort of the triangles by material
+  std::vector<GLuint> sortedIndices(m_indices.size());
+  for (auto &&[triangle, material] : iter::enumerate(triangleMaterials)) {
+    auto &index{nextIndex.at(material)};
+    std::copy_n(m_indices.begin() + gsl::narrow<std::ptrdiff_t>(triangle * 3),
+                3, sortedIndices.begin() + gsl::narrow<std::ptrdiff_t>(index));
+    index += 3;
+  }
+  m_indices = std::move(sortedIndices);
 
-  tinyobj::ObjReader reader;
+  createMaterials(std::move(sortedMaterials), basePath);
+}
 
-  if (!reader.ParseFromFile(path.data(), readerConfig)) {
-    if (!reader.Error().empty()) {
-      throw abcg::RuntimeError(
-          fmt::format("Failed to load model {} ({})", path, reader.Error()));
+// Loads the textures of the materials, each distinct file once, and uploads
+// the material properties to a uniform buffer with one slot per material
+void Model::createMaterials(std::vector<Material> materials,
+                            std::string const &basePath) {
+  abcg::glDeleteTextures(gsl::narrow<GLsizei>(m_materialTextures.size()),
+                         m_materialTextures.data());
+  m_materialTextures.clear();
+  abcg::glDeleteBuffers(1, &m_materialUBO);
+
+  m_materials = std::move(materials);
+
+  std::unordered_map<std::string, GLuint> textures;
+  auto const loadTexture{[&](std::string const &name) -> GLuint {
+    if (name.empty())
+      return 0;
+    auto const [texture, inserted]{textures.try_emplace(name, 0)};
+    if (inserted && std::filesystem::exists(basePath + name)) {
+      texture->second = abcg::loadOpenGLTexture({.path = basePath + name});
+      m_materialTextures.push_back(texture->second);
     }
-    throw abcg::RuntimeError(fmt::format("Failed to load model {}", path));
+    return texture->second;
+  }};
+  for (auto &material : m_materials) {
+    material.diffuseTexture = loadTexture(material.diffuseTextureName);
+    material.normalTexture = loadTexture(material.normalTextureName);
   }
 
-  if (!reader.Warning().empty()) {
-    fmt::print("Warning: {}\n", reader.Warning());
+  // Each slot starts at a multiple of the offset alignment
+  GLint offsetAlignment{};
+  abcg::glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+  auto const alignment{
+      std::max(gsl::narrow<std::size_t>(offsetAlignment), std::size_t{1})};
+  m_materialStride =
+      (sizeof(MaterialData) + alignment - 1) / alignment * alignment;
+
+  std::vector<std::byte> data(m_materialStride * m_materials.size());
+  for (auto &&[index, material] : iter::enumerate(m_materials)) {
+    std::memcpy(data.data() + index * m_materialStride, &material.data,
+                sizeof(MaterialData));
   }
+  abcg::glGenBuffers(1, &m_materialUBO);
+  abcg::glBindBuffer(GL_UNIFORM_BUFFER, m_materialUBO);
+  abcg::glBufferData(GL_UNIFORM_BUFFER, gsl::narrow<GLsizeiptr>(data.size()),
+                     data.data(), GL_STATIC_DRAW);
+  abcg::glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
 
-  auto const &attrib{reader.GetAttrib()};
-  auto const &shapes{reader.GetShapes()};
-  auto const &materials{reader.GetMaterials()};
+void Model::setMaterialData(std::size_t material, MaterialData const &data) {
+  m_materials.at(material).data = data;
+
+  abcg::glBindBuffer(GL_UNIFORM_BUFFER, m_materialUBO);
+  abcg::glBufferSubData(GL_UNIFORM_BUFFER,
+                        gsl::narrow<GLintptr>(material * m_materialStride),
+                        sizeof(MaterialData), &data);
+  abcg::glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void Model::loadObj(std::string_view path, bool standardize, bool optimize) {
+  auto const basePath{std::filesystem::path{path}.parent_path().string() + "/"};
+
+  // Reuse the mesh processed by a previous load of the same file
+  auto const cachePath{meshCachePath(path)};
+  if (loadMeshCache(cachePath, path, basePath, standardize, optimize))
+    return;
+
+  // Parse the file and weld the vertices using all cores
+  abcg::Timer timer;
+  auto const contents{abcg::readObj(path)};
+  auto const parseTime{timer.elapsed()};
+
+  if (!contents.warning.empty()) {
+    fmt::print("Warning: {}\n", contents.warning);
+  }
+
+  auto const &attrib{contents.attrib};
+  auto const &shapes{contents.shapes};
+  auto const &materials{contents.materials};
 
   m_vertices.clear();
   m_indices.clear();
 
-  m_hasNormals = false;
-  m_hasTexCoords = false;
+  // Concatenate the indices of all shapes
+  std::vector<tinyobj::index_t> objIndices;
+  for (auto const &shape : shapes) {
+    objIndices.insert(objIndices.end(), shape.mesh.indices.begin(),
+                      shape.mesh.indices.end());
+  }
 
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
+  m_hasNormals = std::ranges::any_of(objIndices, [](auto const &index) {
+    return index.normal_index >= 0;
+  });
+  m_hasTexCoords = std::ranges::any_of(objIndices, [](auto const &index) {
+    return index.texcoord_index >= 0;
+  });
+
+  auto const getVertex{[&](std::size_t offset) {
+    auto const index{objIndices[offset]};
+
+    // Position
+    auto const startIndex{3 * index.vertex_index};
+    glm::vec3 position{attrib.vertices.at(startIndex + 0),
+                       attrib.vertices.at(startIndex + 1),
+                       attrib.vertices.at(startIndex + 2)};
+
+    // Normal
+    glm::vec3 normal{};
+    if (index.normal_index >= 0) {
+      auto const normalStartIndex{3 * index.normal_index};
+      normal = {attrib.normals.at(normalStartIndex + 0),
+                attrib.normals.at(normalStartIndex + 1),
+                attrib.normals.at(normalStartIndex + 2)};
+    }
+
+    // Texture coordinates
+    glm::vec2 texCoord{};
+    if (index.texcoord_index >= 0) {
+      auto const texCoordsStartIndex{2 * index.texcoord_index};
+      texCoord = {attrib.texcoords.at(texCoordsStartIndex + 0),
+                  attrib.texcoords.at(texCoordsStartIndex + 1)};
+    }
+
+    return Vertex{.position = position, .normal = normal, .texCoord = texCoord};
+  }};
+  abcg::weldVertices(objIndices.size(), getVertex, m_vertices, m_indices);
+
+  fmt::print("Parsed in {:.2f} ms, welded {} vertices into {} in {:.2f} ms\n",
+             parseTime * 1000.0, m_indices.size(), m_vertices.size(),
+             (timer.elapsed() - parseTime) * 1000.0);
 
-  // Loop over shapes
+  // Material of each triangle. Faces without a valid material use a default
+  // material appended after those of the file.
+  auto const defaultMaterial{gsl::narrow<std::uint32_t>(materials.size())};
+  std::vector<std::uint32_t> triangleMaterials;
+  triangleMaterials.reserve(m_indices.size() / 3);
   for (auto const &shape : shapes) {
-    // Loop over indices
-    for (auto const offset : iter::range(shape.mesh.indices.size())) {
-      // Access to vertex
-      auto const index{shape.mesh.indices.at(offset)};
-
-      // Position
-      auto const startIndex{3 * index.vertex_index};
-      glm::vec3 position{attrib.vertices.at(startIndex + 0),
-                         attrib.vertices.at(startIndex + 1),
-                         attrib.vertices.at(startIndex + 2)};
-
-      // Normal
-      glm::vec3 normal{};
-      if (index.normal_index >= 0) {
-        m_hasNormals = true;
-        auto const normalStartIndex{3 * index.normal_index};
-        normal = {attrib.normals.at(normalStartIndex + 0),
-                  attrib.normals.at(normalStartIndex + 1),
-                  attrib.normals.at(normalStartIndex + 2)};
-      }
+    for (auto const materialID : shape.mesh.material_ids) {
+      triangleMaterials.push_back(
+          materialID >= 0 && std::cmp_less(materialID, materials.size())
+              ? gsl::narrow<std::uint32_t>(materialID)
+              : defaultMaterial);
+    }
+  }
 
-      // Texture coordinates
-      glm::vec2 texCoord{};
-      if (index.texcoord_index >= 0) {
-        m_hasTexCoords = true;
-        auto const texCoordsStartIndex{2 * index.texcoord_index};
-        texCoord = {attrib.texcoords.at(texCoordsStartIndex + 0),
-                    attrib.texcoords.at(texCoordsStartIndex + 1)};
-      }
+  std::vector<Material> objMaterials;
+  for (auto const &mat : materials) {
+    objMaterials.push_back(
+        {.data = {.Ka = {mat.ambient[0], mat.ambient[1], mat.ambient[2], 1},
+                  .Kd = {mat.diffuse[0], mat.diffuse[1], mat.diffuse[2], 1},
+                  .Ks = {mat.specular[0], mat.specular[1], mat.specular[2],
+                         1},
+                  .shininess = mat.shininess},
+         .diffuseTextureName = mat.diffuse_texname,
+         .normalTextureName = mat.normal_texname.empty()
+                                  ? mat.bump_texname
+                                  : mat.normal_texname});
+  }
+  // Default values
+  objMaterials.push_back({.data = {.Ka = {0.1f, 0.1f, 0.1f, 1.0f},
+                                   .Kd = {0.7f, 0.7f, 0.7f, 1.0f},
+                                   .Ks = {1.0f, 1.0f, 1.0f, 1.0f},
+                                   .shininess = 25.0f}});
 
-      Vertex const vertex{
-          .position = position, .normal = normal, .texCoord = texCoord};
+  groupByMaterial(std::move(objMaterials), triangleMaterials, basePath);
 
-      // If hash doesn't contain this vertex
-      if (!hash.contains(vertex)) {
-        // Add this index (size of m_vertices)
-        hash[vertex] = m_vertices.size();
-        // Add this vertex
-        m_vertices.push_back(vertex);
-      }
+  if (standardize) {
+    Model::standardize();
+  }
+
+  // Normals and tangents are gathered from the triangles adjacent to each
+  // vertex, using all cores
+  if (!m_hasNormals || m_hasTexCoords) {
+    timer.restart();
+    auto const adjacency{
+        abcg::buildVertexAdjacency(m_indices, m_vertices.size())};
 
-      m_indices.push_back(hash[vertex]);
+    if (!m_hasNormals) {
+      computeNormals(adjacency);
     }
+
+    if (m_hasTexCoords) {
+      computeTangents(adjacency);
+    }
+
+    fmt::print("Computed normals and tangents in {:.2f} ms\n",
+               timer.elapsed() * 1000.0);
   }
 
-  // Use properties of first material, if available
-  if (!materials.empty()) {
-    auto const &mat{materials.at(0)}; // First material
-    m_Ka = {mat.ambient[0], mat.ambient[1], mat.ambient[2], 1};
-    m_Kd = {mat.diffuse[0], mat.diffuse[1], mat.diffuse[2], 1};
-    m_Ks = {mat.specular[0], mat.specular[1], mat.specular[2], 1};
-    m_shininess = mat.shininess;
+  if (optimize) {
+    optimizeMesh();
+  }
 
-    if (!mat.diffuse_texname.empty())
-      loadDiffuseTexture(basePath + mat.diffuse_texname);
+  buildLODs(optimize);
+  buildMeshlets(m_vertices, m_indices);
 
-    if (!mat.normal_texname.empty()) {
-      loadNormalTexture(basePath + mat.normal_texname);
-    } else if (!mat.bump_texname.empty()) {
-      loadNormalTexture(basePath + mat.bump_texname);
+  createBuffers(m_vertices, m_indices);
+
+  saveMeshCache(cachePath, path, standardize, optimize);
+}
+
+// Loads a mesh from a cache file written by Model::saveMeshCache. The file is
+// memory-mapped and its arrays are uploaded without any processing. Returns
+// false if the cache does not exist or is stale.
+bool Model::loadMeshCache(std::filesystem::path const &cachePath,
+                          std::filesystem::path const &sourcePath,
+                          std::string const &basePath, bool standardized,
+                          bool optimized) {
+  abcg::MappedFile file;
+  if (!file.open(cachePath))
+    return false;
+
+  auto const data{file.getData()};
+  if (data.size() < sizeof(MeshCacheHeader))
+    return false;
+
+  MeshCacheHeader header;
+  std::memcpy(&header, data.data(), sizeof(header));
+  auto const [sourceSize, sourceTime] = sourceStamp(sourcePath);
+  auto const materialsSize{std::size_t{header.numMaterials} *
+                           sizeof(MeshCacheMaterial)};
+  auto const submeshesSize{std::size_t{header.numSubmeshes} *
+                           sizeof(MeshCacheSubmesh)};
+  auto const verticesOffset{sizeof(header) + materialsSize + submeshesSize};
+  auto const verticesSize{std::size_t{header.numVertices} * sizeof(Vertex)};
+  auto const indicesSize{std::size_t{header.numIndices} * sizeof(GLuint)};
+  if (header.magic != meshCacheMagic || header.version != meshCacheVersion ||
+      header.vertexSize != sizeof(Vertex) || header.sourceSize != sourceSize ||
+      header.sourceTime != sourceTime ||
+      header.standardized != std::uint32_t{standardized} ||
+      header.optimized != std::uint32_t{optimized} ||
+      data.size() != verticesOffset + verticesSize + indicesSize ||
+      header.numLODs == 0 || header.numLODs > maxLODs)
+    return false;
+
+  // The arrays are suitably aligned, as the file is mapped at a page boundary
+  // and the sizes of the header and tables are multiples of alignof(Vertex)
+  std::span const vertices{
+      reinterpret_cast<Vertex const *>(data.subspan(verticesOffset).data()),
+      header.numVertices};
+  std::span const indices{
+      reinterpret_cast<GLuint const *>(
+          data.subspan(verticesOffset + verticesSize).data()),
+      header.numIndices};
+
+  // An index past the vertex array would make the draw calls and the meshlet
+  // builder read out of bounds
+  if (std::ranges::any_of(indices, [&](GLuint const index) {
+        return index >= header.numVertices;
+      }))
+    return false;
+
+  // Rebuild the ranges of the submeshes and levels of detail
+  std::vector<Submesh> submeshes;
+  std::vector<LOD> lods;
+  std::size_t firstIndex{};
+  for (auto const lod : iter::range(header.numLODs)) {
+    lods.push_back({.firstIndex = firstIndex,
+                    .error = header.lodErrors.at(lod),
+                    .firstSubmesh = submeshes.size(),
+                    .numSubmeshes = header.lodNumSubmeshes.at(lod)});
+    for ([[maybe_unused]] auto const submesh :
+         iter::range(header.lodNumSubmeshes.at(lod))) {
+      if (submeshes.size() == header.numSubmeshes)
+        return false;
+      MeshCacheSubmesh cached;
+      std::memcpy(&cached,
+                  data.subspan(sizeof(header) + materialsSize +
+                               submeshes.size() * sizeof(cached))
+                      .data(),
+                  sizeof(cached));
+      if (cached.material >= header.numMaterials)
+        return false;
+      submeshes.push_back({.material = cached.material,
+                           .firstIndex = firstIndex,
+                           .numIndices = cached.numIndices});
+      firstIndex += cached.numIndices;
     }
-  } else {
-    // Default values
-    m_Ka = {0.1f, 0.1f, 0.1f, 1.0f};
-    m_Kd = {0.7f, 0.7f, 0.7f, 1.0f};
-    m_Ks = {1.0f, 1.0f, 1.0f, 1.0f};
-    m_shininess = 25.0f;
+    lods.back().numIndices = firstIndex - lods.back().firstIndex;
   }
+  if (submeshes.size() != header.numSubmeshes ||
+      firstIndex != header.numIndices)
+    return false;
+  m_submeshes = std::move(submeshes);
+  m_lods = std::move(lods);
+  setBounds(header.boundsMin, header.boundsMax);
 
-  if (standardize) {
-    Model::standardize();
+  m_vertices.clear();
+  m_indices.clear();
+  m_hasNormals = true;
+  m_hasTexCoords = header.hasTexCoords != 0;
+
+  std::vector<Material> materials;
+  for (auto const material : iter::range(header.numMaterials)) {
+    MeshCacheMaterial cached;
+    std::memcpy(&cached,
+                data.subspan(sizeof(header) + material * sizeof(cached)).data(),
+                sizeof(cached));
+    materials.push_back(
+        {.data = cached.data,
+         .diffuseTextureName = std::string{toStringView(
+             cached.diffuseTextureName)},
+         .normalTextureName = std::string{
+             toStringView(cached.normalTextureName)}});
   }
+  createMaterials(std::move(materials), basePath);
+
+  buildMeshlets(vertices, indices);
+  createBuffers(vertices, indices);
+
+  return true;
+}
 
-  if (!m_hasNormals) {
-    computeNormals();
+// Writes the processed mesh to a cache file. Errors are ignored, as the cache
+// is only an optimization.
+void Model::saveMeshCache(std::filesystem::path const &cachePath,
+                          std::filesystem::path const &sourcePath,
+                          bool standardized, bool optimized) const {
+  MeshCacheHeader header{
+      .magic = meshCacheMagic,
+      .version = meshCacheVersion,
+      .vertexSize = sizeof(Vertex),
+      .numVertices = gsl::narrow<std::uint32_t>(m_vertices.size()),
+      .numIndices = gsl::narrow<std::uint32_t>(m_indices.size()),
+      .numMaterials = gsl::narrow<std::uint32_t>(m_materials.size()),
+      .numSubmeshes = gsl::narrow<std::uint32_t>(m_submeshes.size()),
+      .numLODs = gsl::narrow<std::uint32_t>(m_lods.size()),
+      .standardized = standardized,
+      .optimized = optimized,
+      .hasTexCoords = m_hasTexCoords};
+  std::tie(header.sourceSize, header.sourceTime) = sourceStamp(sourcePath);
+  if (header.sourceSize == 0)
+    return;
+
+  for (auto &&[lod, level] : iter::enumerate(m_lods)) {
+    header.lodNumSubmeshes.at(lod) =
+        gsl::narrow<std::uint32_t>(level.numSubmeshes);
+    header.lodErrors.at(lod) = level.error;
+  }
+
+  std::vector<MeshCacheMaterial> materials;
+  for (auto const &material : m_materials) {
+    auto &cached{materials.emplace_back()};
+    cached.data = material.data;
+    if (!toCharArray(material.diffuseTextureName, cached.diffuseTextureName) ||
+        !toCharArray(material.normalTextureName, cached.normalTextureName))
+      return;
   }
 
-  if (m_hasTexCoords) {
-    computeTangents();
+  std::vector<MeshCacheSubmesh> submeshes;
+  for (auto const &submesh : m_submeshes) {
+    submeshes.push_back(
+        {.material = gsl::narrow<std::uint32_t>(submesh.material),
+         .numIndices = gsl::narrow<std::uint32_t>(submesh.numIndices)});
   }
 
-  createBuffers();
+  header.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+  header.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+  for (auto const &vertex : m_vertices) {
+    header.boundsMin = glm::min(header.boundsMin, vertex.position);
+    header.boundsMax = glm::max(header.boundsMax, vertex.position);
+  }
+
+  abcg::writeFileAtomically(cachePath,
+                            {std::as_bytes(std::span{&header, 1}),
+                             std::as_bytes(std::span{materials}),
+                             std::as_bytes(std::span{submeshes}),
+                             std::as_bytes(std::span{m_vertices}),
+                             std::as_bytes(std::span{m_indices})});
 }
 
-void Model::render(int numTriangles) const {
-  abcg::glBindVertexArray(m_VAO);
+// Appends to m_indices up to maxLODs - 1 simplified versions of the mesh, each
+// with about half the triangles of the previous one. Vertices are shared by all
+// levels, so only the indices are duplicated. Each submesh is simplified
+// separately.
+void Model::buildLODs(bool optimize) {
+  abcg::Timer timer;
+
+  glm::vec3 max(std::numeric_limits<float>::lowest());
+  glm::vec3 min(std::numeric_limits<float>::max());
+  for (auto const &vertex : m_vertices) {
+    max = glm::max(max, vertex.position);
+    min = glm::min(min, vertex.position);
+  }
+  setBounds(min, max);
+
+  // Vertices shared by submeshes are locked, so that submeshes simplified
+  // separately stay connected
+  std::vector<std::uint8_t> lockedVertices(m_vertices.size());
+  {
+    std::vector lastSubmesh(m_vertices.size(), m_submeshes.size());
+    for (auto &&[submesh, range] : iter::enumerate(m_submeshes)) {
+      for (auto const index : std::span{m_indices}.subspan(range.firstIndex,
+                                                           range.numIndices)) {
+        if (lastSubmesh[index] != m_submeshes.size() &&
+            lastSubmesh[index] != submesh) {
+          lockedVertices[index] = 1;
+        }
+        lastSubmesh[index] = submesh;
+      }
+    }
+  }
+
+  // Each submesh is compacted to the vertices it references before being
+  // simplified, so that the cost of each call does not depend on the size of
+  // the whole mesh. localIndices maps mesh vertices to submesh vertices and is
+  // reset after each submesh by visiting only the entries that were set
+  auto constexpr unmapped{~0U};
+  std::vector<GLuint> localIndices(m_vertices.size(), unmapped);
+  std::vector<GLuint> globalIndices;
+  std::vector<GLuint> submeshIndices;
+  std::vector<glm::vec3> submeshPositions;
+  std::vector<std::uint8_t> submeshLockedVertices;
+
+  while (m_lods.size() < maxLODs) {
+    auto const previous{m_lods.back()};
+    LOD level{.firstIndex = m_indices.size(),
+              .firstSubmesh = m_submeshes.size()};
+    auto error{0.0f};
+    for (auto const submesh : iter::range(previous.numSubmeshes)) {
+      auto const range{m_submeshes.at(previous.firstSubmesh + submesh)};
+
+      globalIndices.clear();
+      submeshIndices.clear();
+      submeshPositions.clear();
+      submeshLockedVertices.clear();
+      for (auto const index : std::span{m_indices}.subspan(range.firstIndex,
+                                                           range.numIndices)) {
+        if (localIndices[index] == unmapped) {
+          localIndices[index] = gsl::narrow<GLuint>(globalIndices.size());
+          globalIndices.push_back(index);
+          submeshPositions.push_back(m_vertices[index].position);
+          submeshLockedVertices.push_back(lockedVertices[index]);
+        }
+        submeshIndices.push_back(localIndices[index]);
+      }
+      for (auto const index : globalIndices) {
+        localIndices[index] = unmapped;
+      }
+
+      auto submeshError{0.0f};
+      auto indices{abcg::simplifyMesh(submeshIndices, submeshPositions,
+                                      range.numIndices / 2, &submeshError,
+                                      submeshLockedVertices)};
+      error = std::max(error, submeshError);
+
+      if (optimize) {
+        abcg::optimizeVertexCache(indices, globalIndices.size());
+      }
+
+      m_submeshes.push_back({.material = range.material,
+                             .firstIndex = m_indices.size(),
+                             .numIndices = indices.size()});
+      for (auto const index : indices) {
+        m_indices.push_back(globalIndices[index]);
+      }
+    }
+    level.numIndices = m_indices.size() - level.firstIndex;
+    level.numSubmeshes = m_submeshes.size() - level.firstSubmesh;
+
+    // Stop when the mesh can no longer be simplified significantly (e.g., due
+    // to UV seams and borders, which are preserved)
+    if (level.numIndices * 10 > previous.numIndices * 9) {
+      m_indices.resize(level.firstIndex);
+      m_submeshes.resize(level.firstSubmesh);
+      break;
+    }
+
+    // Errors accumulate, as each level is simplified from the previous one
+    level.error = previous.error + error;
+    m_lods.push_back(level);
+  }
+
+  fmt::print("Built {} levels of detail in {:.2f} ms (coarsest: {} "
+             "triangles)\n",
+             m_lods.size(), timer.elapsed() * 1000.0,
+             m_lods.back().numIndices / 3);
+}
+
+// Splits each submesh into meshlets of consecutive triangles
+void Model::buildMeshlets(std::span<Vertex const> vertices,
+                          std::span<GLuint const> indices) {
+  abcg::Timer timer;
+
+  std::vector<glm::vec3> positions;
+  positions.reserve(vertices.size());
+  for (auto const &vertex : vertices) {
+    positions.push_back(vertex.position);
+  }
+
+  m_meshlets.clear();
+  for (auto &submesh : m_submeshes) {
+    auto const meshlets{abcg::buildMeshlets(
+        indices.subspan(submesh.firstIndex, submesh.numIndices), positions)};
+    submesh.firstMeshlet = m_meshlets.size();
+    submesh.numMeshlets = meshlets.size();
+    for (auto meshlet : meshlets) {
+      meshlet.firstIndex += submesh.firstIndex;
+      m_meshlets.push_back(meshlet);
+    }
+  }
+
+  fmt::print("Built {} meshlets in {:.2f} ms\n", m_meshlets.size(),
+             timer.elapsed() * 1000.0);
+}
+
+void Model::setBounds(glm::vec3 const &min, glm::vec3 const &max) {
+  m_boundsCenter = (min + max) / 2.0f;
+  m_boundsRadius = glm::length(max - min) / 2.0f;
+}
 
-  abcg::glActiveTexture(GL_TEXTURE0);
-  abcg::glBindTexture(GL_TEXTURE_2D, m_diffuseTexture);
+std::size_t Model::selectLOD(glm::mat4 const &modelViewMatrix,
+                             glm::mat4 const &projMatrix,
+                             int viewportHeight) const {
+  if (m_lods.empty())
+    return 0;
+
+  // Distance from the camera to the nearest point of the bounding sphere
+  auto const scale{glm::length(glm::vec3(modelViewMatrix[0]))};
+  auto const center{modelViewMatrix * glm::vec4(m_boundsCenter, 1.0f)};
+  auto const distance{
+      std::max(-center.z - m_boundsRadius * scale, 1e-3f)};
+
+  // Number of pixels covered by one unit of length in model space. With an
+  // orthographic projection, this does not depend on the distance.
+  auto const isPerspective{projMatrix[3][3] == 0.0f};
+  auto const pixelsPerUnit{scale * projMatrix[1][1] *
+                           gsl::narrow<float>(viewportHeight) / 2.0f /
+                           (isPerspective ? distance : 1.0f)};
+
+  std::size_t lod{};
+  while (lod + 1 < m_lods.size() &&
+         m_lods.at(lod + 1).error * pixelsPerUnit <= 1.0f) {
+    ++lod;
+  }
+  return lod;
+}
+
+// Reorders the triangles for vertex cache locality and reduced overdraw, and
+// then the vertices for vertex fetch locality
+void Model::optimizeMesh() {
+  abcg::Timer timer;
+  auto const previousACMR{abcg::computeACMR(m_indices, m_vertices.size())};
 
-  abcg::glActiveTexture(GL_TEXTURE1);
-  abcg::glBindTexture(GL_TEXTURE_2D, m_normalTexture);
+  std::vector<glm::vec3> positions;
+  positions.reserve(m_vertices.size());
+  for (auto const &vertex : m_vertices) {
+    positions.push_back(vertex.position);
+  }
 
+  // Triangles are reordered within each submesh
+  for (auto const &submesh : m_submeshes) {
+    auto const indices{
+        std::span{m_indices}.subspan(submesh.firstIndex, submesh.numIndices)};
+    abcg::optimizeVertexCache(indices, m_vertices.size());
+    abcg::optimizeOverdraw(indices, positions);
+  }
+
+  abcg::optimizeVertexFetch(m_indices, m_vertices);
+
+  fmt::print("Optimized mesh in {:.2f} ms (ACMR {:.3f} -> {:.3f})\n",
+             timer.elapsed() * 1000.0, previousACMR,
+             abcg::computeACMR(m_indices, m_vertices.size()));
+}
+
+void Model::bindCubeTexture() const {
   abcg::glActiveTexture(GL_TEXTURE2);
   abcg::glBindTexture(GL_TEXTURE_CUBE_MAP, m_cubeTexture);
 
@@ -292,15 +883,151 @@ void Model::render(int numTriangles) const {
   // Set texture wrapping parameters
   abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   abcg::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+// Binds the uniform block slot and the textures of a material. Textures that
+// are already bound (boundTextures) are not bound again.
+void Model::bindMaterial(std::size_t material,
+                         std::array<GLuint, 2> &boundTextures) const {
+  abcg::glBindBufferRange(GL_UNIFORM_BUFFER, materialDataBinding,
+                          m_materialUBO,
+                          gsl::narrow<GLintptr>(material * m_materialStride),
+                          sizeof(MaterialData));
+
+  auto const &properties{m_materials.at(material)};
+  std::array const textures{properties.diffuseTexture != 0
+                                ? properties.diffuseTexture
+                                : m_diffuseTexture,
+                            properties.normalTexture != 0
+                                ? properties.normalTexture
+                                : m_normalTexture};
+  for (auto const unit : iter::range(textures.size())) {
+    if (textures.at(unit) != boundTextures.at(unit)) {
+      abcg::glActiveTexture(GL_TEXTURE0 + gsl::narrow<GLenum>(unit));
+      abcg::glBindTexture(GL_TEXTURE_2D, textures.at(unit));
+      boundTextures.at(unit) = textures.at(unit);
+    }
+  }
+}
+
+// Renders the submeshes of a level of detail with one draw call per material
+void Model::render(int numTriangles, std::size_t lod) const {
+  if (lod >= m_lods.size())
+    return;
+
+  auto const &level{m_lods.at(lod)};
+  auto const lastIndex{
+      level.firstIndex +
+      ((numTriangles < 0)
+           ? level.numIndices
+           : std::min(level.numIndices,
+                      gsl::narrow<std::size_t>(numTriangles) * 3))};
+
+  abcg::glBindVertexArray(m_VAO);
+
+  bindCubeTexture();
 
-  auto const numIndices{(numTriangles < 0) ? m_indices.size()
-                                           : numTriangles * 3};
+  auto boundTextures{unboundTextures};
+  for (auto const &submesh : std::span{m_submeshes}.subspan(
+           level.firstSubmesh, level.numSubmeshes)) {
+    if (submesh.firstIndex >= lastIndex)
+      break;
 
-  abcg::glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, nullptr);
+    bindMaterial(submesh.material, boundTextures);
+    m_indexBuffer.draw(
+        GL_TRIANGLES, submesh.firstIndex,
+        std::min(submesh.numIndices, lastIndex - submesh.firstIndex));
+  }
 
   abcg::glBindVertexArray(0);
 }
 
+// Renders the meshlets of a level of detail that intersect the view frustum
+// and, if face culling is enabled, are not entirely back-facing, with a single
+// multi-draw call per material. The normal cones assume counterclockwise front
+// faces, so they are flipped if frontFace is GL_CW. Returns the number of
+// triangles drawn.
+int Model::renderMeshlets(glm::mat4 const &modelViewMatrix,
+                          glm::mat4 const &projMatrix, bool faceCulling,
+                          GLenum frontFace, int numTriangles,
+                          std::size_t lod) {
+  if (lod >= m_lods.size())
+    return 0;
+
+  auto const &level{m_lods.at(lod)};
+  auto const lastIndex{
+      level.firstIndex +
+      ((numTriangles < 0)
+           ? level.numIndices
+           : std::min(level.numIndices,
+                      gsl::narrow<std::size_t>(numTriangles) * 3))};
+
+  // Culling is done in model space
+  auto const planes{frustumPlanes(projMatrix * modelViewMatrix)};
+  auto const inverseModelView{glm::inverse(modelViewMatrix)};
+  auto const isPerspective{projMatrix[3][3] == 0.0f};
+  auto const cameraPosition{glm::vec3(inverseModelView[3])};
+  auto const viewDirection{glm::normalize(
+      glm::vec3(inverseModelView * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f)))};
+
+  abcg::glBindVertexArray(m_VAO);
+
+  bindCubeTexture();
+
+  auto boundTextures{unboundTextures};
+  std::size_t numIndices{};
+  for (auto const &submesh : std::span{m_submeshes}.subspan(
+           level.firstSubmesh, level.numSubmeshes)) {
+    m_drawFirsts.clear();
+    m_drawCounts.clear();
+    for (auto const &meshlet : std::span{m_meshlets}.subspan(
+             submesh.firstMeshlet, submesh.numMeshlets)) {
+      if (meshlet.firstIndex >= lastIndex)
+        break;
+
+      if (std::ranges::any_of(planes, [&](auto const &plane) {
+            return glm::dot(glm::vec3(plane), meshlet.center) + plane.w <
+                   -meshlet.radius;
+          }))
+        continue;
+
+      if (faceCulling) {
+        auto const coneAxis{frontFace == GL_CW ? -meshlet.coneAxis
+                                               : meshlet.coneAxis};
+        if (isPerspective) {
+          auto const toCenter{meshlet.center - cameraPosition};
+          if (glm::dot(toCenter, coneAxis) >=
+              meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius)
+            continue;
+        } else if (glm::dot(viewDirection, coneAxis) >= meshlet.coneCutoff) {
+          continue;
+        }
+      }
+
+      // Merge with the previous range if contiguous
+      auto const count{
+          std::min(meshlet.numIndices, lastIndex - meshlet.firstIndex)};
+      if (!m_drawFirsts.empty() &&
+          m_drawFirsts.back() + m_drawCounts.back() == meshlet.firstIndex) {
+        m_drawCounts.back() += count;
+      } else {
+        m_drawFirsts.push_back(meshlet.firstIndex);
+        m_drawCounts.push_back(count);
+      }
+      numIndices += count;
+    }
+
+    if (!m_drawFirsts.empty()) {
+      bindMaterial(submesh.material, boundTextures);
+      m_indexBuffer.draw(GL_TRIANGLES, m_drawFirsts, m_drawCounts);
+    }
+  }
+
+  abcg::glBindVertexArray(0);
+
+  return gsl::narrow<int>(numIndices / 3);
+}
+
 void Model::setupVAO(GLuint program) {
   // Release previous VAO
   abcg::glDeleteVertexArrays(1, &m_VAO);
@@ -310,45 +1037,74 @@ void Model::setupVAO(GLuint program) {
   abcg::glBindVertexArray(m_VAO);
 
   // Bind EBO and VBO
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+  m_indexBuffer.bind();
   abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
 
-  // Bind vertex attributes
+  // Bind vertex attributes. Packed attributes are converted to floating point
+  // by the vertex fetch, so the shaders are the same for both formats
+  auto const isPacked{m_vertexFormat == VertexFormat::Packed};
+  auto const stride{
+      gsl::narrow<GLsizei>(isPacked ? sizeof(PackedVertex) : sizeof(Vertex))};
+
   auto const positionAttribute{
       abcg::glGetAttribLocation(program, "inPosition")};
   if (positionAttribute >= 0) {
     abcg::glEnableVertexAttribArray(positionAttribute);
-    abcg::glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE,
-                                sizeof(Vertex), nullptr);
+    if (isPacked) {
+      abcg::glVertexAttribPointer(positionAttribute, 3, GL_SHORT, GL_TRUE,
+                                  stride, nullptr);
+    } else {
+      abcg::glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE,
+                                  stride, nullptr);
+    }
   }
 
   auto const normalAttribute{abcg::glGetAttribLocation(program, "inNormal")};
   if (normalAttribute >= 0) {
     abcg::glEnableVertexAttribArray(normalAttribute);
-    auto const offset{offsetof(Vertex, normal)};
-    abcg::glVertexAttribPointer(normalAttribute, 3, GL_FLOAT, GL_FALSE,
-                                sizeof(Vertex),
-                                reinterpret_cast<void *>(offset));
+    if (isPacked) {
+      auto const offset{offsetof(PackedVertex, normal)};
+      abcg::glVertexAttribPointer(normalAttribute, 4, GL_INT_2_10_10_10_REV,
+                                  GL_TRUE, stride,
+                                  reinterpret_cast<void *>(offset));
+    } else {
+      auto const offset{offsetof(Vertex, normal)};
+      abcg::glVertexAttribPointer(normalAttribute, 3, GL_FLOAT, GL_FALSE,
+                                  stride, reinterpret_cast<void *>(offset));
+    }
   }
 
   auto const texCoordAttribute{
       abcg::glGetAttribLocation(program, "inTexCoord")};
   if (texCoordAttribute >= 0) {
     abcg::glEnableVertexAttribArray(texCoordAttribute);
-    auto const offset{offsetof(Vertex, texCoord)};
-    abcg::glVertexAttribPointer(texCoordAttribute, 2, GL_FLOAT, GL_FALSE,
-                                sizeof(Vertex),
-                                reinterpret_cast<void *>(offset));
+    if (isPacked) {
+      auto const offset{offsetof(PackedVertex, texCoord)};
+      abcg::glVertexAttribPointer(texCoordAttribute, 2, GL_HALF_FLOAT,
+                                  GL_FALSE, stride,
+                                  reinterpret_cast<void *>(offset));
+    } else {
+      auto const offset{offsetof(Vertex, texCoord)};
+      abcg::glVertexAttribPointer(texCoordAttribute, 2, GL_FLOAT, GL_FALSE,
+                                  stride, reinterpret_cast<void *>(offset));
+    }
   }
 
   auto const tangentCoordAttribute{
       abcg::glGetAttribLocation(program, "inTangent")};
   if (tangentCoordAttribute >= 0) {
     abcg::glEnableVertexAttribArray(tangentCoordAttribute);
-    auto const offset{offsetof(Vertex, tangent)};
-    abcg::glVertexAttribPointer(tangentCoordAttribute, 4, GL_FLOAT, GL_FALSE,
-                                sizeof(Vertex),
-                                reinterpret_cast<void *>(offset));
+    if (isPacked) {
+      auto const offset{offsetof(PackedVertex, tangent)};
+      abcg::glVertexAttribPointer(tangentCoordAttribute, 4,
+                                  GL_INT_2_10_10_10_REV, GL_TRUE, stride,
+                                  reinterpret_cast<void *>(offset));
+    } else {
+      auto const offset{offsetof(Vertex, tangent)};
+      abcg::glVertexAttribPointer(tangentCoordAttribute, 4, GL_FLOAT,
+                                  GL_FALSE, stride,
+                                  reinterpret_cast<void *>(offset));
+    }
   }
 
   // End of binding
@@ -376,10 +1132,15 @@ void Model::standardize() {
 }
 
 void Model::destroy() {
+  abcg::glDeleteTextures(gsl::narrow<GLsizei>(m_materialTextures.size()),
+                         m_materialTextures.data());
+  m_materialTextures.clear();
+  m_materials.clear();
+  abcg::glDeleteBuffers(1, &m_materialUBO);
   abcg::glDeleteTextures(1, &m_cubeTexture);
   abcg::glDeleteTextures(1, &m_normalTexture);
   abcg::glDeleteTextures(1, &m_diffuseTexture);
-  abcg::glDeleteBuffers(1, &m_EBO);
+  m_indexBuffer.destroy();
   abcg::glDeleteBuffers(1, &m_VBO);
   abcg::glDeleteVertexArrays(1, &m_VAO);
 }
\ No newline at end of file
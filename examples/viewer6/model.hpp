@@ -3,6 +3,10 @@
 
 #include "abcgOpenGL.hpp"
 
+#include <array>
+#include <filesystem>
+#include <span>
+
 struct Vertex {
   glm::vec3 position{};
   glm::vec3 normal{};
@@ -12,24 +16,80 @@ struct Vertex {
   friend bool operator==(Vertex const &, Vertex const &) = default;
 };
 
+// Vertex with quantized attributes, read with normalized attribute formats
+struct PackedVertex {
+  std::array<std::int16_t, 4> position{}; // snorm16 (w is unused)
+  std::uint32_t normal{};                 // snorm 2_10_10_10_REV (w is unused)
+  std::uint32_t tangent{}; // snorm 2_10_10_10_REV (w is the handedness)
+  std::uint32_t texCoord{}; // Two half floats
+};
+static_assert(sizeof(PackedVertex) == 20);
+
+// Uniform buffer binding point of the MaterialData uniform block
+constexpr GLuint materialDataBinding{1};
+
+// Layout of the MaterialData uniform block (padded to a multiple of 16 bytes)
+struct alignas(16) MaterialData {
+  glm::vec4 Ka{};
+  glm::vec4 Kd{};
+  glm::vec4 Ks{};
+  float shininess{};
+};
+ABCG_CHECK_STD140(MaterialData, Ka);
+ABCG_CHECK_STD140(MaterialData, Kd);
+ABCG_CHECK_STD140(MaterialData, Ks);
+ABCG_CHECK_STD140(MaterialData, shininess);
+
 class Model {
 public:
+  enum class VertexFormat { Float, Packed };
+
+  // Maximum number of levels of detail, including the original mesh
+  static constexpr std::size_t maxLODs{5};
+
   void loadCubeTexture(std::string const &path);
   void loadDiffuseTexture(std::string_view path);
   void loadNormalTexture(std::string_view path);
-  void loadObj(std::string_view path, bool standardize = true);
-  void render(int numTriangles = -1) const;
+  void loadObj(std::string_view path, bool standardize = true,
+               bool optimize = true);
+  void render(int numTriangles = -1, std::size_t lod = 0) const;
+  int renderMeshlets(glm::mat4 const &modelViewMatrix,
+                     glm::mat4 const &projMatrix, bool faceCulling,
+                     GLenum frontFace, int numTriangles = -1,
+                     std::size_t lod = 0);
   void setupVAO(GLuint program);
   void destroy();
 
-  [[nodiscard]] int getNumTriangles() const {
-    return gsl::narrow<int>(m_indices.size()) / 3;
+  // Format of the vertices uploaded by the next call to loadObj
+  void setVertexFormat(VertexFormat format) { m_vertexFormat = format; }
+  [[nodiscard]] VertexFormat getVertexFormat() const { return m_vertexFormat; }
+
+  // Transforms the positions read by the vertex shader into model space. This
+  // must be applied to the model matrix.
+  [[nodiscard]] glm::mat4 getPositionDecodeMatrix() const {
+    return m_positionDecodeMatrix;
   }
 
-  [[nodiscard]] glm::vec4 getKa() const { return m_Ka; }
-  [[nodiscard]] glm::vec4 getKd() const { return m_Kd; }
-  [[nodiscard]] glm::vec4 getKs() const { return m_Ks; }
-  [[nodiscard]] float getShininess() const { return m_shininess; }
+  // Returns the coarsest level of detail whose simplification error projects
+  // to at most one pixel
+  [[nodiscard]] std::size_t selectLOD(glm::mat4 const &modelViewMatrix,
+                                      glm::mat4 const &projMatrix,
+                                      int viewportHeight) const;
+
+  [[nodiscard]] std::size_t getNumLODs() const { return m_lods.size(); }
+  [[nodiscard]] int getNumTriangles(std::size_t lod = 0) const {
+    return lod < m_lods.size()
+               ? gsl::narrow<int>(m_lods.at(lod).numIndices / 3)
+               : 0;
+  }
+
+  [[nodiscard]] std::size_t getNumMaterials() const {
+    return m_materials.size();
+  }
+  [[nodiscard]] MaterialData getMaterialData(std::size_t material) const {
+    return m_materials.at(material).data;
+  }
+  void setMaterialData(std::size_t material, MaterialData const &data);
 
   [[nodiscard]] bool isUVMapped() const { return m_hasTexCoords; }
 
@@ -38,26 +98,91 @@ public:
 private:
   GLuint m_VAO{};
   GLuint m_VBO{};
-  GLuint m_EBO{};
+  abcg::OpenGLIndexBuffer m_indexBuffer;
 
-  glm::vec4 m_Ka{};
-  glm::vec4 m_Kd{};
-  glm::vec4 m_Ks{};
-  float m_shininess{};
+  // Textures of the materials that do not have their own
   GLuint m_diffuseTexture{};
   GLuint m_normalTexture{};
   GLuint m_cubeTexture{};
 
+  // Materials sorted by texture names, so that consecutive materials usually
+  // share textures. Each material has a slot of m_materialUBO.
+  struct Material {
+    MaterialData data{};
+    std::string diffuseTextureName{};
+    std::string normalTextureName{};
+    GLuint diffuseTexture{};
+    GLuint normalTexture{};
+  };
+  std::vector<Material> m_materials;
+  std::vector<GLuint> m_materialTextures;
+  GLuint m_materialUBO{};
+  std::size_t m_materialStride{};
+
   std::vector<Vertex> m_vertices;
   std::vector<GLuint> m_indices;
+  VertexFormat m_vertexFormat{VertexFormat::Float};
+  glm::mat4 m_positionDecodeMatrix{1.0f};
 
   bool m_hasNormals{false};
   bool m_hasTexCoords{false};
 
-  void computeNormals();
-  void computeTangents();
-  void createBuffers();
+  // Range of m_indices with the triangles of one material in one level of
+  // detail
+  struct Submesh {
+    std::size_t material{};
+    std::size_t firstIndex{};
+    std::size_t numIndices{};
+    std::size_t firstMeshlet{};
+    std::size_t numMeshlets{};
+  };
+  std::vector<Submesh> m_submeshes;
+  std::vector<abcg::Meshlet> m_meshlets;
+
+  // Range of m_indices and m_submeshes with a simplified version of the mesh.
+  // The error is an estimate of the distance to the original surface, in model
+  // space.
+  struct LOD {
+    std::size_t firstIndex{};
+    std::size_t numIndices{};
+    float error{};
+    std::size_t firstSubmesh{};
+    std::size_t numSubmeshes{};
+  };
+  std::vector<LOD> m_lods;
+
+  // Ranges of indices of the meshlets that survived culling
+  std::vector<std::size_t> m_drawFirsts;
+  std::vector<std::size_t> m_drawCounts;
+  glm::vec3 m_boundsCenter{};
+  float m_boundsRadius{};
+
+  void bindCubeTexture() const;
+  void bindMaterial(std::size_t material,
+                    std::array<GLuint, 2> &boundTextures) const;
+  void buildLODs(bool optimize);
+  void buildMeshlets(std::span<Vertex const> vertices,
+                     std::span<GLuint const> indices);
+  void computeNormals(abcg::VertexAdjacency const &adjacency);
+  void computeTangents(abcg::VertexAdjacency const &adjacency);
+  void createBuffers(std::span<Vertex const> vertices,
+                     std::span<GLuint const> indices);
+  void createMaterials(std::vector<Material> materials,
+                       std::string const &basePath);
+  void groupByMaterial(std::vector<Material> materials,
+                       std::span<std::uint32_t const> triangleMaterials,
+                       std::string const &basePath);
+  void optimizeMesh();
+  void setBounds(glm::vec3 const &min, glm::vec3 const &max);
   void standardize();
+
+  bool loadMeshCache(std::filesystem::path const &cachePath,
+                     std::filesystem::path const &sourcePath,
+                     std::string const &basePath, bool standardized,
+                     bool optimized);
+  void saveMeshCache(std::filesystem::path const &cachePath,
+                     std::filesystem::path const &sourcePath,
+                     bool standardized, bool optimized) const;
 };
 
 #endif
\ No newline at end of file
@@ -38,13 +38,27 @@ void Window::onCreate() {
   abcg::glClearColor(0, 0, 0, 1);
   abcg::glEnable(GL_DEPTH_TEST);
 
+  // Reuse program binaries from previous runs
+  abcg::setOpenGLProgramCacheDirectory(abcg::Application::getBasePath() +
+                                       "/shadercache");
+
   // Create programs
+  std::vector<std::vector<abcg::ShaderSource>> sources;
   for (auto const &name : m_shaderNames) {
     auto const path{assetsPath + "shaders/" + name};
-    auto const program{abcg::createOpenGLProgram(
+    sources.push_back(
         {{.source = path + ".vert", .stage = abcg::ShaderStage::Vertex},
-         {.source = path + ".frag", .stage = abcg::ShaderStage::Fragment}})};
-    m_programs.push_back(program);
+         {.source = path + ".frag", .stage = abcg::ShaderStage::Fragment}});
+  }
+  for (auto const program : abcg::createOpenGLPrograms(sources)) {
+    m_programs.emplace_back().create(program);
+  }
+
+  // Create uniform buffers and bind their blocks in every program
+  m_frameUBO.create(frameDataBinding, sizeof(FrameData));
+  for (auto &program : m_programs) {
+    program.setUniformBlockBinding("FrameData", frameDataBinding);
+    program.setUniformBlockBinding("MaterialData", materialDataBinding);
   }
 
   // Load default model
@@ -60,20 +74,21 @@ void Window::onCreate() {
 void Window::loadModel(std::string_view path) {
   auto const assetsPath{abcg::Application::getAssetsPath()};
 
+  m_modelPath = path;
   m_model.destroy();
 
   m_model.loadDiffuseTexture(assetsPath + "maps/pattern.png");
   m_model.loadNormalTexture(assetsPath + "maps/pattern_normal.png");
   m_model.loadCubeTexture(assetsPath + "maps/cube/");
   m_model.loadObj(path);
-  m_model.setupVAO(m_programs.at(m_currentProgramIndex));
+  m_model.setupVAO(GLuint{m_programs.at(m_currentProgramIndex)});
   m_trianglesToDraw = m_model.getNumTriangles();
 
-  // Use material properties from the loaded model
-  m_Ka = m_model.getKa();
-  m_Kd = m_model.getKd();
-  m_Ks = m_model.getKs();
-  m_shininess = m_model.getShininess();
+  // Edit the properties of the first material of the loaded model
+  m_currentMaterial = 0;
+  if (m_model.getNumMaterials() > 0) {
+    m_material = m_model.getMaterialData(0);
+  }
 }
 
 void Window::onPaint() {
@@ -82,60 +97,48 @@ void Window::onPaint() {
   abcg::glViewport(0, 0, m_viewportSize.x, m_viewportSize.y);
 
   // Use currently selected program
-  auto const program{m_programs.at(m_currentProgramIndex)};
-  abcg::glUseProgram(program);
-
-  // Get location of uniform variables
-  auto const viewMatrixLoc{abcg::glGetUniformLocation(program, "viewMatrix")};
-  auto const projMatrixLoc{abcg::glGetUniformLocation(program, "projMatrix")};
-  auto const modelMatrixLoc{abcg::glGetUniformLocation(program, "modelMatrix")};
-  auto const normalMatrixLoc{
-      abcg::glGetUniformLocation(program, "normalMatrix")};
-  auto const lightDirLoc{
-      abcg::glGetUniformLocation(program, "lightDirWorldSpace")};
-  auto const shininessLoc{abcg::glGetUniformLocation(program, "shininess")};
-  auto const IaLoc{abcg::glGetUniformLocation(program, "Ia")};
-  auto const IdLoc{abcg::glGetUniformLocation(program, "Id")};
-  auto const IsLoc{abcg::glGetUniformLocation(program, "Is")};
-  auto const KaLoc{abcg::glGetUniformLocation(program, "Ka")};
-  auto const KdLoc{abcg::glGetUniformLocation(program, "Kd")};
-  auto const KsLoc{abcg::glGetUniformLocation(program, "Ks")};
-  auto const diffuseTexLoc{abcg::glGetUniformLocation(program, "diffuseTex")};
-  auto const normalTexLoc{abcg::glGetUniformLocation(program, "normalTex")};
-  auto const cubeTexLoc{abcg::glGetUniformLocation(program, "cubeTex")};
-  auto const mappingModeLoc{abcg::glGetUniformLocation(program, "mappingMode")};
-  auto const texMatrixLoc{abcg::glGetUniformLocation(program, "texMatrix")};
+  auto &program{m_programs.at(m_currentProgramIndex)};
+  program.use();
+
+  // Update uniform blocks
+  auto const lightDirRotated{m_trackBallLight.getRotation() * m_lightDir};
+  m_frameUBO.update(FrameData{.viewMatrix = m_viewMatrix,
+                              .projMatrix = m_projMatrix,
+                              .lightDirWorldSpace = lightDirRotated,
+                              .Ia = m_Ia,
+                              .Id = m_Id,
+                              .Is = m_Is});
 
   // Set uniform variables that have the same value for every model
-  abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_viewMatrix[0][0]);
-  abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
-  abcg::glUniform1i(diffuseTexLoc, 0);
-  abcg::glUniform1i(normalTexLoc, 1);
-  abcg::glUniform1i(cubeTexLoc, 2);
-  abcg::glUniform1i(mappingModeLoc, m_mappingMode);
+  program.setUniform("diffuseTex", 0);
+  program.setUniform("normalTex", 1);
+  program.setUniform("cubeTex", 2);
+  program.setUniform("mappingMode", m_mappingMode);
 
   glm::mat3 const texMatrix{m_trackBallLight.getRotation()};
-  abcg::glUniformMatrix3fv(texMatrixLoc, 1, GL_TRUE, &texMatrix[0][0]);
-
-  auto const lightDirRotated{m_trackBallLight.getRotation() * m_lightDir};
-  abcg::glUniform4fv(lightDirLoc, 1, &lightDirRotated.x);
-  abcg::glUniform4fv(IaLoc, 1, &m_Ia.x);
-  abcg::glUniform4fv(IdLoc, 1, &m_Id.x);
-  abcg::glUniform4fv(IsLoc, 1, &m_Is.x);
+  program.setUniform("texMatrix", glm::transpose(texMatrix));
 
   // Set uniform variables for the current model
-  abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &m_modelMatrix[0][0]);
+  program.setUniform("modelMatrix",
+                     m_modelMatrix * m_model.getPositionDecodeMatrix());
 
   auto const modelViewMatrix{glm::mat3(m_viewMatrix * m_modelMatrix)};
   auto const normalMatrix{glm::inverseTranspose(modelViewMatrix)};
-  abcg::glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, &normalMatrix[0][0]);
-
-  abcg::glUniform4fv(KaLoc, 1, &m_Ka.x);
-  abcg::glUniform4fv(KdLoc, 1, &m_Kd.x);
-  abcg::glUniform4fv(KsLoc, 1, &m_Ks.x);
-  abcg::glUniform1f(shininessLoc, m_shininess);
-
-  m_model.render(m_trianglesToDraw);
+  program.setUniform("normalMatrix", normalMatrix);
+
+  // Use a coarser level of detail when the model is small on screen
+  m_currentLOD = m_autoLOD ? m_model.selectLOD(m_viewMatrix * m_modelMatrix,
+                                               m_projMatrix, m_viewportSize.y)
+                           : 0;
+  if (m_meshletCulling) {
+    m_drawnTriangles = m_model.renderMeshlets(
+        m_viewMatrix * m_modelMatrix, m_projMatrix, m_faceCulling, m_frontFace,
+        m_trianglesToDraw, m_currentLOD);
+  } else {
+    m_model.render(m_trianglesToDraw, m_currentLOD);
+    m_drawnTriangles =
+        std::min(m_trianglesToDraw, m_model.getNumTriangles(m_currentLOD));
+  }
 
   abcg::glUseProgram(0);
 
@@ -185,7 +188,7 @@ void Window::onPaintUI() {
 
   // Create main window widget
   {
-    auto widgetSize{ImVec2(222, 190)};
+    auto widgetSize{ImVec2(222, 260)};
 
     if (!m_model.isUVMapped()) {
       // Add extra space for static text
@@ -225,10 +228,25 @@ void Window::onPaintUI() {
                      "%d triangles");
     ImGui::PopItemWidth();
 
-    static bool faceCulling{};
-    ImGui::Checkbox("Back-face culling", &faceCulling);
+    ImGui::Checkbox("Back-face culling", &m_faceCulling);
+
+    // Reload the model with the selected vertex format
+    auto packedVertices{m_model.getVertexFormat() ==
+                        Model::VertexFormat::Packed};
+    if (ImGui::Checkbox("Packed vertices", &packedVertices)) {
+      m_model.setVertexFormat(packedVertices ? Model::VertexFormat::Packed
+                                             : Model::VertexFormat::Float);
+      loadModel(std::string{m_modelPath});
+    }
 
-    if (faceCulling) {
+    ImGui::Checkbox("Automatic LOD", &m_autoLOD);
+    ImGui::SameLine();
+    ImGui::Text("(%zu/%zu)", m_currentLOD + 1, m_model.getNumLODs());
+
+    ImGui::Checkbox("Meshlet culling", &m_meshletCulling);
+    ImGui::Text("%d triangles drawn", m_drawnTriangles);
+
+    if (m_faceCulling) {
       abcg::glEnable(GL_CULL_FACE);
     } else {
       abcg::glDisable(GL_CULL_FACE);
@@ -253,11 +271,8 @@ void Window::onPaintUI() {
       }
       ImGui::PopItemWidth();
 
-      if (currentIndex == 0) {
-        abcg::glFrontFace(GL_CCW);
-      } else {
-        abcg::glFrontFace(GL_CW);
-      }
+      m_frontFace = currentIndex == 0 ? GL_CCW : GL_CW;
+      abcg::glFrontFace(m_frontFace);
     }
 
     // Projection combo box
@@ -310,7 +325,7 @@ void Window::onPaintUI() {
       // Set up VAO if shader program has changed
       if (gsl::narrow<int>(currentIndex) != m_currentProgramIndex) {
         m_currentProgramIndex = gsl::narrow<int>(currentIndex);
-        m_model.setupVAO(m_programs.at(m_currentProgramIndex));
+        m_model.setupVAO(GLuint{m_programs.at(m_currentProgramIndex)});
       }
     }
 
@@ -346,7 +361,11 @@ void Window::onPaintUI() {
 
   // Create window for light sources
   if (m_currentProgramIndex >= 2 && m_currentProgramIndex <= 6) {
-    auto const widgetSize{ImVec2(222, 244)};
+    auto widgetSize{ImVec2(222, 244)};
+    if (m_model.getNumMaterials() > 1) {
+      // Add extra space for the material slider
+      widgetSize.y += 24;
+    }
     ImGui::SetNextWindowPos(ImVec2(m_viewportSize.x - widgetSize.x - 5,
                                    m_viewportSize.y - widgetSize.y - 5));
     ImGui::SetNextWindowSize(widgetSize);
@@ -365,18 +384,39 @@ void Window::onPaintUI() {
 
     ImGui::Text("Material properties");
 
+    // Slider to select the material of multi-material models
+    auto const numMaterials{gsl::narrow<int>(m_model.getNumMaterials())};
+    if (numMaterials > 1) {
+      ImGui::PushItemWidth(widgetSize.x - 16);
+      if (ImGui::SliderInt("##material", &m_currentMaterial, 0,
+                           numMaterials - 1, "material %d")) {
+        m_material = m_model.getMaterialData(
+            gsl::narrow<std::size_t>(m_currentMaterial));
+      }
+      ImGui::PopItemWidth();
+    }
+
     // Slider to control material properties
     ImGui::PushItemWidth(widgetSize.x - 36);
-    ImGui::ColorEdit3("Ka", &m_Ka.x, ImGuiColorEditFlags_Float);
-    ImGui::ColorEdit3("Kd", &m_Kd.x, ImGuiColorEditFlags_Float);
-    ImGui::ColorEdit3("Ks", &m_Ks.x, ImGuiColorEditFlags_Float);
+    auto changed{ImGui::ColorEdit3("Ka", &m_material.Ka.x,
+                                   ImGuiColorEditFlags_Float)};
+    changed |= ImGui::ColorEdit3("Kd", &m_material.Kd.x,
+                                 ImGuiColorEditFlags_Float);
+    changed |= ImGui::ColorEdit3("Ks", &m_material.Ks.x,
+                                 ImGuiColorEditFlags_Float);
     ImGui::PopItemWidth();
 
     // Slider to control the specular shininess
     ImGui::PushItemWidth(widgetSize.x - 16);
-    ImGui::SliderFloat(" ", &m_shininess, 0.0f, 500.0f, "shininess: %.1f");
+    changed |= ImGui::SliderFloat(" ", &m_material.shininess, 0.0f, 500.0f,
+                                  "shininess: %.1f");
     ImGui::PopItemWidth();
 
+    if (changed && numMaterials > 0) {
+      m_model.setMaterialData(gsl::narrow<std::size_t>(m_currentMaterial),
+                              m_material);
+    }
+
     ImGui::End();
   }
 
@@ -415,9 +455,11 @@ void Window::onResize(glm::ivec2 const &size) {
 
 void Window::onDestroy() {
   m_model.destroy();
-  for (auto const &program : m_programs) {
-    abcg::glDeleteProgram(program);
+  m_frameUBO.destroy();
+  for (auto &program : m_programs) {
+    program.destroy();
   }
+  destroySkybox();
 }
 
 void Window::createSkybox() {
@@ -425,7 +467,7 @@ void Window::createSkybox() {
 
   // Create skybox program
   auto const path{assetsPath + "shaders/" + m_skyShaderName};
-  m_skyProgram = abcg::createOpenGLProgram(
+  m_skyProgram.create(
       {{.source = path + ".vert", .stage = abcg::ShaderStage::Vertex},
        {.source = path + ".frag", .stage = abcg::ShaderStage::Fragment}});
 
@@ -437,8 +479,7 @@ void Window::createSkybox() {
   abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
   // Get location of attributes in the program
-  auto const positionAttribute{
-      abcg::glGetAttribLocation(m_skyProgram, "inPosition")};
+  auto const positionAttribute{m_skyProgram.getAttributeLocation("inPosition")};
 
   // Create VAO
   abcg::glGenVertexArrays(1, &m_skyVAO);
@@ -457,18 +498,12 @@ void Window::createSkybox() {
 }
 
 void Window::renderSkybox() {
-  abcg::glUseProgram(m_skyProgram);
-
-  auto const viewMatrixLoc{
-      abcg::glGetUniformLocation(m_skyProgram, "viewMatrix")};
-  auto const projMatrixLoc{
-      abcg::glGetUniformLocation(m_skyProgram, "projMatrix")};
-  auto const skyTexLoc{abcg::glGetUniformLocation(m_skyProgram, "skyTex")};
+  m_skyProgram.use();
 
   auto const viewMatrix{m_trackBallLight.getRotation()};
-  abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &viewMatrix[0][0]);
-  abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
-  abcg::glUniform1i(skyTexLoc, 0);
+  m_skyProgram.setUniform("viewMatrix", viewMatrix);
+  m_skyProgram.setUniform("projMatrix", m_projMatrix);
+  m_skyProgram.setUniform("skyTex", 0);
 
   abcg::glBindVertexArray(m_skyVAO);
 
@@ -485,8 +520,8 @@ void Window::renderSkybox() {
   abcg::glUseProgram(0);
 }
 
-void Window::destroySkybox() const {
-  abcg::glDeleteProgram(m_skyProgram);
+void Window::destroySkybox() {
+  m_skyProgram.destroy();
   abcg::glDeleteBuffers(1, &m_skyVBO);
   abcg::glDeleteVertexArrays(1, &m_skyVAO);
 }
\ No newline at end of file
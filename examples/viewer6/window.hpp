@@ -5,6 +5,26 @@
 #include "model.hpp"
 #include "trackball.hpp"
 
+// Uniform buffer binding points shared by every program. The binding point of
+// the MaterialData block (materialDataBinding) is defined in model.hpp.
+constexpr GLuint frameDataBinding{0};
+
+// Layout of the FrameData uniform block
+struct FrameData {
+  glm::mat4 viewMatrix{1.0f};
+  glm::mat4 projMatrix{1.0f};
+  glm::vec4 lightDirWorldSpace{};
+  glm::vec4 Ia{};
+  glm::vec4 Id{};
+  glm::vec4 Is{};
+};
+ABCG_CHECK_STD140(FrameData, viewMatrix);
+ABCG_CHECK_STD140(FrameData, projMatrix);
+ABCG_CHECK_STD140(FrameData, lightDirWorldSpace);
+ABCG_CHECK_STD140(FrameData, Ia);
+ABCG_CHECK_STD140(FrameData, Id);
+ABCG_CHECK_STD140(FrameData, Is);
+
 class Window : public abcg::OpenGLWindow {
 protected:
   void onEvent(SDL_Event const &event) override;
@@ -19,7 +39,14 @@ private:
   glm::ivec2 m_viewportSize{};
 
   Model m_model;
+  std::string m_modelPath;
   int m_trianglesToDraw{};
+  bool m_autoLOD{true};
+  std::size_t m_currentLOD{};
+  bool m_meshletCulling{true};
+  bool m_faceCulling{};
+  GLenum m_frontFace{GL_CCW};
+  int m_drawnTriangles{};
 
   TrackBall m_trackBallModel;
   TrackBall m_trackBallLight;
@@ -33,9 +60,12 @@ private:
   std::vector<char const *> m_shaderNames{
       "cubereflect", "cuberefract", "normalmapping", "texture", "blinnphong",
       "phong",       "gouraud",     "normal",        "depth"};
-  std::vector<GLuint> m_programs;
+  std::vector<abcg::OpenGLProgram> m_programs;
   int m_currentProgramIndex{};
 
+  // Uniform buffer of per-frame data. Material data is stored by the model.
+  abcg::OpenGLUniformBuffer m_frameUBO;
+
   // Mapping mode
   // 0: triplanar; 1: cylindrical; 2: spherical; 3: from mesh
   int m_mappingMode{};
@@ -45,16 +75,16 @@ private:
   glm::vec4 m_Ia{1.0f};
   glm::vec4 m_Id{1.0f};
   glm::vec4 m_Is{1.0f};
-  glm::vec4 m_Ka{};
-  glm::vec4 m_Kd{};
-  glm::vec4 m_Ks{};
-  float m_shininess{};
+
+  // Material of the model being edited, and a copy of its properties
+  int m_currentMaterial{};
+  MaterialData m_material{};
 
   // Skybox
   std::string const m_skyShaderName{"skybox"};
   GLuint m_skyVAO{};
   GLuint m_skyVBO{};
-  GLuint m_skyProgram{};
+  abcg::OpenGLProgram m_skyProgram;
 
   // clang-format off
   std::array<glm::vec3, 36> const m_skyPositions{{
@@ -80,7 +110,7 @@ private:
 
   void createSkybox();
   void renderSkybox();
-  void destroySkybox() const;
+  void destroySkybox();
   void loadModel(std::string_view path);
 };
 